@@ -802,6 +802,11 @@ struct SConstantBuffer : public TUncastableVariable<ID3DX11EffectConstantBuffer>
     SGlobalVariable         *pVariables;        // array of size [VariableCount], points into effect's contiguous variable list
     uint32_t                ExplicitBindPoint;  // Used when a CB has been explicitly bound (register(bXX)). -1 if not
 
+    uint32_t                DirtyStart;         // Bytes [DirtyStart, DirtyEnd) were updated since the last upload;
+    uint32_t                DirtyEnd;           // only meaningful while IsDirty is set
+    uint32_t                UploadStreak;       // Consecutive pass applies using the buffer that found it dirty
+    uint32_t                LastApplySerial;    // CEffect::m_ApplySerial of the last pass apply that checked the buffer
+
     bool                    IsDirty:1;          // Set when any member is updated; cleared on CB apply    
     bool                    IsTBuffer:1;        // true iff TBuffer.pShaderResource != nullptr
     bool                    IsUserManaged:1;    // Set if you don't want effects to update this buffer
@@ -810,6 +815,7 @@ struct SConstantBuffer : public TUncastableVariable<ID3DX11EffectConstantBuffer>
     bool                    IsUserPacked:1;     // Set if the elements have user-specified offsets
     bool                    IsSingle:1;         // Set to true if you want to share this CB with cloned Effects
     bool                    IsNonUpdatable:1;   // Set to true if you want to share this CB with cloned Effects
+    bool                    IsDynamic:1;        // Set once the buffer is rewritten with Map(WRITE_DISCARD) instead of UpdateSubresource
 
     union
     {
@@ -832,6 +838,10 @@ struct SConstantBuffer : public TUncastableVariable<ID3DX11EffectConstantBuffer>
         pVariables = nullptr;
         AnnotationCount = 0;
         pAnnotations = nullptr;
+        DirtyStart = 0;
+        DirtyEnd = 0;
+        UploadStreak = 0;
+        LastApplySerial = 0;
         IsDirty = false;
         IsTBuffer = false;
         IsUserManaged = false;
@@ -840,11 +850,30 @@ struct SConstantBuffer : public TUncastableVariable<ID3DX11EffectConstantBuffer>
         IsUserPacked = false;
         IsSingle = false;
         IsNonUpdatable = false;
+        IsDynamic = false;
         pEffect = nullptr;
     }
 
     bool ClonedSingle() const;
 
+    // Marks bytes [Offset, Offset + Count) for upload on the next apply
+    void DirtyRange(_In_ uint32_t Offset, _In_ uint32_t Count)
+    {
+        uint32_t End = (Offset + Count < Size) ? Offset + Count : Size;
+
+        if (!IsDirty)
+        {
+            DirtyStart = Offset;
+            DirtyEnd = End;
+            IsDirty = true;
+        }
+        else
+        {
+            DirtyStart = (Offset < DirtyStart) ? Offset : DirtyStart;
+            DirtyEnd = (End > DirtyEnd) ? End : DirtyEnd;
+        }
+    }
+
     // ID3DX11EffectConstantBuffer interface
     STDMETHOD_(bool, IsValid)() override;
     STDMETHOD_(ID3DX11EffectType*, GetType)() override;
@@ -1043,6 +1072,121 @@ public:
     ~CEffectHeap();
 };
 
+//////////////////////////////////////////////////////////////////////////
+// CEffectNameIndex - hash index from the names of an array of variables,
+// constant buffers or techniques to their position in that array.
+//
+// Open addressing with linear probing in a prime-sized table that is kept
+// at most half full. Slots hold the D3DX11EffectNameHash of the name and
+// the array index; a hit is confirmed with strcmp, so hash collisions only
+// cost an extra probe. Names are not copied, so the index is only valid
+// while the array's names are (i.e. until Optimize()).
+//////////////////////////////////////////////////////////////////////////
+
+class CEffectNameIndex
+{
+protected:
+    struct SSlot
+    {
+        uint32_t Hash;
+        uint32_t Index;
+    };
+
+    SSlot       *m_pSlots;
+    uint32_t    m_SlotCount;
+
+public:
+    static const uint32_t c_NotFound = 0xffffffff;
+
+    CEffectNameIndex() : m_pSlots(nullptr), m_SlotCount(0) {}
+    ~CEffectNameIndex() { Cleanup(); }
+
+    void Cleanup()
+    {
+        SAFE_DELETE_ARRAY(m_pSlots);
+        m_SlotCount = 0;
+    }
+
+    template<typename T>
+    HRESULT Build(_In_reads_(Count) const T *pItems, _In_ uint32_t Count)
+    {
+        HRESULT hr = S_OK;
+
+        Cleanup();
+        if (Count == 0)
+        {
+            return S_OK;
+        }
+
+        m_SlotCount = Count * 2 + 1;
+        for (size_t i = 0; i < _countof(c_PrimeSizes); ++ i)
+        {
+            if (c_PrimeSizes[i] >= m_SlotCount)
+            {
+                m_SlotCount = c_PrimeSizes[i];
+                break;
+            }
+        }
+
+        VN( m_pSlots = new SSlot[m_SlotCount] );
+        for (uint32_t i = 0; i < m_SlotCount; ++ i)
+        {
+            m_pSlots[i].Hash = 0;
+            m_pSlots[i].Index = c_NotFound;
+        }
+
+        for (uint32_t i = 0; i < Count; ++ i)
+        {
+            if (nullptr == pItems[i].pName)
+            {
+                continue;
+            }
+
+            // Keep the first of any duplicate names, as the linear search did
+            uint32_t Hash = D3DX11EffectNameHash(pItems[i].pName);
+            if (Find(pItems, Hash, pItems[i].pName) != c_NotFound)
+            {
+                continue;
+            }
+
+            uint32_t Slot = Hash % m_SlotCount;
+            while (m_pSlots[Slot].Index != c_NotFound)
+            {
+                Slot = (Slot + 1) % m_SlotCount;
+            }
+
+            m_pSlots[Slot].Hash = Hash;
+            m_pSlots[Slot].Index = i;
+        }
+
+lExit:
+        if (FAILED(hr))
+        {
+            Cleanup();
+        }
+        return hr;
+    }
+
+    template<typename T>
+    uint32_t Find(_In_ const T *pItems, _In_ uint32_t Hash, _In_z_ LPCSTR pName) const
+    {
+        if (nullptr == m_pSlots)
+        {
+            return c_NotFound;
+        }
+
+        for (uint32_t Slot = Hash % m_SlotCount; m_pSlots[Slot].Index != c_NotFound; Slot = (Slot + 1) % m_SlotCount)
+        {
+            if (m_pSlots[Slot].Hash == Hash && strcmp(pItems[m_pSlots[Slot].Index].pName, pName) == 0)
+            {
+                return m_pSlots[Slot].Index;
+            }
+        }
+
+        return c_NotFound;
+    }
+};
+
 class CEffectReflection
 {
 public:
@@ -1051,6 +1195,12 @@ public:
 };
 
 
+// Constant buffer upload totals returned by D3DX11GetEffectUploadStats
+extern D3DX11_EFFECT_UPLOAD_STATS g_UploadStats;
+
+// Set by D3DX11SetEffectStateFactory; nullptr creates state objects on the device
+extern ID3DX11EffectStateFactory *g_pStateFactory;
+
 class CEffect : public ID3DX11Effect
 {
     friend struct SBaseBlock;
@@ -1126,6 +1276,12 @@ protected:
     uint32_t                m_DepthStencilViewCount;
     SDepthStencilView       *m_pDepthStencilViews; 
 
+    // Hash indices for the Get*ByName/Get*ByHashedName lookups; techniques are
+    // those of the null group. Built after loading and freed by Optimize().
+    CEffectNameIndex        m_VariableNameIndex;
+    CEffectNameIndex        m_CBNameIndex;
+    CEffectNameIndex        m_TechniqueNameIndex;
+
     Timer                   m_LocalTimer;
     
     // temporary index variable for assignment evaluation
@@ -1135,6 +1291,17 @@ protected:
     ID3D11DeviceContext     *m_pContext;
     ID3D11ClassLinkage      *m_pClassLinkage;
 
+    // Set when the device can update part of a constant buffer (D3D11_FEATURE_D3D11_OPTIONS).
+    // m_pPartialUpdateContext holds a reference to the last context passes were applied with, as
+    // an ID3D11DeviceContext1, or is nullptr if that is a deferred context or not a version 1 one.
+    bool                    m_ConstantBufferPartialUpdate;
+    ID3D11DeviceContext     *m_pPartialUpdateSource;
+    ID3D11DeviceContext1    *m_pPartialUpdateContext;
+
+    // Counts pass applies, so that a constant buffer several shader stages of one pass use adds
+    // to its upload streak once per apply
+    uint32_t                m_ApplySerial;
+
     // Master lists of reflection interfaces
     CEffectVectorOwner<SSingleElementType> m_pTypeInterfaces;
     CEffectVectorOwner<SMember>            m_pMemberInterfaces;
@@ -1168,6 +1335,9 @@ protected:
     //////////////////////////////////////////////////////////////////////////    
     // Runtime (performance critical)
     
+    void SetApplyContext(_In_ ID3D11DeviceContext *pContext);
+    void CheckAndUpdateCB(_Inout_ SConstantBuffer *pCB);
+    void MakeCBDynamic(_Inout_ SConstantBuffer *pCB);
     void ApplyShaderBlock(_In_ SShaderBlock *pBlock);
     bool ApplyRenderStateBlock(_In_ SBaseBlock *pBlock);
     bool ApplySamplerBlock(_In_ SSamplerBlock *pBlock);
@@ -1185,12 +1355,17 @@ protected:
     SConstantBuffer *FindCB(_In_z_ LPCSTR pName);
     void ReplaceCBReference(_In_ SConstantBuffer *pOldBufferBlock, _In_ ID3D11Buffer *pNewBuffer); // Used by user-managed CBs
     void ReplaceSamplerReference(_In_ SSamplerBlock *pOldSamplerBlock, _In_ ID3D11SamplerState *pNewSampler);
+    HRESULT BuildNameIndices();
     void AddRefAllForCloning( _In_ CEffect* pEffectSource );
     HRESULT CopyMemberInterfaces( _In_ CEffect* pEffectSource );
     HRESULT CopyStringPool( _In_ CEffect* pEffectSource, _Inout_ CPointerMappingTable& mappingTable );
     HRESULT CopyTypePool( _In_ CEffect* pEffectSource, _Inout_ CPointerMappingTable& mappingTableTypes, _Inout_ CPointerMappingTable& mappingTableStrings );
     HRESULT CopyOptimizedTypePool( _In_ CEffect* pEffectSource, _Inout_ CPointerMappingTable& mappingTableTypes );
     HRESULT RecreateCBs();
+    HRESULT CreateRasterizerState( _In_ const D3D11_RASTERIZER_DESC *pDesc, _Outptr_ ID3D11RasterizerState **ppState );
+    HRESULT CreateBlendState( _In_ const D3D11_BLEND_DESC *pDesc, _Outptr_ ID3D11BlendState **ppState );
+    HRESULT CreateDepthStencilState( _In_ const D3D11_DEPTH_STENCIL_DESC *pDesc, _Outptr_ ID3D11DepthStencilState **ppState );
+    HRESULT CreateSamplerState( _In_ const D3D11_SAMPLER_DESC *pDesc, _Outptr_ ID3D11SamplerState **ppState );
     HRESULT FixupMemberInterface( _Inout_ SMember* pMember, _In_ CEffect* pEffectSource, _Inout_ CPointerMappingTable& mappingTableStrings );
 
     void ValidateIndex(_In_ uint32_t Elements);
@@ -1250,6 +1425,10 @@ public:
     STDMETHOD(Optimize)() override;
     STDMETHOD_(bool, IsOptimized)() override;
 
+    STDMETHOD_(ID3DX11EffectConstantBuffer*, GetConstantBufferByHashedName)(_In_ uint32_t Hash, _In_z_ LPCSTR Name) override;
+    STDMETHOD_(ID3DX11EffectVariable*, GetVariableByHashedName)(_In_ uint32_t Hash, _In_z_ LPCSTR Name) override;
+    STDMETHOD_(ID3DX11EffectTechnique*, GetTechniqueByHashedName)(_In_ uint32_t Hash, _In_z_ LPCSTR Name) override;
+
     //////////////////////////////////////////////////////////////////////////    
     // New reflection helpers
 
@@ -329,3 +329,22 @@ lExit:
     }
     return hr;
 }
+
+//--------------------------------------------------------------------------------------
+
+_Use_decl_annotations_
+void WINAPI D3DX11GetEffectUploadStats( D3DX11_EFFECT_UPLOAD_STATS *pStats )
+{
+    if ( !pStats )
+        return;
+
+    *pStats = g_UploadStats;
+}
+
+//--------------------------------------------------------------------------------------
+
+_Use_decl_annotations_
+void WINAPI D3DX11SetEffectStateFactory( ID3DX11EffectStateFactory *pFactory )
+{
+    g_pStateFactory = pFactory;
+}
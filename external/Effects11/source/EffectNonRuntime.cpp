@@ -733,6 +733,10 @@ CEffect::CEffect( uint32_t Flags )
     m_pDevice = nullptr;
     m_pClassLinkage = nullptr;
     m_pContext = nullptr;
+    m_ConstantBufferPartialUpdate = false;
+    m_pPartialUpdateSource = nullptr;
+    m_pPartialUpdateContext = nullptr;
+    m_ApplySerial = 0;
 
     m_VariableCount = 0;
     m_AnonymousShaderCount = 0;
@@ -916,6 +920,7 @@ CEffect::~CEffect()
         SAFE_RELEASE( m_pDevice );
     }
     SAFE_RELEASE( m_pClassLinkage );
+    SAFE_RELEASE( m_pPartialUpdateContext );
     assert( m_pContext == nullptr );
 
     // Restore debug spew
@@ -1115,6 +1120,30 @@ void CEffect::ReplaceCBReference(SConstantBuffer *pOldBufferBlock, ID3D11Buffer
     }
 }
 
+// Switches a constant buffer that is rewritten for every draw to a dynamic buffer of the same
+// size. If that cannot be created the buffer keeps being updated with UpdateSubresource.
+void CEffect::MakeCBDynamic(_Inout_ SConstantBuffer *pCB)
+{
+    D3D11_BUFFER_DESC bufDesc;
+    pCB->pD3DObject->GetDesc( &bufDesc );
+    bufDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    ID3D11Buffer* pNewBuffer = nullptr;
+    if( FAILED( m_pDevice->CreateBuffer( &bufDesc, nullptr, &pNewBuffer ) ) )
+    {
+        DPF(0, "ID3DX11Effect: Could not create a dynamic buffer for constant buffer [%s]", pCB->pName ? pCB->pName : "");
+        pCB->UploadStreak = 0;
+        return;
+    }
+    SetDebugObjectName( pNewBuffer, "D3DX11Effect" );
+
+    ReplaceCBReference( pCB, pNewBuffer );
+    pCB->pD3DObject->Release();
+    pCB->pD3DObject = pNewBuffer;
+    pCB->IsDynamic = true;
+}
+
 // In all shaders, replace pOldSamplerBlock with pNewSampler, if pOldSamplerBlock is a dependency
 _Use_decl_annotations_
 void CEffect::ReplaceSamplerReference(SSamplerBlock *pOldSamplerBlock, ID3D11SamplerState *pNewSampler)
@@ -1132,6 +1161,44 @@ void CEffect::ReplaceSamplerReference(SSamplerBlock *pOldSamplerBlock, ID3D11Sam
     }
 }
 
+// State objects come from the installed ID3DX11EffectStateFactory, if any, so that the
+// application can share them between effects
+_Use_decl_annotations_
+HRESULT CEffect::CreateRasterizerState(const D3D11_RASTERIZER_DESC *pDesc, ID3D11RasterizerState **ppState)
+{
+    if (g_pStateFactory)
+        return g_pStateFactory->CreateRasterizerState( pDesc, ppState );
+
+    return m_pDevice->CreateRasterizerState( pDesc, ppState );
+}
+
+_Use_decl_annotations_
+HRESULT CEffect::CreateBlendState(const D3D11_BLEND_DESC *pDesc, ID3D11BlendState **ppState)
+{
+    if (g_pStateFactory)
+        return g_pStateFactory->CreateBlendState( pDesc, ppState );
+
+    return m_pDevice->CreateBlendState( pDesc, ppState );
+}
+
+_Use_decl_annotations_
+HRESULT CEffect::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC *pDesc, ID3D11DepthStencilState **ppState)
+{
+    if (g_pStateFactory)
+        return g_pStateFactory->CreateDepthStencilState( pDesc, ppState );
+
+    return m_pDevice->CreateDepthStencilState( pDesc, ppState );
+}
+
+_Use_decl_annotations_
+HRESULT CEffect::CreateSamplerState(const D3D11_SAMPLER_DESC *pDesc, ID3D11SamplerState **ppState)
+{
+    if (g_pStateFactory)
+        return g_pStateFactory->CreateSamplerState( pDesc, ppState );
+
+    return m_pDevice->CreateSamplerState( pDesc, ppState );
+}
+
 // Call BindToDevice after the effect has been fully loaded.
 // BindToDevice will release all D3D11 objects and create new ones on the new device
 _Use_decl_annotations_
@@ -1160,6 +1227,9 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
     VH( m_pDevice->CreateClassLinkage( &m_pClassLinkage ) );
     SetDebugObjectName(m_pClassLinkage,srcName);
 
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+    m_ConstantBufferPartialUpdate = SUCCEEDED( m_pDevice->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options) ) ) && options.ConstantBufferPartialUpdate;
+
     // Create all constant buffers
     SConstantBuffer *pCB = m_pCBs;
     SConstantBuffer *pCBLast = m_pCBs + m_CBCount;
@@ -1208,7 +1278,7 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
                 pCB->TBuffer.pShaderResource = nullptr;
             }
 
-            pCB->IsDirty = true;
+            pCB->DirtyRange(0, pCB->Size);
         }
         else
         {
@@ -1222,7 +1292,7 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
     for(; pRB != pRBLast; pRB++)
     {
         SAFE_RELEASE(pRB->pRasterizerObject);
-        if( SUCCEEDED( m_pDevice->CreateRasterizerState( &pRB->BackingStore, &pRB->pRasterizerObject) ) )
+        if( SUCCEEDED( CreateRasterizerState( &pRB->BackingStore, &pRB->pRasterizerObject) ) )
         {
             pRB->IsValid = true;
             SetDebugObjectName( pRB->pRasterizerObject, srcName );
@@ -1237,7 +1307,7 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
     for(; pDS != pDSLast; pDS++)
     {
         SAFE_RELEASE(pDS->pDSObject);
-        if( SUCCEEDED( m_pDevice->CreateDepthStencilState( &pDS->BackingStore, &pDS->pDSObject) ) )
+        if( SUCCEEDED( CreateDepthStencilState( &pDS->BackingStore, &pDS->pDSObject) ) )
         {
             pDS->IsValid = true;
             SetDebugObjectName( pDS->pDSObject, srcName );
@@ -1252,7 +1322,7 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
     for(; pBlend != pBlendLast; pBlend++)
     {
         SAFE_RELEASE(pBlend->pBlendObject);
-        if( SUCCEEDED( m_pDevice->CreateBlendState( &pBlend->BackingStore, &pBlend->pBlendObject ) ) )
+        if( SUCCEEDED( CreateBlendState( &pBlend->BackingStore, &pBlend->pBlendObject ) ) )
         {
             pBlend->IsValid = true;
             SetDebugObjectName( pBlend->pBlendObject, srcName );
@@ -1268,7 +1338,7 @@ HRESULT CEffect::BindToDevice(ID3D11Device *pDevice, LPCSTR srcName)
     {
         SAFE_RELEASE(pSampler->pD3DObject);
 
-        VH( m_pDevice->CreateSamplerState( &pSampler->BackingStore.SamplerDesc, &pSampler->pD3DObject) );
+        VH( CreateSamplerState( &pSampler->BackingStore.SamplerDesc, &pSampler->pD3DObject) );
         SetDebugObjectName( pSampler->pD3DObject, srcName );
     }
 
@@ -1688,6 +1758,21 @@ uint32_t SType::GetTotalPackedSize(_In_ bool IsSingleElement) const
     }
 }
 
+HRESULT CEffect::BuildNameIndices()
+{
+    HRESULT hr = S_OK;
+
+    VH( m_VariableNameIndex.Build(m_pVariables, m_VariableCount) );
+    VH( m_CBNameIndex.Build(m_pCBs, m_CBCount) );
+    if (nullptr != m_pNullGroup)
+    {
+        VH( m_TechniqueNameIndex.Build(m_pNullGroup->pTechniques, m_pNullGroup->TechniqueCount) );
+    }
+
+lExit:
+    return hr;
+}
+
 SConstantBuffer *CEffect::FindCB(_In_z_ LPCSTR pName)
 {
     uint32_t  i;
@@ -2042,7 +2127,7 @@ HRESULT CEffect::RecreateCBs()
                 ReplaceCBReference( pCB, (*ppOriginalBuffer) );
             }
 
-            pCB->IsDirty = true;
+            pCB->DirtyRange(0, pCB->Size);
         }
     }
 
@@ -2145,6 +2230,7 @@ HRESULT CEffect::CloneEffect(_In_ uint32_t Flags, _Outptr_ ID3DX11Effect** ppClo
     pNewEffect->m_FXLIndex = m_FXLIndex;
     pNewEffect->m_pDevice = m_pDevice;
     pNewEffect->m_pClassLinkage = m_pClassLinkage;
+    pNewEffect->m_ConstantBufferPartialUpdate = m_ConstantBufferPartialUpdate;
 
     pNewEffect->AddRefAllForCloning( this );
 
@@ -2208,6 +2294,10 @@ HRESULT CEffect::CloneEffect(_In_ uint32_t Flags, _Outptr_ ID3DX11Effect** ppClo
         VH( pNewEffect->FixupMemberInterface( pMember, this, mappingTableStrings ) );
     }
 
+    if( !IsOptimized() )
+    {
+        VH( pNewEffect->BuildNameIndices() );
+    }
 
 lExit:
     SAFE_DELETE( pTempHeap );
@@ -2297,6 +2387,11 @@ HRESULT CEffect::Optimize()
         return S_OK;
     }
 
+    // The name lookups are disabled once the names are gone
+    m_VariableNameIndex.Cleanup();
+    m_CBNameIndex.Cleanup();
+    m_TechniqueNameIndex.Cleanup();
+
     // Delete annotations, names, semantics, and string data on variables
     
     for (size_t i = 0; i < m_VariableCount; ++ i)
@@ -1152,7 +1152,7 @@ HRESULT SConstantBuffer::SetRawValue(const void *pData, uint32_t Offset, uint32_
     }
     else
     {
-        IsDirty = true;
+        DirtyRange(Offset, Count);
     }
 
     memcpy(pBackingStore + Offset, pData, Count);
@@ -1627,7 +1627,7 @@ HRESULT SPassBlock::Apply(_In_ uint32_t Flags, _In_ ID3D11DeviceContext* pContex
 
 
     assert( pEffect->m_pContext == nullptr );
-    pEffect->m_pContext = pContext;
+    pEffect->SetApplyContext(pContext);
     pEffect->ApplyPassBlock(this);
     pEffect->m_pContext = nullptr;
 
@@ -1983,12 +1983,29 @@ ID3DX11EffectConstantBuffer * CEffect::GetConstantBufferByName(_In_z_ LPCSTR Nam
         return &g_InvalidConstantBuffer;
     }
 
-    for (uint32_t i = 0; i < m_CBCount; ++ i)
+    return GetConstantBufferByHashedName(D3DX11EffectNameHash(Name), Name);
+}
+
+ID3DX11EffectConstantBuffer * CEffect::GetConstantBufferByHashedName(_In_ uint32_t Hash, _In_z_ LPCSTR Name)
+{
+    static LPCSTR pFuncName = "ID3DX11Effect::GetConstantBufferByHashedName";
+
+    if (IsOptimized())
     {
-        if (strcmp(m_pCBs[i].pName, Name) == 0)
-        {
-            return m_pCBs + i;
-        }
+        DPF(0, "%s: Cannot get constant buffer interfaces by name since the effect has been Optimize()'ed", pFuncName);
+        return &g_InvalidConstantBuffer;
+    }
+
+    if (nullptr == Name)
+    {
+        DPF(0, "%s: Parameter Name was nullptr.", pFuncName);
+        return &g_InvalidConstantBuffer;
+    }
+
+    uint32_t Index = m_CBNameIndex.Find(m_pCBs, Hash, Name);
+    if (Index != CEffectNameIndex::c_NotFound)
+    {
+        return m_pCBs + Index;
     }
 
     DPF(0, "%s: Constant Buffer [%s] not found", pFuncName, Name);
@@ -2024,12 +2041,29 @@ ID3DX11EffectVariable * CEffect::GetVariableByName(_In_z_ LPCSTR Name)
         return &g_InvalidScalarVariable;
     }
 
-    for (uint32_t i = 0; i < m_VariableCount; ++ i)
+    return GetVariableByHashedName(D3DX11EffectNameHash(Name), Name);
+}
+
+ID3DX11EffectVariable * CEffect::GetVariableByHashedName(_In_ uint32_t Hash, _In_z_ LPCSTR Name)
+{
+    static LPCSTR pFuncName = "ID3DX11Effect::GetVariableByHashedName";
+
+    if (IsOptimized())
     {
-        if (strcmp(m_pVariables[i].pName, Name) == 0)
-        {
-            return m_pVariables + i;
-        }
+        DPF(0, "%s: Cannot get variable interfaces by name since the effect has been Optimize()'ed", pFuncName);
+        return &g_InvalidScalarVariable;
+    }
+
+    if (nullptr == Name)
+    {
+        DPF(0, "%s: Parameter Name was nullptr.", pFuncName);
+        return &g_InvalidScalarVariable;
+    }
+
+    uint32_t Index = m_VariableNameIndex.Find(m_pVariables, Hash, Name);
+    if (Index != CEffectNameIndex::c_NotFound)
+    {
+        return m_pVariables + Index;
     }
 
     DPF(0, "%s: Variable [%s] not found", pFuncName, Name);
@@ -2114,13 +2148,7 @@ ID3DX11EffectTechnique * CEffect::GetTechniqueByName(_In_z_ LPCSTR Name)
     char* pDelimiter = strchr( NameCopy, '|' );
     if( pDelimiter == nullptr )
     {
-        if ( m_pNullGroup == nullptr )
-        {
-            DPF( 0, "The effect contains no default group." );
-            return &g_InvalidTechnique;
-        }
-
-        return m_pNullGroup->GetTechniqueByName( Name );
+        return GetTechniqueByHashedName( D3DX11EffectNameHash( Name ), Name );
     }
 
     // separate group name and technique name
@@ -2129,6 +2157,44 @@ ID3DX11EffectTechnique * CEffect::GetTechniqueByName(_In_z_ LPCSTR Name)
     return GetGroupByName( NameCopy )->GetTechniqueByName( pDelimiter + 1 );
 }
 
+ID3DX11EffectTechnique * CEffect::GetTechniqueByHashedName(_In_ uint32_t Hash, _In_z_ LPCSTR Name)
+{
+    static LPCSTR pFuncName = "ID3DX11Effect::GetTechniqueByHashedName";
+
+    if (IsOptimized())
+    {
+        DPF(0, "%s: Cannot get technique interfaces by name since the effect has been Optimize()'ed", pFuncName);
+        return &g_InvalidTechnique;
+    }
+
+    if (nullptr == Name)
+    {
+        DPF(0, "%s: Parameter Name was nullptr.", pFuncName);
+        return &g_InvalidTechnique;
+    }
+
+    // Only the null group's techniques are indexed; "Group|Technique" goes through the group
+    if( strchr( Name, '|' ) != nullptr )
+    {
+        return GetTechniqueByName( Name );
+    }
+
+    if ( m_pNullGroup == nullptr )
+    {
+        DPF( 0, "The effect contains no default group." );
+        return &g_InvalidTechnique;
+    }
+
+    uint32_t Index = m_TechniqueNameIndex.Find(m_pNullGroup->pTechniques, Hash, Name);
+    if (Index != CEffectNameIndex::c_NotFound)
+    {
+        return (ID3DX11EffectTechnique *)(m_pNullGroup->pTechniques + Index);
+    }
+
+    DPF(0, "%s: Technique [%s] not found", pFuncName, Name);
+    return &g_InvalidTechnique;
+}
+
 ID3D11ClassLinkage * CEffect::GetClassLinkage()
 {
     SAFE_ADDREF( m_pClassLinkage );
@@ -24,6 +24,15 @@ namespace D3DX11Effects
                                 D3D11_KEEP_UNORDERED_ACCESS_VIEWS, D3D11_KEEP_UNORDERED_ACCESS_VIEWS, D3D11_KEEP_UNORDERED_ACCESS_VIEWS,
                                 D3D11_KEEP_UNORDERED_ACCESS_VIEWS, D3D11_KEEP_UNORDERED_ACCESS_VIEWS };
 
+    D3DX11_EFFECT_UPLOAD_STATS g_UploadStats = { 0 };
+
+    ID3DX11EffectStateFactory *g_pStateFactory = nullptr;
+
+    // A constant buffer found dirty by this many pass applies in a row (of the passes that use it)
+    // is rewritten for every draw, so it is switched to a dynamic buffer and uploaded with
+    // Map(WRITE_DISCARD) from then on
+    static const uint32_t c_DynamicCBUploadStreak = 8;
+
 bool SBaseBlock::ApplyAssignments(CEffect *pEffect)
 {
     SAssignment *pAssignment = pAssignments;
@@ -136,17 +145,99 @@ bool SPassBlock::CheckDependencies()
 }
 #pragma warning(pop)
 
-// Update constant buffer contents if necessary
-inline void CheckAndUpdateCB_FX(ID3D11DeviceContext *pContext, SConstantBuffer *pCB)
+// Sets the context passes are applied with, and works out whether it can take partial
+// constant buffer updates the first time a given context is seen
+void CEffect::SetApplyContext(_In_ ID3D11DeviceContext *pContext)
 {
-    if (pCB->IsDirty && !pCB->IsNonUpdatable)
+    m_pContext = pContext;
+
+    if (pContext == m_pPartialUpdateSource)
     {
-        // CB out of date; rebuild it
-        pContext->UpdateSubresource(pCB->pD3DObject, 0, nullptr, pCB->pBackingStore, pCB->Size, pCB->Size);
-        pCB->IsDirty = false;
+        return;
+    }
+
+    m_pPartialUpdateSource = pContext;
+    SAFE_RELEASE(m_pPartialUpdateContext);
+
+    // Deferred contexts need the source pointer adjusted on some drivers, so they upload whole buffers
+    if (m_ConstantBufferPartialUpdate && pContext->GetType() == D3D11_DEVICE_CONTEXT_IMMEDIATE)
+    {
+        if (FAILED(pContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&m_pPartialUpdateContext))))
+        {
+            m_pPartialUpdateContext = nullptr;
+        }
     }
 }
 
+// Update constant buffer contents if necessary. Only the updated registers are uploaded when
+// they are at most half of the buffer and the context allows it; buffers that are dirty on
+// every apply become dynamic and are rewritten whole.
+//
+// Each shader stage of a pass checks the buffers it uses, so only the first check of a pass
+// apply counts towards the streak: the VS check of a buffer the PS also reads uploads it, and
+// the PS check then finding it clean is no reason to reset.
+void CEffect::CheckAndUpdateCB(_Inout_ SConstantBuffer *pCB)
+{
+    bool FirstCheck = (pCB->LastApplySerial != m_ApplySerial);
+    pCB->LastApplySerial = m_ApplySerial;
+
+    if (!pCB->IsDirty || pCB->IsNonUpdatable)
+    {
+        if (FirstCheck)
+        {
+            pCB->UploadStreak = 0;
+        }
+        return;
+    }
+
+    // Shared (single) buffers are referenced by clones too, so they keep their original buffer
+    if (FirstCheck && !pCB->IsDynamic && !pCB->IsTBuffer && !pCB->IsSingle && ++pCB->UploadStreak >= c_DynamicCBUploadStreak)
+    {
+        MakeCBDynamic(pCB);
+    }
+
+    if (pCB->IsDynamic)
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(m_pContext->Map(pCB->pD3DObject, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        {
+            // Stays dirty; retried on the next apply
+            return;
+        }
+
+        memcpy(mapped.pData, pCB->pBackingStore, pCB->Size);
+        m_pContext->Unmap(pCB->pD3DObject, 0);
+
+        g_UploadStats.BytesUploaded += pCB->Size;
+        g_UploadStats.DiscardMaps++;
+    }
+    else
+    {
+        // A constant buffer box must start and end on a register boundary
+        uint32_t Start = pCB->DirtyStart & ~(SType::c_RegisterSize - 1);
+        uint32_t End = (pCB->DirtyEnd + SType::c_RegisterSize - 1) & ~(SType::c_RegisterSize - 1);
+
+        if (m_pPartialUpdateContext != nullptr && (End - Start) * 2 <= pCB->Size)
+        {
+            D3D11_BOX box = { Start, 0, 0, End, 1, 1 };
+            m_pPartialUpdateContext->UpdateSubresource1(pCB->pD3DObject, 0, &box, pCB->pBackingStore + Start, 0, 0, 0);
+
+            g_UploadStats.BytesUploaded += End - Start;
+            g_UploadStats.PartialUpdates++;
+        }
+        else
+        {
+            // CB out of date; rebuild it
+            m_pContext->UpdateSubresource(pCB->pD3DObject, 0, nullptr, pCB->pBackingStore, pCB->Size, pCB->Size);
+
+            g_UploadStats.BytesUploaded += pCB->Size;
+            g_UploadStats.FullUpdates++;
+        }
+    }
+
+    pCB->IsDirty = false;
+}
+
 
 //--------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------
@@ -166,7 +257,7 @@ void CEffect::ApplyShaderBlock(_In_ SShaderBlock *pBlock)
 
         for (size_t i = 0; i < pCBDep->Count; ++ i)
         {
-            CheckAndUpdateCB_FX(m_pContext, (SConstantBuffer*)pCBDep->ppFXPointers[i]);
+            CheckAndUpdateCB((SConstantBuffer*)pCBDep->ppFXPointers[i]);
         }
 
         (m_pContext->*(pVT->pSetConstantBuffers))(pCBDep->StartIndex, pCBDep->Count, pCBDep->ppD3DObjects);
@@ -225,7 +316,7 @@ void CEffect::ApplyShaderBlock(_In_ SShaderBlock *pBlock)
 
     for (; ppTB<ppLastTB; ppTB++)
     {
-        CheckAndUpdateCB_FX(m_pContext, (SConstantBuffer*)*ppTB);
+        CheckAndUpdateCB((SConstantBuffer*)*ppTB);
     }
 
     // Set the textures
@@ -300,7 +391,7 @@ bool CEffect::ApplyRenderStateBlock(_In_ SBaseBlock *pBlock)
                 _Analysis_assume_(pSBlock->pD3DObject != 0);
                 pSBlock->pD3DObject->Release();
 
-                HRESULT hr = m_pDevice->CreateSamplerState( &pSBlock->BackingStore.SamplerDesc, &pSBlock->pD3DObject );
+                HRESULT hr = CreateSamplerState( &pSBlock->BackingStore.SamplerDesc, &pSBlock->pD3DObject );
                 if ( SUCCEEDED(hr) )
                 {
                     SetDebugObjectName(pSBlock->pD3DObject, "D3DX11Effect");
@@ -314,7 +405,7 @@ bool CEffect::ApplyRenderStateBlock(_In_ SBaseBlock *pBlock)
 
                 assert(nullptr != pDSBlock->pDSObject);
                 SAFE_RELEASE( pDSBlock->pDSObject );
-                if( SUCCEEDED( m_pDevice->CreateDepthStencilState( &pDSBlock->BackingStore, &pDSBlock->pDSObject ) ) )
+                if( SUCCEEDED( CreateDepthStencilState( &pDSBlock->BackingStore, &pDSBlock->pDSObject ) ) )
                 {
                     pDSBlock->IsValid = true;
                     SetDebugObjectName( pDSBlock->pDSObject, "D3DX11Effect" );
@@ -330,7 +421,7 @@ bool CEffect::ApplyRenderStateBlock(_In_ SBaseBlock *pBlock)
 
                 assert(nullptr != pBBlock->pBlendObject);
                 SAFE_RELEASE( pBBlock->pBlendObject );
-                if( SUCCEEDED( m_pDevice->CreateBlendState( &pBBlock->BackingStore, &pBBlock->pBlendObject ) ) )
+                if( SUCCEEDED( CreateBlendState( &pBBlock->BackingStore, &pBBlock->pBlendObject ) ) )
                 {
                     pBBlock->IsValid = true;
                     SetDebugObjectName( pBBlock->pBlendObject, "D3DX11Effect" );
@@ -347,7 +438,7 @@ bool CEffect::ApplyRenderStateBlock(_In_ SBaseBlock *pBlock)
                 assert(nullptr != pRBlock->pRasterizerObject);
 
                 SAFE_RELEASE( pRBlock->pRasterizerObject );
-                if( SUCCEEDED( m_pDevice->CreateRasterizerState( &pRBlock->BackingStore, &pRBlock->pRasterizerObject ) ) )
+                if( SUCCEEDED( CreateRasterizerState( &pRBlock->BackingStore, &pRBlock->pRasterizerObject ) ) )
                 {
                     pRBlock->IsValid = true;
                     SetDebugObjectName( pRBlock->pRasterizerObject, "D3DX11Effect" );
@@ -530,6 +621,8 @@ bool CEffect::ValidatePassBlock( _Inout_ SPassBlock* pBlock )
 // Set all state defined in the pass
 void CEffect::ApplyPassBlock(_Inout_ SPassBlock *pBlock)
 {
+    m_ApplySerial++;
+
     pBlock->ApplyPassAssignments();
 
     if (nullptr != pBlock->BackingStore.pBlendBlock)
@@ -1475,7 +1475,7 @@ lExit:
     {
         assert(pCB != 0);
         _Analysis_assume_(pCB != 0);
-        pCB->IsDirty = true;
+        pCB->DirtyRange((uint32_t)(Data.pNumeric - pCB->pBackingStore), pType->TotalSize);
         LastModifiedTime = pEffect->GetCurrentTime();
     }
 
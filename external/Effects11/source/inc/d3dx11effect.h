@@ -1002,6 +1002,68 @@ struct D3DX11_EFFECT_DESC
     uint32_t    Groups;                 // Number of groups in this effect
 };
 
+//////////////////////////////////////////////////////////////////////////////
+// ID3DX11EffectStateFactory /////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------
+// ID3DX11EffectStateFactory:
+//
+// Optional, application-supplied creator of the rasterizer, blend,
+// depth-stencil and sampler state objects of effect state blocks, used in
+// place of the device when installed with D3DX11SetEffectStateFactory().
+// Each method behaves like the ID3D11Device method of the same name: on
+// success *ppState holds a reference that the effect releases, so an
+// implementation may hand out one shared object for equal descriptions.
+// Effects created on several threads at once (the device being
+// free-threaded) call the factory from those threads concurrently, so the
+// implementation must be thread-safe.
+//----------------------------------------------------------------------------
+
+typedef interface ID3DX11EffectStateFactory ID3DX11EffectStateFactory;
+
+#undef INTERFACE
+#define INTERFACE ID3DX11EffectStateFactory
+
+DECLARE_INTERFACE(ID3DX11EffectStateFactory)
+{
+    STDMETHOD(CreateRasterizerState)(THIS_ _In_ const D3D11_RASTERIZER_DESC *pDesc, _Outptr_ ID3D11RasterizerState **ppState) PURE;
+    STDMETHOD(CreateBlendState)(THIS_ _In_ const D3D11_BLEND_DESC *pDesc, _Outptr_ ID3D11BlendState **ppState) PURE;
+    STDMETHOD(CreateDepthStencilState)(THIS_ _In_ const D3D11_DEPTH_STENCIL_DESC *pDesc, _Outptr_ ID3D11DepthStencilState **ppState) PURE;
+    STDMETHOD(CreateSamplerState)(THIS_ _In_ const D3D11_SAMPLER_DESC *pDesc, _Outptr_ ID3D11SamplerState **ppState) PURE;
+};
+
+//----------------------------------------------------------------------------
+// D3DX11_EFFECT_UPLOAD_STATS:
+//
+// Retrieved by D3DX11GetEffectUploadStats(). Running totals, across all
+// effects, of the constant buffer uploads made when passes are applied.
+//----------------------------------------------------------------------------
+
+struct D3DX11_EFFECT_UPLOAD_STATS
+{
+    uint64_t    BytesUploaded;          // Bytes copied to constant buffers
+    uint64_t    FullUpdates;            // UpdateSubresource() of a whole buffer
+    uint64_t    PartialUpdates;         // UpdateSubresource1() of the updated range of a buffer
+    uint64_t    DiscardMaps;            // Map(WRITE_DISCARD) of a buffer that is rewritten on every apply
+};
+
+//----------------------------------------------------------------------------
+// D3DX11EffectNameHash:
+// ---------------------
+// FNV-1a hash of a variable, constant buffer or technique name, as expected
+// by the ID3DX11Effect::Get*ByHashedName lookups. It is constexpr so that a
+// name known at compile time is hashed by the compiler, e.g.
+//
+//     static const uint32_t c_WVPHash = D3DX11EffectNameHash("WorldViewProjection");
+//     pEffect->GetVariableByHashedName(c_WVPHash, "WorldViewProjection");
+//----------------------------------------------------------------------------
+
+inline constexpr uint32_t D3DX11EffectNameHash(_In_z_ const char* Name, _In_ uint32_t Hash = 2166136261u)
+{
+    return (*Name == 0) ? Hash : D3DX11EffectNameHash(Name + 1, (Hash ^ static_cast<uint8_t>(*Name)) * 16777619u);
+}
+
 typedef interface ID3DX11Effect ID3DX11Effect;
 typedef interface ID3DX11Effect *LPD3D11EFFECT;
 
@@ -1041,6 +1103,12 @@ DECLARE_INTERFACE_(ID3DX11Effect, IUnknown)
     STDMETHOD(CloneEffect)(THIS_ _In_ uint32_t Flags, _Outptr_ ID3DX11Effect** ppClonedEffect ) PURE;
     STDMETHOD(Optimize)(THIS) PURE;
     STDMETHOD_(bool, IsOptimized)(THIS) PURE;
+
+    // Name lookups through the effect's hash index. Hash is D3DX11EffectNameHash(Name),
+    // typically computed at compile time; Name is still compared to confirm the match.
+    STDMETHOD_(ID3DX11EffectConstantBuffer*, GetConstantBufferByHashedName)(THIS_ _In_ uint32_t Hash, _In_z_ LPCSTR Name) PURE;
+    STDMETHOD_(ID3DX11EffectVariable*, GetVariableByHashedName)(THIS_ _In_ uint32_t Hash, _In_z_ LPCSTR Name) PURE;
+    STDMETHOD_(ID3DX11EffectTechnique*, GetTechniqueByHashedName)(THIS_ _In_ uint32_t Hash, _In_z_ LPCSTR Name) PURE;
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1195,6 +1263,42 @@ HRESULT D3DX11CompileEffectFromFile( _In_z_ LPCWSTR pFileName,
                                      _Out_ ID3DX11Effect **ppEffect,
                                      _Outptr_opt_result_maybenull_ ID3DBlob **ppErrors );
 
+//----------------------------------------------------------------------------
+// D3DX11GetEffectUploadStats
+//
+// Returns the constant buffer upload totals; the difference between two
+// calls gives, for example, the bytes uploaded in a frame
+//
+// Parameters:
+//
+// [out]
+//
+//  pStats
+//      Receives the totals
+//
+//----------------------------------------------------------------------------
+
+void WINAPI D3DX11GetEffectUploadStats( _Out_ D3DX11_EFFECT_UPLOAD_STATS *pStats );
+
+//----------------------------------------------------------------------------
+// D3DX11SetEffectStateFactory
+//
+// Installs the factory that creates the state objects of every effect
+// created from then on, and of state blocks recreated at Apply time.
+// The factory must outlive those effects' use of it; pass nullptr to
+// go back to creating state objects on the device.
+//
+// Parameters:
+//
+// [in]
+//
+//  pFactory [optional]
+//      The factory, or nullptr
+//
+//----------------------------------------------------------------------------
+
+void WINAPI D3DX11SetEffectStateFactory( _In_opt_ ID3DX11EffectStateFactory *pFactory );
+
 #ifdef __cplusplus
 }
 #endif //__cplusplus
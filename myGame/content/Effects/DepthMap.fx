@@ -1,6 +1,12 @@
+#include "include\\Common.fxh"
+#include "include\\FrameConstants.fxh"
+#include "include\\ShadowMappingPermutations.fxh"
+
 cbuffer CBufferPerObject
 {
     float4x4 WorldLightViewProjection;
+    float3 PositionScale = { 1.0f, 1.0f, 1.0f };
+    float3 PositionOffset = { 0.0f, 0.0f, 0.0f };
 }
 
 struct VS_OUTPUT
@@ -9,7 +15,7 @@ struct VS_OUTPUT
     float2 Depth : TEXCOORD;
 };
 
-float4 create_depthmap_vertex_shader(float4 ObjectPosition : POSITION) : SV_Position
+float4 create_depthmap_full_vertex_shader(float4 ObjectPosition : POSITION) : SV_Position
 {
     return mul(ObjectPosition, WorldLightViewProjection);
 }
@@ -24,6 +30,16 @@ VS_OUTPUT create_depthmap_w_render_target_vertex_shader(float4 ObjectPosition :
     return OUT;
 }
 
+float4 create_depthmap_compact_vertex_shader(float4 QuantizedPosition : POSITION) : SV_Position
+{
+    return create_depthmap_full_vertex_shader(get_dequantized_position(QuantizedPosition, PositionScale, PositionOffset));
+}
+
+VS_OUTPUT create_depthmap_w_render_target_compact_vertex_shader(float4 QuantizedPosition : POSITION)
+{
+    return create_depthmap_w_render_target_vertex_shader(get_dequantized_position(QuantizedPosition, PositionScale, PositionOffset));
+}
+
 float4 create_depthmap_w_render_target_pixel_shader(VS_OUTPUT IN) : SV_Target
 {
     IN.Depth.x /= IN.Depth.y;
@@ -31,31 +47,34 @@ float4 create_depthmap_w_render_target_pixel_shader(VS_OUTPUT IN) : SV_Target
     return float4(IN.Depth.x, 0, 0, 1);
 }
 
-technique11 create_depthmap
-{
-    pass p0
-    {
-        SetVertexShader(CompileShader(vs_5_0, create_depthmap_vertex_shader()));
-        SetGeometryShader(NULL);
-        SetPixelShader(NULL);
-    }
+#define DEPTH_MAP_TECHNIQUE(TechniqueName, Layout, Flags) \
+technique11 TechniqueName \
+{ \
+    pass p0 \
+    { \
+        SetVertexShader(CompileShader(vs_5_0, create_depthmap_##Layout##_vertex_shader())); \
+        SetGeometryShader(NULL); \
+        SetPixelShader(NULL); \
+    } \
 }
 
-technique11 create_depthmap_w_bias
+DEPTH_MAP_PERMUTATIONS(DEPTH_MAP_TECHNIQUE)
+
+technique11 create_depthmap_w_render_target
 {
     pass p0
     {
-        SetVertexShader(CompileShader(vs_5_0, create_depthmap_vertex_shader()));
+        SetVertexShader(CompileShader(vs_5_0, create_depthmap_w_render_target_vertex_shader()));
         SetGeometryShader(NULL);
-        SetPixelShader(NULL);
+        SetPixelShader(CompileShader(ps_5_0, create_depthmap_w_render_target_pixel_shader()));
     }
 }
 
-technique11 create_depthmap_w_render_target
+technique11 create_depthmap_w_render_target_compact
 {
     pass p0
     {
-        SetVertexShader(CompileShader(vs_5_0, create_depthmap_w_render_target_vertex_shader()));
+        SetVertexShader(CompileShader(vs_5_0, create_depthmap_w_render_target_compact_vertex_shader()));
         SetGeometryShader(NULL);
         SetPixelShader(CompileShader(ps_5_0, create_depthmap_w_render_target_pixel_shader()));
     }
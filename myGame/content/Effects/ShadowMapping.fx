@@ -1,20 +1,12 @@
 #include "include\\Common.fxh"
+#include "include\\FrameConstants.fxh"
+#include "include\\ShadowMappingPermutations.fxh"
 
 /************* Resources *************/
 static const float4 ColorWhite = { 1, 1, 1, 1 };
 static const float3 ColorBlack = { 0, 0, 0 };
 static const float DepthBias = 0.005;
 
-cbuffer CBufferPerFrame
-{
-    float4 AmbientColor = { 1.0f, 1.0f, 1.0f, 0.0f };
-    float4 LightColor = { 1.0f, 1.0f, 1.0f, 1.0f };
-    float3 LightPosition = { 0.0f, 0.0f, 0.0f };
-    float LightRadius = 10.0f;
-    float3 CameraPosition;
-    float2 ShadowMapSize = { 1024.0f, 1024.0f };
-}
-
 cbuffer CBufferPerObject
 {
     float4x4 WorldViewProjection : WORLDVIEWPROJECTION;
@@ -23,6 +15,9 @@ cbuffer CBufferPerObject
     float SpecularPower : SPECULARPOWER  = 25.0f;
 
     float4x4 ProjectiveTextureMatrix;
+
+    float3 PositionScale = { 1.0f, 1.0f, 1.0f };
+    float3 PositionOffset = { 0.0f, 0.0f, 0.0f };
 }
 
 Texture2D ColorTexture;
@@ -66,6 +61,13 @@ struct VS_INPUT
     float3 Normal : NORMAL;
 };
 
+struct VS_COMPACT_INPUT
+{
+    float4 QuantizedPosition : POSITION;
+    float2 TextureCoordinate : TEXCOORD;
+    float2 EncodedNormal : NORMAL;
+};
+
 struct VS_OUTPUT
 {
     float4 Position : SV_Position;
@@ -78,7 +80,7 @@ struct VS_OUTPUT
 
 /************* Vertex Shader *************/
 
-VS_OUTPUT vertex_shader(VS_INPUT IN)
+VS_OUTPUT full_vertex_shader(VS_INPUT IN)
 {
     VS_OUTPUT OUT = (VS_OUTPUT)0;      
 
@@ -95,9 +97,20 @@ VS_OUTPUT vertex_shader(VS_INPUT IN)
     return OUT;
 }
 
+VS_OUTPUT compact_vertex_shader(VS_COMPACT_INPUT IN)
+{
+    VS_INPUT decoded;
+    decoded.ObjectPosition = get_dequantized_position(IN.QuantizedPosition, PositionScale, PositionOffset);
+    decoded.TextureCoordinate = IN.TextureCoordinate;
+    decoded.Normal = get_octahedral_decoded_vector(IN.EncodedNormal);
+
+    return full_vertex_shader(decoded);
+}
+
 /************* Pixel Shaders *************/
 
-float4 shadow_pixel_shader(VS_OUTPUT IN) : SV_Target
+// Specialized per technique: the permutation is a compile-time constant, so the branches on it fold away
+float4 shadow_pixel_shader(VS_OUTPUT IN, uniform uint permutation) : SV_Target
 {
     float4 OUT = (float4)0;
 
@@ -111,107 +124,57 @@ float4 shadow_pixel_shader(VS_OUTPUT IN) : SV_Target
     float3 halfVector = normalize(lightDirection + viewDirection);
     float n_dot_h = dot(normal, halfVector);
 
-    float4 color = ColorTexture.Sample(ColorSampler, IN.TextureCoordinate);
+    float4 color = ((permutation & SHADOW_MAPPING_TEXTURE) ? ColorTexture.Sample(ColorSampler, IN.TextureCoordinate) : ColorWhite);
     float4 lightCoefficients = lit(n_dot_l, n_dot_h, SpecularPower);
 
     float3 ambient = get_vector_color_contribution(AmbientColor, color.rgb);
     float3 diffuse = get_vector_color_contribution(LightColor, lightCoefficients.y * color.rgb) * IN.Attenuation;
     float3 specular = get_scalar_color_contribution(SpecularColor, min(lightCoefficients.z, color.w)) * IN.Attenuation;
 
-    if (IN.ShadowTextureCoordinate.w >= 0.0f)
+    float depthBias = ((permutation & SHADOW_MAPPING_DEPTH_BIAS) ? DepthBias : 0.0f);
+
+    if (permutation & SHADOW_MAPPING_PCF)
     {
         IN.ShadowTextureCoordinate.xyz /= IN.ShadowTextureCoordinate.w;
-        float pixelDepth = IN.ShadowTextureCoordinate.z;
-        float sampledDepth = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy).x + DepthBias;
+        float pixelDepth = IN.ShadowTextureCoordinate.z - depthBias;
 
-        // Shadow applied in a boolean fashion -- either in shadow or not
-        float3 shadow = (pixelDepth > sampledDepth ? ColorBlack : ColorWhite.rgb);
+        float shadow = ShadowMap.SampleCmpLevelZero(PcfShadowMapSampler, IN.ShadowTextureCoordinate.xy, pixelDepth).x;
         diffuse *= shadow;
         specular *= shadow;
     }
-
-    OUT.rgb = ambient + diffuse + specular;
-    OUT.a = 1.0f;
-
-    return OUT;
-}
-
-float4 shadow_manual_pcf_pixel_shader(VS_OUTPUT IN) : SV_Target
-{
-    float4 OUT = (float4)0;
-
-    float3 lightDirection = LightPosition - IN.WorldPosition;
-    lightDirection = normalize(lightDirection);
-
-    float3 viewDirection = normalize(CameraPosition - IN.WorldPosition);
-
-    float3 normal = normalize(IN.Normal);
-    float n_dot_l = dot(normal, lightDirection);
-    float3 halfVector = normalize(lightDirection + viewDirection);
-    float n_dot_h = dot(normal, halfVector);
-
-    float4 color = ColorTexture.Sample(ColorSampler, IN.TextureCoordinate);
-    float4 lightCoefficients = lit(n_dot_l, n_dot_h, SpecularPower);
-
-    float3 ambient = get_vector_color_contribution(AmbientColor, color.rgb);
-    float3 diffuse = get_vector_color_contribution(LightColor, lightCoefficients.y * color.rgb) * IN.Attenuation;
-    float3 specular = get_scalar_color_contribution(SpecularColor, min(lightCoefficients.z, color.w)) * IN.Attenuation;
-
-    if (IN.ShadowTextureCoordinate.w >= 0.0f)
+    else if (IN.ShadowTextureCoordinate.w >= 0.0f)
     {
         IN.ShadowTextureCoordinate.xyz /= IN.ShadowTextureCoordinate.w;
-
-        float2 texelSize = 1.0f / ShadowMapSize;
-        float sampledDepth1 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy).x + DepthBias;
-        float sampledDepth2 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(texelSize.x, 0)).x + DepthBias;
-        float sampledDepth3 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(0, texelSize.y)).x + DepthBias;
-        float sampledDepth4 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(texelSize.x, texelSize.y)).x + DepthBias;
-        
         float pixelDepth = IN.ShadowTextureCoordinate.z;
-        float shadowFactor1 = (pixelDepth > sampledDepth1 ? 0.0f : 1.0f);
-        float shadowFactor2 = (pixelDepth > sampledDepth2 ? 0.0f : 1.0f);
-        float shadowFactor3 = (pixelDepth > sampledDepth3 ? 0.0f : 1.0f);
-        float shadowFactor4 = (pixelDepth > sampledDepth4 ? 0.0f : 1.0f);		
-        
-        float2 lerpValues = frac(IN.ShadowTextureCoordinate.xy * ShadowMapSize);
-        float shadow = lerp(lerp(shadowFactor1, shadowFactor2, lerpValues.x), lerp(shadowFactor3, shadowFactor4, lerpValues.x), lerpValues.y);
-        diffuse *= shadow;
-        specular *= shadow;
-    }
-
-    OUT.rgb = ambient + diffuse + specular;
-    OUT.a = 1.0f;
-
-    return OUT;
-}
-
-float4 shadow_pcf_pixel_shader(VS_OUTPUT IN) : SV_Target
-{
-    float4 OUT = (float4)0;
-
-    float3 lightDirection = LightPosition - IN.WorldPosition;
-    lightDirection = normalize(lightDirection);
-
-    float3 viewDirection = normalize(CameraPosition - IN.WorldPosition);
-
-    float3 normal = normalize(IN.Normal);
-    float n_dot_l = dot(normal, lightDirection);
-    float3 halfVector = normalize(lightDirection + viewDirection);
-    float n_dot_h = dot(normal, halfVector);
-
-    float4 color = ColorTexture.Sample(ColorSampler, IN.TextureCoordinate);
-    float4 lightCoefficients = lit(n_dot_l, n_dot_h, SpecularPower);
-
-    float3 ambient = get_vector_color_contribution(AmbientColor, color.rgb);
-    float3 diffuse = get_vector_color_contribution(LightColor, lightCoefficients.y * color.rgb) * IN.Attenuation;
-    float3 specular = get_scalar_color_contribution(SpecularColor, min(lightCoefficients.z, color.w)) * IN.Attenuation;
-
-    IN.ShadowTextureCoordinate.xyz /= IN.ShadowTextureCoordinate.w;
-    float pixelDepth = IN.ShadowTextureCoordinate.z;
 
-    float shadow = ShadowMap.SampleCmpLevelZero(PcfShadowMapSampler, IN.ShadowTextureCoordinate.xy, pixelDepth).x;
-    diffuse *= shadow;
-    specular *= shadow;
+        if (permutation & SHADOW_MAPPING_MANUAL_PCF)
+        {
+            float2 texelSize = 1.0f / ShadowMapSize;
+            float sampledDepth1 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy).x + depthBias;
+            float sampledDepth2 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(texelSize.x, 0)).x + depthBias;
+            float sampledDepth3 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(0, texelSize.y)).x + depthBias;
+            float sampledDepth4 = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy + float2(texelSize.x, texelSize.y)).x + depthBias;
+
+            float shadowFactor1 = (pixelDepth > sampledDepth1 ? 0.0f : 1.0f);
+            float shadowFactor2 = (pixelDepth > sampledDepth2 ? 0.0f : 1.0f);
+            float shadowFactor3 = (pixelDepth > sampledDepth3 ? 0.0f : 1.0f);
+            float shadowFactor4 = (pixelDepth > sampledDepth4 ? 0.0f : 1.0f);
+
+            float2 lerpValues = frac(IN.ShadowTextureCoordinate.xy * ShadowMapSize);
+            float shadow = lerp(lerp(shadowFactor1, shadowFactor2, lerpValues.x), lerp(shadowFactor3, shadowFactor4, lerpValues.x), lerpValues.y);
+            diffuse *= shadow;
+            specular *= shadow;
+        }
+        else
+        {
+            float sampledDepth = ShadowMap.Sample(ShadowMapSampler, IN.ShadowTextureCoordinate.xy).x + depthBias;
+
+            // Shadow applied in a boolean fashion -- either in shadow or not
+            float3 shadow = (pixelDepth > sampledDepth ? ColorBlack : ColorWhite.rgb);
+            diffuse *= shadow;
+            specular *= shadow;
+        }
+    }
 
     OUT.rgb = ambient + diffuse + specular;
     OUT.a = 1.0f;
@@ -221,38 +184,17 @@ float4 shadow_pcf_pixel_shader(VS_OUTPUT IN) : SV_Target
 
 /************* Techniques *************/
 
-technique11 shadow_mapping
-{
-    pass p0
-    {
-        SetVertexShader(CompileShader(vs_5_0, vertex_shader()));
-        SetGeometryShader(NULL);
-        SetPixelShader(CompileShader(ps_5_0, shadow_pixel_shader()));
-
-        SetRasterizerState(BackFaceCulling);
-    }
+#define SHADOW_MAPPING_TECHNIQUE(TechniqueName, Layout, Flags) \
+technique11 TechniqueName \
+{ \
+    pass p0 \
+    { \
+        SetVertexShader(CompileShader(vs_5_0, Layout##_vertex_shader())); \
+        SetGeometryShader(NULL); \
+        SetPixelShader(CompileShader(ps_5_0, shadow_pixel_shader(SHADOW_MAPPING_LAYOUT_##Layout | (Flags)))); \
+ \
+        SetRasterizerState(BackFaceCulling); \
+    } \
 }
 
-technique11 shadow_mapping_manual_pcf
-{
-    pass p0
-    {
-        SetVertexShader(CompileShader(vs_5_0, vertex_shader()));
-        SetGeometryShader(NULL);
-        SetPixelShader(CompileShader(ps_5_0, shadow_manual_pcf_pixel_shader()));
-
-        SetRasterizerState(BackFaceCulling);
-    }
-}
-
-technique11 shadow_mapping_pcf
-{
-    pass p0
-    {
-        SetVertexShader(CompileShader(vs_5_0, vertex_shader()));
-        SetGeometryShader(NULL);
-        SetPixelShader(CompileShader(ps_5_0, shadow_pcf_pixel_shader()));
-
-        SetRasterizerState(BackFaceCulling);
-    }
-}
\ No newline at end of file
+SHADOW_MAPPING_PERMUTATIONS(SHADOW_MAPPING_TECHNIQUE)
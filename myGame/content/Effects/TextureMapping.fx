@@ -1,3 +1,5 @@
+#include "include\\FrameConstants.fxh"
+
 /************* Resources *************/
 
 #define FLIP_TEXTURE_Y 0
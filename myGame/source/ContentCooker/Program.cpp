@@ -0,0 +1,593 @@
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <wincodec.h>
+#include "GameException.h"
+#include "Game.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "MeshQuantization.h"
+#include "MeshOptimizer.h"
+#include "ArchiveFileSystem.h"
+#include "Utility.h"
+
+using namespace Library;
+
+namespace
+{
+    const UINT BenchmarkIterations = 10;
+    const UINT LookupBenchmarkIterations = 100000;
+
+    const char* DefaultContent[] =
+    {
+        "..\\content\\Models\\environment.fbx",
+        "..\\content\\Models\\door.fbx",
+        "..\\content\\Textures\\environment_texture.png",
+        "..\\content\\Textures\\ceilling_texture.png",
+        "..\\content\\Textures\\door_texture.png",
+        "..\\content\\Textures\\secret_door_texture.png",
+        "..\\content\\Textures\\keypad_texture.png",
+        "..\\content\\Textures\\key_texture.png",
+        "..\\content\\Textures\\KeyNote.jpg",
+        "..\\content\\Textures\\note2.jpg",
+        "..\\content\\Textures\\painting_note.jpg",
+        "..\\content\\Textures\\menu.png",
+        "..\\content\\Textures\\credits.png",
+        "..\\content\\Textures\\end.png"
+    };
+
+    const std::string ModelsDirectory = "..\\content\\Models\\";
+    const std::string EffectsDirectory = "..\\content\\Effects\\";
+    const std::wstring ContentDirectory = L"..\\content";
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    bool HasExtension(const std::string& filename, const char* extension)
+    {
+        std::string::size_type extensionIndex = filename.find_last_of('.');
+        return (extensionIndex != std::string::npos && _stricmp(filename.c_str() + extensionIndex, extension) == 0);
+    }
+
+    bool IsModel(const std::string& filename)
+    {
+        return HasExtension(filename, ".fbx");
+    }
+
+    UINT64 FileSize(const std::wstring& filename)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (GetFileAttributesEx(filename.c_str(), GetFileExInfoStandard, &attributes) == FALSE)
+        {
+            return 0;
+        }
+
+        return (UINT64(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    }
+
+    // Models are always imported with flipped UVs, matching ModelFromFile, Door and ShadowMappingBase
+    void CookModel(Game& game, const std::string& filename)
+    {
+        Model model(game, filename, true, true);
+        if (model.Submeshes().size() == 0)
+        {
+            throw GameException("Model has no triangle meshes to cook.");
+        }
+
+        std::wstring cookedFilename = CookedMesh::CookedFilename(filename);
+        CookedMesh::Cook(model, cookedFilename);
+
+        std::wcout << L"Cooked " << cookedFilename << std::endl;
+    }
+
+    // Decodes any WIC-supported image into tightly packed RGBA8
+    void DecodeImage(IWICImagingFactory* factory, const std::wstring& filename, std::vector<byte>& pixels, UINT& width, UINT& height)
+    {
+        IWICBitmapDecoder* decoder = nullptr;
+        IWICBitmapFrameDecode* frame = nullptr;
+        IWICFormatConverter* converter = nullptr;
+
+        HRESULT hr = factory->CreateDecoderFromFilename(filename.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+        if (SUCCEEDED(hr))
+        {
+            hr = decoder->GetFrame(0, &frame);
+        }
+        if (SUCCEEDED(hr))
+        {
+            hr = frame->GetSize(&width, &height);
+        }
+        if (SUCCEEDED(hr))
+        {
+            hr = factory->CreateFormatConverter(&converter);
+        }
+        if (SUCCEEDED(hr))
+        {
+            hr = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+        }
+        if (SUCCEEDED(hr))
+        {
+            pixels.resize(width * height * 4);
+            hr = converter->CopyPixels(nullptr, width * 4, pixels.size(), &pixels[0]);
+        }
+
+        ReleaseObject(converter);
+        ReleaseObject(frame);
+        ReleaseObject(decoder);
+
+        if (FAILED(hr))
+        {
+            throw GameException("Failed to decode texture.", hr);
+        }
+    }
+
+    void CookTexture(IWICImagingFactory* factory, const std::wstring& filename)
+    {
+        std::vector<byte> pixels;
+        UINT width;
+        UINT height;
+        DecodeImage(factory, filename, pixels, width, height);
+
+        if (CookedTexture::CanCook(width, height) == false)
+        {
+            std::wcout << L"Skipped " << filename << L" (" << width << L"x" << height << L" is not a multiple of 4; loaded from source)" << std::endl;
+            return;
+        }
+
+        std::wstring cookedFilename = CookedTexture::CookedFilename(filename);
+        CookedTexture::Cook(pixels, width, height, cookedFilename);
+
+        std::wcout << L"Cooked " << cookedFilename << std::endl;
+    }
+
+    // Reports the startup decode cost being replaced, the encoder's throughput and the PSNR of the
+    // top mip, plus the VRAM of RGBA8 with mips against the cooked file.
+    void BenchmarkTexture(IWICImagingFactory* factory, const std::wstring& filename)
+    {
+        std::vector<byte> pixels;
+        UINT width;
+        UINT height;
+
+        Clock::time_point start = Clock::now();
+        DecodeImage(factory, filename, pixels, width, height);
+        double decodeMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        CookedTextureFormat format = (CookedTexture::HasAlpha(pixels) ? CookedTextureFormatBC3 : CookedTextureFormatBC1);
+        std::vector<byte> blocks;
+        start = Clock::now();
+        CookedTexture::Compress(pixels, width, height, format, blocks);
+        double compressSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<byte> decompressed;
+        CookedTexture::Decompress(blocks, width, height, format, decompressed);
+
+        double squaredError = 0.0;
+        UINT channels = (format == CookedTextureFormatBC3 ? 4 : 3);
+        for (UINT i = 0; i < width * height; i++)
+        {
+            for (UINT channel = 0; channel < channels; channel++)
+            {
+                double delta = double(pixels[i * 4 + channel]) - double(decompressed[i * 4 + channel]);
+                squaredError += delta * delta;
+            }
+        }
+        double meanSquaredError = squaredError / (double(width) * height * channels);
+        double psnr = (meanSquaredError > 0.0 ? 10.0 * log10(255.0 * 255.0 / meanSquaredError) : INFINITY);
+
+        UINT64 uncompressedSize = UINT64(width) * height * 4 * 4 / 3;
+        UINT64 cookedSize = FileSize(CookedTexture::CookedFilename(filename));
+
+        std::wcout << filename << std::endl;
+        std::wcout << L"    " << (format == CookedTextureFormatBC3 ? L"BC3" : L"BC1") << L" " << width << L"x" << height << L", PSNR " << psnr << L" dB" << std::endl;
+        std::wcout << L"    decode: " << decodeMilliseconds << L" ms, encode: " << (double(width) * height / 1000000.0 / compressSeconds) << L" MPixels/s" << std::endl;
+        std::wcout << L"    VRAM: " << uncompressedSize << L" -> " << cookedSize << L" bytes (source file " << FileSize(filename) << L" bytes)" << std::endl;
+    }
+
+    // Vertex and index bytes the shadow and depth passes fetch per draw in the regular and the
+    // compact layouts, plus the worst-case error the quantization introduces.
+    void ReportCompactVertices(Game& game, const std::string& filename)
+    {
+        Model model(game, filename, true, true);
+        if (CookedMesh::SupportsVertexFormat(model, VertexFormatPositionTextureNormalQuantized) == false)
+        {
+            return;
+        }
+
+        // Only level 0 of each submesh is drawn by the shadow and depth passes
+        UINT vertexCount = model.VertexCount();
+        UINT indexCount = 0;
+        for (const ModelSubmesh& submesh : model.Submeshes())
+        {
+            indexCount += submesh.IndexCount;
+        }
+
+        UINT64 regularSize = UINT64(vertexCount) * (CookedMesh::VertexStride(VertexFormatPosition) + CookedMesh::VertexStride(VertexFormatPositionTextureNormal)) + UINT64(indexCount) * sizeof(UINT) * 2;
+        UINT64 compactSize = UINT64(vertexCount) * (CookedMesh::VertexStride(VertexFormatPositionQuantized) + CookedMesh::VertexStride(VertexFormatPositionTextureNormalQuantized)) + UINT64(indexCount) * MeshQuantization::IndexSize(MeshQuantization::IndexFormat(model.Submeshes())) * 2;
+
+        const BoundingBox& bounds = model.Bounds();
+        float maxPositionError = 0.0f;
+        float maxNormalError = 0.0f;
+        for (Mesh* mesh : model.Meshes())
+        {
+            if (mesh->IsTriangleList() == false)
+            {
+                continue;
+            }
+
+            for (UINT i = 0; i < mesh->Vertices().size(); i++)
+            {
+                XMFLOAT3 position = MeshQuantization::DequantizePosition(MeshQuantization::QuantizePosition(mesh->Vertices()[i], bounds), bounds);
+                XMVECTOR positionDelta = XMVectorSubtract(XMLoadFloat3(&position), XMLoadFloat3(&mesh->Vertices()[i]));
+                maxPositionError = (std::max)(maxPositionError, XMVectorGetX(XMVector3Length(positionDelta)));
+
+                XMFLOAT3 normal = MeshQuantization::DecodeOctahedral(MeshQuantization::EncodeOctahedral(mesh->Normals()[i]));
+                XMVECTOR normalAngle = XMVector3AngleBetweenNormals(XMLoadFloat3(&normal), XMVector3Normalize(XMLoadFloat3(&mesh->Normals()[i])));
+                maxNormalError = (std::max)(maxNormalError, XMConvertToDegrees(XMVectorGetX(normalAngle)));
+            }
+        }
+
+        std::cout << "    compact: " << regularSize << " -> " << compactSize << " bytes per shadow+depth draw, max error " << maxPositionError << " units / " << maxNormalError << " degrees" << std::endl;
+    }
+
+    // Compares the runtime FBX path (Assimp import plus interleaving every vertex format) against
+    // mapping the cooked file and reading its streams.
+    void BenchmarkModel(Game& game, const std::string& filename)
+    {
+        std::wstring cookedFilename = CookedMesh::CookedFilename(filename);
+        std::vector<byte> vertices;
+
+        Clock::time_point start = Clock::now();
+        for (UINT i = 0; i < BenchmarkIterations; i++)
+        {
+            Model model(game, filename, true, true);
+            for (UINT format = 0; format < VertexFormatEnd; format++)
+            {
+                if (CookedMesh::SupportsVertexFormat(model, VertexFormat(format)))
+                {
+                    CookedMesh::BuildVertices(model, VertexFormat(format), vertices);
+                }
+            }
+        }
+        double importMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / BenchmarkIterations;
+
+        UINT checksum = 0;
+        start = Clock::now();
+        for (UINT i = 0; i < BenchmarkIterations; i++)
+        {
+            CookedMesh cookedMesh(cookedFilename);
+            for (UINT format = 0; format < VertexFormatEnd; format++)
+            {
+                if (cookedMesh.HasVertexFormat(VertexFormat(format)))
+                {
+                    // Touch every page so the mapping cost is not hidden by lazy faulting
+                    const byte* data = reinterpret_cast<const byte*>(cookedMesh.Vertices(VertexFormat(format)));
+                    UINT size = cookedMesh.VertexCount() * CookedMesh::VertexStride(VertexFormat(format));
+                    for (UINT offset = 0; offset < size; offset += 4096)
+                    {
+                        checksum += data[offset];
+                    }
+                }
+            }
+            checksum += cookedMesh.Indices()[cookedMesh.IndexCount() - 1];
+        }
+        double cookedMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / BenchmarkIterations;
+
+        std::cout << filename << std::endl;
+        std::cout << "    fbx:   " << importMilliseconds << " ms" << std::endl;
+        std::cout << "    pmesh: " << cookedMilliseconds << " ms (" << (importMilliseconds / cookedMilliseconds) << "x, checksum " << checksum << ")" << std::endl;
+
+        ReportCompactVertices(game, filename);
+    }
+
+    // Linear strcmp scan over the names, as Effects11 resolved them before it built its hash index
+    UINT FindLinear(const std::vector<std::string>& names, const char* name)
+    {
+        for (UINT i = 0; i < names.size(); i++)
+        {
+            if (strcmp(names[i].c_str(), name) == 0)
+            {
+                return i;
+            }
+        }
+
+        return names.size();
+    }
+
+    // Average nanoseconds per lookup of every name through lookup(name, hash)
+    template <typename Lookup>
+    double TimeLookups(const std::vector<std::string>& names, const std::vector<uint32_t>& hashes, Lookup lookup, UINT& checksum)
+    {
+        Clock::time_point start = Clock::now();
+        for (UINT i = 0; i < LookupBenchmarkIterations; i++)
+        {
+            for (UINT j = 0; j < names.size(); j++)
+            {
+                checksum += lookup(names[j].c_str(), hashes[j]);
+            }
+        }
+
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double(LookupBenchmarkIterations) * names.size());
+    }
+
+    template <typename NameLookup, typename HashedLookup>
+    void BenchmarkLookups(const char* category, const std::vector<std::string>& names, NameLookup nameLookup, HashedLookup hashedLookup)
+    {
+        if (names.size() == 0)
+        {
+            return;
+        }
+
+        std::vector<uint32_t> hashes;
+        for (const std::string& name : names)
+        {
+            hashes.push_back(D3DX11EffectNameHash(name.c_str()));
+        }
+
+        UINT checksum = 0;
+        double linearNanoseconds = TimeLookups(names, hashes, [&](const char* name, uint32_t) { return FindLinear(names, name); }, checksum);
+        double nameNanoseconds = TimeLookups(names, hashes, nameLookup, checksum);
+        double hashedNanoseconds = TimeLookups(names, hashes, hashedLookup, checksum);
+
+        std::cout << "    " << category << " (" << names.size() << "): linear " << linearNanoseconds << " ns, by name " << nameNanoseconds << " ns, pre-hashed " << hashedNanoseconds << " ns (checksum " << checksum << ")" << std::endl;
+    }
+
+    // Per-lookup cost of resolving every variable, constant buffer and (null group) technique name of
+    // each compiled effect in content\Effects: the old linear scan, Get*ByName, which now hashes the
+    // name and probes the effect's index, and Get*ByHashedName with the hash computed up front.
+    // The effects are created on a WARP device, so no GPU is needed.
+    void BenchmarkEffectLookups()
+    {
+        ID3D11Device* device = nullptr;
+        HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+        if (FAILED(hr))
+        {
+            throw GameException("D3D11CreateDevice() failed.", hr);
+        }
+
+        WIN32_FIND_DATAA findData;
+        HANDLE find = FindFirstFileA((EffectsDirectory + "*.cso").c_str(), &findData);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            ReleaseObject(device);
+            throw GameException("No compiled effects found in ..\\content\\Effects.");
+        }
+
+        do
+        {
+            std::string filename = EffectsDirectory + findData.cFileName;
+            std::vector<char> compiledEffect;
+            Utility::LoadBinaryFile(std::wstring(filename.begin(), filename.end()), compiledEffect);
+
+            ID3DX11Effect* effect = nullptr;
+            hr = D3DX11CreateEffectFromMemory(&compiledEffect.front(), compiledEffect.size(), 0, device, &effect);
+            if (FAILED(hr))
+            {
+                FindClose(find);
+                ReleaseObject(device);
+                throw GameException("D3DX11CreateEffectFromMemory() failed.", hr);
+            }
+
+            D3DX11_EFFECT_DESC effectDesc;
+            effect->GetDesc(&effectDesc);
+
+            std::vector<std::string> variableNames;
+            for (UINT i = 0; i < effectDesc.GlobalVariables; i++)
+            {
+                D3DX11_EFFECT_VARIABLE_DESC variableDesc;
+                effect->GetVariableByIndex(i)->GetDesc(&variableDesc);
+                variableNames.push_back(variableDesc.Name);
+            }
+
+            std::vector<std::string> constantBufferNames;
+            for (UINT i = 0; i < effectDesc.ConstantBuffers; i++)
+            {
+                D3DX11_EFFECT_VARIABLE_DESC constantBufferDesc;
+                effect->GetConstantBufferByIndex(i)->GetDesc(&constantBufferDesc);
+                constantBufferNames.push_back(constantBufferDesc.Name);
+            }
+
+            std::vector<std::string> techniqueNames;
+            for (UINT i = 0; i < effectDesc.Groups; i++)
+            {
+                ID3DX11EffectGroup* group = effect->GetGroupByIndex(i);
+                D3DX11_GROUP_DESC groupDesc;
+                group->GetDesc(&groupDesc);
+                if (groupDesc.Name != nullptr)
+                {
+                    continue;
+                }
+
+                for (UINT j = 0; j < groupDesc.Techniques; j++)
+                {
+                    D3DX11_TECHNIQUE_DESC techniqueDesc;
+                    group->GetTechniqueByIndex(j)->GetDesc(&techniqueDesc);
+                    techniqueNames.push_back(techniqueDesc.Name);
+                }
+            }
+
+            std::cout << filename << std::endl;
+            BenchmarkLookups("variables", variableNames,
+                [&](const char* name, uint32_t) { return UINT(effect->GetVariableByName(name)->IsValid()); },
+                [&](const char* name, uint32_t hash) { return UINT(effect->GetVariableByHashedName(hash, name)->IsValid()); });
+            BenchmarkLookups("constant buffers", constantBufferNames,
+                [&](const char* name, uint32_t) { return UINT(effect->GetConstantBufferByName(name)->IsValid()); },
+                [&](const char* name, uint32_t hash) { return UINT(effect->GetConstantBufferByHashedName(hash, name)->IsValid()); });
+            BenchmarkLookups("techniques", techniqueNames,
+                [&](const char* name, uint32_t) { return UINT(effect->GetTechniqueByName(name)->IsValid()); },
+                [&](const char* name, uint32_t hash) { return UINT(effect->GetTechniqueByHashedName(hash, name)->IsValid()); });
+
+            ReleaseObject(effect);
+        } while (FindNextFileA(find, &findData));
+
+        FindClose(find);
+        ReleaseObject(device);
+    }
+
+    // Post-transform cache efficiency of every mesh in content\Models as Assimp delivers it and
+    // after Mesh::Optimize, simulated with a FIFO cache of MeshOptimizer::VertexCacheSize entries.
+    void AnalyzeModels(Game& game)
+    {
+        WIN32_FIND_DATAA findData;
+        HANDLE find = FindFirstFileA((ModelsDirectory + "*").c_str(), &findData);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            throw GameException("No models found in ..\\content\\Models.");
+        }
+
+        do
+        {
+            std::string filename = ModelsDirectory + findData.cFileName;
+            if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 || (HasExtension(filename, ".fbx") == false && HasExtension(filename, ".obj") == false && HasExtension(filename, ".3ds") == false))
+            {
+                continue;
+            }
+
+            Clock::time_point start = Clock::now();
+            Model importedModel(game, filename, true, false);
+            double importMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            start = Clock::now();
+            Model optimizedModel(game, filename, true, true);
+            double optimizedMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            std::cout << filename << " (import " << importMilliseconds << " ms, with optimization " << optimizedMilliseconds << " ms)" << std::endl;
+            for (UINT i = 0; i < importedModel.Meshes().size(); i++)
+            {
+                const Mesh& importedMesh = *importedModel.Meshes().at(i);
+                const Mesh& optimizedMesh = *optimizedModel.Meshes().at(i);
+
+                VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(importedMesh.Indices().data(), importedMesh.Indices().size(), importedMesh.Vertices().size());
+                VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(optimizedMesh.Indices().data(), optimizedMesh.Indices().size(), optimizedMesh.Vertices().size());
+
+                std::cout << "    mesh " << i << ": " << importedMesh.FaceCount() << " faces, ACMR " << before.ACMR << " -> " << after.ACMR << ", ATVR " << before.ATVR << " -> " << after.ATVR << std::endl;
+
+                std::cout << "        levels of detail:";
+                for (const MeshLevelOfDetail& level : optimizedMesh.LevelsOfDetail())
+                {
+                    std::cout << " " << level.IndexCount / 3 << " (error " << level.Error << ")";
+                }
+                std::cout << std::endl;
+            }
+        } while (FindNextFileA(find, &findData));
+
+        FindClose(find);
+    }
+}
+
+// Usage: ContentCooker [-benchmark] [-analyze] [-pack] [model.fbx | texture.png ...]
+// Writes a .pmesh next to each model and a block-compressed .dds next to each texture. With no
+// files, cooks the default content list from ..\content (run from myGame\source); the Game
+// pre-build step copies the results with the rest of the content. -benchmark also times the
+// name lookups of the compiled effects in ..\content\Effects. -analyze only reports the
+// vertex cache statistics and level-of-detail triangle counts of everything in ..\content\Models.
+// -pack then writes all of ..\content, cooked files included, to ..\content.pak, which the game
+// mounts over the loose directory.
+int main(int argc, char* argv[])
+{
+    bool benchmark = false;
+    bool analyze = false;
+    bool pack = false;
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        if (argument == "-benchmark")
+        {
+            benchmark = true;
+        }
+        else if (argument == "-analyze")
+        {
+            analyze = true;
+        }
+        else if (argument == "-pack")
+        {
+            pack = true;
+        }
+        else
+        {
+            filenames.push_back(argument);
+        }
+    }
+
+    if (filenames.size() == 0)
+    {
+        filenames.assign(DefaultContent, DefaultContent + ARRAYSIZE(DefaultContent));
+    }
+
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+    {
+        std::cerr << "CoInitializeEx() failed." << std::endl;
+        return 1;
+    }
+
+    IWICImagingFactory* imagingFactory = nullptr;
+    if (FAILED(hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&imagingFactory))))
+    {
+        std::cerr << "CoCreateInstance() failed creating the WIC imaging factory." << std::endl;
+        CoUninitialize();
+        return 1;
+    }
+
+    // The game is never run; Model only needs it as an owner
+    Game game(GetModuleHandle(nullptr), L"ContentCooker", L"Content Cooker", SW_HIDE);
+
+    int result = 0;
+    try
+    {
+        if (analyze)
+        {
+            AnalyzeModels(game);
+            filenames.clear();
+        }
+
+        for (const std::string& filename : filenames)
+        {
+            if (IsModel(filename))
+            {
+                CookModel(game, filename);
+
+                if (benchmark)
+                {
+                    BenchmarkModel(game, filename);
+                }
+            }
+            else
+            {
+                std::wstring textureFilename(filename.begin(), filename.end());
+                CookTexture(imagingFactory, textureFilename);
+
+                if (benchmark)
+                {
+                    BenchmarkTexture(imagingFactory, textureFilename);
+                }
+            }
+        }
+
+        if (benchmark)
+        {
+            BenchmarkEffectLookups();
+        }
+
+        if (pack)
+        {
+            std::wstring archiveFilename = ContentDirectory + ArchiveFileSystem::Extension;
+            ArchiveFileSystem::Pack(ContentDirectory, archiveFilename);
+
+            ArchiveFileSystem archive(archiveFilename);
+            std::wcout << L"Packed " << archive.EntryCount() << L" files into " << archiveFilename << L" (" << FileSize(archiveFilename) << L" bytes)" << std::endl;
+        }
+    }
+    catch (GameException ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        result = 1;
+    }
+
+    ReleaseObject(imagingFactory);
+    CoUninitialize();
+
+    return result;
+}
@@ -13,6 +13,7 @@
 #include <WICTextureLoader.h>
 #include "ProxyModel.h"
 #include "RenderStateHelper.h"
+#include "SpriteFontLoader.h"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include <sstream>
@@ -106,7 +107,7 @@ namespace Rendering
 		mRenderStateHelper = new RenderStateHelper(*mGame);
 
 		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
-		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
+		mSpriteFont = SpriteFontLoader::CreateSpriteFont(mGame->Direct3DDevice(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
 	}
 
 	void ObjectDiffuseLight::Update(const GameTime& gameTime)
@@ -123,7 +124,7 @@ namespace Rendering
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		Pass* pass = mMaterial->CurrentTechnique()->Passes().at(0);
-		ID3D11InputLayout* inputLayout = mMaterial->InputLayouts().at(pass);
+		ID3D11InputLayout* inputLayout = mMaterial->InputLayout(*pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);		
 
 		UINT stride = mMaterial->VertexSize();
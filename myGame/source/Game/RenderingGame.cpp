@@ -9,9 +9,23 @@
 #include "Door.h"
 #include "FpsComponent.h"
 #include "RenderStateHelper.h"
+#include "ModelCache.h"
+#include "TextureCache.h"
+#include "FrameConstants.h"
+#include "EffectRegistry.h"
+#include "InputLayoutCache.h"
+#include "StateObjectCache.h"
+#include "AssetLoader.h"
+#include "VirtualFileSystem.h"
+#include "DirectoryFileSystem.h"
+#include "ArchiveFileSystem.h"
+#include "SpriteFontLoader.h"
+#include "Utility.h"
+#include "RenderStatistics.h"
 //#include "ObjectDiffuseLight.h"
 #include "SamplerStates.h"
 #include "RasterizerStates.h"
+#include "BlendStates.h"
 #include "ShadowMappingBase.h"
 #include "ShadowMappingMenu.h"
 #include "ShadowMappingCredits.h"
@@ -33,7 +47,7 @@ namespace Rendering
 	RenderingGame::RenderingGame(HINSTANCE instance, const std::wstring& windowClass, const std::wstring& windowTitle, int showCommand)
 		: Game(instance, windowClass, windowTitle, showCommand),
 		mDirectInput(nullptr), keyboard(nullptr), mouse(nullptr),
-		mFpsComponent(nullptr), mRenderStateHelper(nullptr), shadowMapping(nullptr)
+		mFpsComponent(nullptr), mRenderStateHelper(nullptr), mModelCache(nullptr), mTextureCache(nullptr), mFrameConstants(nullptr), mEffectRegistry(nullptr), mInputLayoutCache(nullptr), mStateObjectCache(nullptr), mAssetLoader(nullptr), mRenderStatistics(nullptr), shadowMapping(nullptr)
 		/*mDemo(nullptr), mDirectInput(nullptr), mKeyboard(nullptr), mMouse(nullptr), mModel1(nullptr), mModel2(nullptr),
 		mFpsComponent(nullptr), mRenderStateHelper(nullptr), mObjectDiffuseLight(nullptr)*/
     {
@@ -52,10 +66,49 @@ namespace Rendering
 
 	void RenderingGame::Initialize()
 	{
+		// Every content path resolves through the mount points; the packed archive (ContentCooker -pack)
+		// takes priority over the loose directory whenever it has been built
+		std::wstring contentDirectory = Utility::ExecutableDirectory() + L"\\Content";
+		VirtualFileSystem::Mount("content", std::make_shared<DirectoryFileSystem>(contentDirectory));
+
+		std::wstring archiveFilename = contentDirectory + ArchiveFileSystem::Extension;
+		if (GetFileAttributes(archiveFilename.c_str()) != INVALID_FILE_ATTRIBUTES)
+		{
+			VirtualFileSystem::Mount("content", std::make_shared<ArchiveFileSystem>(archiveFilename));
+		}
+
 		camera = new FirstPersonCamera(*this);
 		commonComponents.push_back(camera);
 		mServices.AddService(Camera::TypeIdClass(), camera);
 
+		mModelCache = new ModelCache(*this);
+		mServices.AddService(ModelCache::TypeIdClass(), mModelCache);
+
+		mTextureCache = new TextureCache(*this);
+		mServices.AddService(TextureCache::TypeIdClass(), mTextureCache);
+
+		mFrameConstants = new FrameConstants(*this);
+		mServices.AddService(FrameConstants::TypeIdClass(), mFrameConstants);
+
+		// Installs itself as the Effects11 state factory, so it comes before any effect is created
+		mStateObjectCache = new StateObjectCache(*this);
+		mServices.AddService(StateObjectCache::TypeIdClass(), mStateObjectCache);
+		RasterizerStates::Initialize(*mStateObjectCache);
+		BlendStates::Initialize(*mStateObjectCache);
+		SamplerStates::Initialize(*mStateObjectCache);
+
+		mEffectRegistry = new EffectRegistry(*this);
+		mServices.AddService(EffectRegistry::TypeIdClass(), mEffectRegistry);
+
+		mInputLayoutCache = new InputLayoutCache(*this);
+		mServices.AddService(InputLayoutCache::TypeIdClass(), mInputLayoutCache);
+
+		mAssetLoader = new AssetLoader(*this);
+		mServices.AddService(AssetLoader::TypeIdClass(), mAssetLoader);
+
+		mRenderStatistics = new RenderStatistics();
+		mServices.AddService(RenderStatistics::TypeIdClass(), mRenderStatistics);
+
 		currentPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);
 		rightVector = XMFLOAT3(1.0f, 0.0f, 0.0f);
 		forwardVector = XMFLOAT3(0.0f, 0.0f, -1.0f);
@@ -77,7 +130,7 @@ namespace Rendering
 		mRenderStateHelper = new RenderStateHelper(*this);
 
 		mSpriteBatch = new SpriteBatch(mDirect3DDeviceContext);
-		mSpriteFont = new SpriteFont(mDirect3DDevice, L"Content\\Fonts\\Arial_14_Regular.spritefont");
+		mSpriteFont = SpriteFontLoader::CreateSpriteFont(mDirect3DDevice, L"Content\\Fonts\\Arial_14_Regular.spritefont");
 
 		InitializeGame();
 		InitializeMenu();
@@ -85,6 +138,26 @@ namespace Rendering
 		InitializeEndGame();
 		Game::Initialize();
 
+		// However many scenes asked for an effect, its .cso must have come off disk (or out of the
+		// archive) once; checked in every build, against the file system rather than the registry
+		for (const std::wstring& filename : mEffectRegistry->Filenames())
+		{
+			if (VirtualFileSystem::OpenCount(filename) != 1)
+			{
+				std::string name(filename.begin(), filename.end());
+				throw GameException(("Effect was not read exactly once at startup: " + name).c_str());
+			}
+		}
+
+		// Everything requested up front has been consumed; drop the preloaded copies
+		mAssetLoader->Clear();
+		mTextureCache->Trim();
+		mTextureCache->ReportMemoryUsage();
+		mEffectRegistry->Trim();
+		mEffectRegistry->ReportUsage();
+		mInputLayoutCache->ReportUsage();
+		mStateObjectCache->ReportUsage();
+
 		SetState(GameState::Menu);
 		
 
@@ -105,6 +178,7 @@ namespace Rendering
 		mServices.AddService(Mouse::TypeIdClass(), mouse);
 
 		shadowMapping = new ShadowMappingBase(*this, *camera);
+		shadowMapping->SetUseCompactVertices(true);
 		gameComponents.push_back(shadowMapping);
 
 		//Set of Notes
@@ -234,11 +308,40 @@ namespace Rendering
 		DeleteObject(mFpsComponent);
 		DeleteObject(mRenderStateHelper);
 
+		mServices.RemoveService(RenderStatistics::TypeIdClass());
+		DeleteObject(mRenderStatistics);
+
+		mServices.RemoveService(AssetLoader::TypeIdClass());
+		DeleteObject(mAssetLoader);
+
+		mServices.RemoveService(InputLayoutCache::TypeIdClass());
+		DeleteObject(mInputLayoutCache);
+
+		mServices.RemoveService(EffectRegistry::TypeIdClass());
+		DeleteObject(mEffectRegistry);
+
+		SamplerStates::Release();
+		BlendStates::Release();
+		RasterizerStates::Release();
+
+		mServices.RemoveService(StateObjectCache::TypeIdClass());
+		DeleteObject(mStateObjectCache);
+
+		mServices.RemoveService(FrameConstants::TypeIdClass());
+		DeleteObject(mFrameConstants);
+
+		mServices.RemoveService(TextureCache::TypeIdClass());
+		DeleteObject(mTextureCache);
+
+		mServices.RemoveService(ModelCache::TypeIdClass());
+		DeleteObject(mModelCache);
+
 		//DeleteObject(mObjectDiffuseLight);
 
 		DeleteObject(mSpriteFont);
 		DeleteObject(mSpriteBatch);
 
+		VirtualFileSystem::UnmountAll();
 
 		Game::Shutdown();
 	}
@@ -666,6 +769,7 @@ namespace Rendering
         mDirect3DDeviceContext->ClearRenderTargetView(mRenderTargetView, reinterpret_cast<const float*>(&BackgroundColor));
         mDirect3DDeviceContext->ClearDepthStencilView(mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
+        mRenderStatistics->BeginFrame();
         Game::Draw(gameTime);
 		mRenderStateHelper->SaveAll();
 		mFpsComponent->Draw(gameTime);
@@ -673,6 +777,7 @@ namespace Rendering
 		
 		mRenderStateHelper->RestoreAll();
 
+		mRenderStatistics->EndFrame(gameTime);
        
         HRESULT hr = mSwapChain->Present(0, 0);
         if (FAILED(hr))
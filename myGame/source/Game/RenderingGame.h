@@ -17,6 +17,14 @@ namespace Library
 	class Keyboard;
 	class Mouse;
 	class FpsComponent;
+	class ModelCache;
+	class TextureCache;
+	class FrameConstants;
+	class EffectRegistry;
+	class InputLayoutCache;
+	class StateObjectCache;
+	class AssetLoader;
+	class RenderStatistics;
 
 }
 
@@ -106,6 +114,14 @@ namespace Rendering
 
 		FpsComponent* mFpsComponent;
 		RenderStateHelper* mRenderStateHelper;
+		ModelCache* mModelCache;
+		TextureCache* mTextureCache;
+		FrameConstants* mFrameConstants;
+		EffectRegistry* mEffectRegistry;
+		InputLayoutCache* mInputLayoutCache;
+		StateObjectCache* mStateObjectCache;
+		AssetLoader* mAssetLoader;
+		RenderStatistics* mRenderStatistics;
 		ShadowMappingBase* shadowMapping;
 		Player* mPlayer;
 
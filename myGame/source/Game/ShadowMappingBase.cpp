@@ -7,6 +7,14 @@
 #include "Camera.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "ModelCache.h"
+#include "AssetLoader.h"
+#include "CookedMesh.h"
+#include "MeshQuantization.h"
+#include "TextureCache.h"
+#include "EffectRegistry.h"
+#include "StateObjectCache.h"
+#include "FrameConstants.h"
 #include "Utility.h"
 #include "PointLight.h"
 #include "Keyboard.h"
@@ -18,10 +26,13 @@
 #include "ShadowMappingMaterial.h"
 #include "DepthMapMaterial.h"
 #include "DepthMap.h"
+#include "SpriteFontLoader.h"
+#include "ShadowMappingPermutations.fxh"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 #include "FirstPersonCamera.h"
 
 namespace Rendering
@@ -35,6 +46,24 @@ namespace Rendering
 	const UINT ShadowMappingBase::DepthMapHeight = 1024U;
 	const RECT ShadowMappingBase::DepthMapDestinationRectangle = { 0, 512, 256, 768 };
 	const float ShadowMappingBase::DepthBiasModulationRate = 10000;
+	const float ShadowMappingBase::DepthBiasStep = 500;
+	const float ShadowMappingBase::MaxDepthBias = 100000;
+	const float ShadowMappingBase::SlopeScaledDepthBiasStep = 0.1f;
+	const float ShadowMappingBase::MaxSlopeScaledDepthBias = 10.0f;
+	const UINT ShadowMappingBase::DepthBiasTrimInterval = 32;
+
+	// SHADOW_MAPPING_* flags of each ShadowMappingTechnique; Draw() adds the vertex layout
+	const UINT ShadowMappingTechniquePermutations[ShadowMappingTechniqueEnd] =
+	{
+		SHADOW_MAPPING_TEXTURE | SHADOW_MAPPING_DEPTH_BIAS,
+		SHADOW_MAPPING_TEXTURE | SHADOW_MAPPING_DEPTH_BIAS | SHADOW_MAPPING_MANUAL_PCF,
+		SHADOW_MAPPING_TEXTURE | SHADOW_MAPPING_PCF
+	};
+
+	#define SHADOW_MAPPING_PERMUTATION_ENTRY(TechniqueName, Layout, Flags) { #TechniqueName, SHADOW_MAPPING_LAYOUT_##Layout | (Flags) },
+
+	const EffectPermutation ShadowMappingPermutationList[] = { SHADOW_MAPPING_PERMUTATIONS(SHADOW_MAPPING_PERMUTATION_ENTRY) };
+	const EffectPermutation DepthMapPermutationList[] = { DEPTH_MAP_PERMUTATIONS(SHADOW_MAPPING_PERMUTATION_ENTRY) };
 
 	ShadowMappingBase::ShadowMappingBase(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera), mCheckerboardTexture(nullptr),
@@ -45,10 +74,11 @@ namespace Rendering
 		//mRenderableProjectorFrustum(nullptr),
 		mShadowMappingEffect(nullptr), mShadowMappingMaterial(nullptr),
 		mProjectedTextureScalingMatrix(MatrixHelper::Zero), mRenderStateHelper(game),
-		mModelPositionVertexBuffer(nullptr), mModelPositionUVNormalVertexBuffer(nullptr), mModelIndexBuffer(nullptr), mModelIndexCount(0),
-		mModelWorldMatrix(MatrixHelper::Identity), mDepthMapEffect(nullptr), mDepthMapMaterial(nullptr), mDepthMap(nullptr), mDrawDepthMap(false),
-		mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 40.0f), mActiveTechnique(ShadowMappingTechniqueSimple),
-		mDepthBiasState(nullptr), mDepthBias(0), mSlopeScaledDepthBias(2.0f), mFloorTexture(nullptr)
+		mModelPositionVertexBuffer(nullptr), mModelPositionUVNormalVertexBuffer(nullptr), mModelIndexBuffer(nullptr), mModelSubmeshes(),
+		mModelIndexFormat(DXGI_FORMAT_R32_UINT), mUseCompactVertices(false), mModelPositionScale(1.0f, 1.0f, 1.0f), mModelPositionOffset(0.0f, 0.0f, 0.0f),
+		mModelWorldMatrix(MatrixHelper::Identity), mFrameConstants(nullptr), mDepthMapEffect(nullptr), mDepthMapMaterial(nullptr), mDepthMap(nullptr), mDrawDepthMap(false),
+		mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 40.0f), mActiveTechnique(ShadowMappingTechniqueSimple), mShadowMappingPermutations(), mDepthMapPermutations(),
+		mDepthBiasState(nullptr), mDepthBias(0), mSlopeScaledDepthBias(2.0f), mDepthBiasStepCount(0), mFloorTexture(nullptr)
 	{
 	}
 
@@ -59,12 +89,10 @@ namespace Rendering
 		DeleteObject(mSpriteBatch);
 		DeleteObject(mDepthMap);
 		DeleteObject(mDepthMapMaterial);
-		DeleteObject(mDepthMapEffect);
 		ReleaseObject(mModelIndexBuffer);
 		ReleaseObject(mModelPositionUVNormalVertexBuffer);
 		ReleaseObject(mModelPositionVertexBuffer);
 		DeleteObject(mShadowMappingMaterial);
-		DeleteObject(mShadowMappingEffect);
 		//DeleteObject(mRenderableProjectorFrustum);
 		DeleteObject(mProjector);
 		DeleteObject(mProxyModel);
@@ -77,22 +105,44 @@ namespace Rendering
 		ReleaseObject(mFloorTexture);
 	}
 
+	void ShadowMappingBase::RequestAssets(AssetLoader& assetLoader)
+	{
+		RequestSceneAssets(assetLoader);
+		assetLoader.RequestModel("content\\Models\\environment.fbx", true);
+		assetLoader.RequestTexture(L"content\\Textures\\environment_texture.png");
+		assetLoader.RequestTexture(L"content\\Textures\\ceilling_texture.png");
+	}
+
+	// Effects and the light proxy shared by every shadow mapping scene
+	void ShadowMappingBase::RequestSceneAssets(AssetLoader& assetLoader)
+	{
+		assetLoader.RequestEffect(L"Content\\Effects\\ShadowMapping.cso");
+		assetLoader.RequestEffect(L"Content\\Effects\\DepthMap.cso");
+		assetLoader.RequestEffect(L"Content\\Effects\\BasicEffect.cso");
+		assetLoader.RequestModel("content\\Models\\PointLightProxy.obj", true);
+	}
+
 	void ShadowMappingBase::Initialize()
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-		// Initialize materials
-		mShadowMappingEffect = new Effect(*mGame);
-		mShadowMappingEffect->LoadCompiledEffect(L"Content\\Effects\\ShadowMapping.cso");
+		// Initialize materials. Each scene sets every variable before its passes, so the effects are shared
+		EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+		assert(effectRegistry != nullptr);
+
+		mShadowMappingEffect = effectRegistry->GetEffect(L"Content\\Effects\\ShadowMapping.cso");
 
 		mShadowMappingMaterial = new ShadowMappingMaterial();
 		mShadowMappingMaterial->Initialize(*mShadowMappingEffect);
 
-		mDepthMapEffect = new Effect(*mGame);
-		mDepthMapEffect->LoadCompiledEffect(L"Content\\Effects\\DepthMap.cso");
+		mDepthMapEffect = effectRegistry->GetEffect(L"Content\\Effects\\DepthMap.cso");
 
 		mDepthMapMaterial = new DepthMapMaterial();
 		mDepthMapMaterial->Initialize(*mDepthMapEffect);
+		InitializePassHandles();
+
+		mFrameConstants = (FrameConstants*)mGame->Services().GetService(FrameConstants::TypeIdClass());
+		assert(mFrameConstants != nullptr);
 
 		// Plane vertex buffers
 		VertexPositionTextureNormal positionUVNormalVertices[] =
@@ -122,22 +172,18 @@ namespace Rendering
 
 
 
+		// Shared with every other scene that samples the same image
+		TextureCache* textureCache = (TextureCache*)mGame->Services().GetService(TextureCache::TypeIdClass());
+		assert(textureCache != nullptr);
+
 		std::wstring textureName = L"content\\Textures\\environment_texture.png";
-		HRESULT hr = DirectX::CreateWICTextureFromFile(mGame->Direct3DDevice(), mGame->Direct3DDeviceContext(), textureName.c_str(), nullptr, &mCheckerboardTexture);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateWICTextureFromFile() failed.", hr);
-		}
+		mCheckerboardTexture = textureCache->GetTexture(textureName);
 
 
 		//create the floor texture
 
 		textureName = L"content\\Textures\\ceilling_texture.png";
-		hr = DirectX::CreateWICTextureFromFile(mGame->Direct3DDevice(), mGame->Direct3DDeviceContext(), textureName.c_str(), nullptr, &mFloorTexture);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateWICTextureFromFile() failed.", hr);
-		}
+		mFloorTexture = textureCache->GetTexture(textureName);
 
 
 		mPointLight = new PointLight(*mGame);
@@ -167,13 +213,54 @@ namespace Rendering
 		InitializeProjectedTextureScalingMatrix();
 
 		// Vertex and index buffers for a second model to render
-		std::unique_ptr<Model> model(new Model(*mGame, "content\\Models\\environment.fbx", true));
+		ModelCache* modelCache = (ModelCache*)mGame->Services().GetService(ModelCache::TypeIdClass());
+		assert(modelCache != nullptr);
+
+		const std::string environmentFilename = "content\\Models\\environment.fbx";
+		std::shared_ptr<CookedMesh> cookedMesh = modelCache->GetCookedMesh(environmentFilename);
+		if (mUseCompactVertices)
+		{
+			BoundingBox bounds;
+			if (cookedMesh != nullptr && cookedMesh->HasVertexFormat(VertexFormatPositionQuantized) && cookedMesh->HasVertexFormat(VertexFormatPositionTextureNormalQuantized))
+			{
+				mModelPositionVertexBuffer = modelCache->GetVertexBuffer(*cookedMesh, VertexFormatPositionQuantized);
+				mModelPositionUVNormalVertexBuffer = modelCache->GetVertexBuffer(*cookedMesh, VertexFormatPositionTextureNormalQuantized);
+				mModelIndexBuffer = modelCache->GetCompactIndexBuffer(*cookedMesh);
+				mModelIndexFormat = MeshQuantization::IndexFormat(cookedMesh->Submeshes());
+				mModelSubmeshes = cookedMesh->Submeshes();
+				bounds = cookedMesh->Bounds();
+			}
+			else
+			{
+				std::shared_ptr<Model> model = modelCache->GetModel(environmentFilename, true);
+
+				mModelPositionVertexBuffer = modelCache->GetVertexBuffer(*model, VertexFormatPositionQuantized);
+				mModelPositionUVNormalVertexBuffer = modelCache->GetVertexBuffer(*model, VertexFormatPositionTextureNormalQuantized);
+				mModelIndexBuffer = modelCache->GetCompactIndexBuffer(*model);
+				mModelIndexFormat = MeshQuantization::IndexFormat(model->Submeshes());
+				mModelSubmeshes = model->Submeshes();
+				bounds = model->Bounds();
+			}
 
-		Mesh* mesh = model->Meshes().at(0);
-		mDepthMapMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mModelPositionVertexBuffer);
-		mShadowMappingMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mModelPositionUVNormalVertexBuffer);
-		mesh->CreateIndexBuffer(&mModelIndexBuffer);
-		mModelIndexCount = mesh->Indices().size();
+			mModelPositionScale = MeshQuantization::PositionScale(bounds);
+			mModelPositionOffset = MeshQuantization::PositionOffset(bounds);
+		}
+		else if (cookedMesh != nullptr && cookedMesh->HasVertexFormat(VertexFormatPosition) && cookedMesh->HasVertexFormat(VertexFormatPositionTextureNormal))
+		{
+			mModelPositionVertexBuffer = modelCache->GetVertexBuffer(*cookedMesh, VertexFormatPosition);
+			mModelPositionUVNormalVertexBuffer = modelCache->GetVertexBuffer(*cookedMesh, VertexFormatPositionTextureNormal);
+			mModelIndexBuffer = modelCache->GetIndexBuffer(*cookedMesh);
+			mModelSubmeshes = cookedMesh->Submeshes();
+		}
+		else
+		{
+			std::shared_ptr<Model> model = modelCache->GetModel(environmentFilename, true);
+
+			mModelPositionVertexBuffer = modelCache->GetVertexBuffer(*model, VertexFormatPosition);
+			mModelPositionUVNormalVertexBuffer = modelCache->GetVertexBuffer(*model, VertexFormatPositionTextureNormal);
+			mModelIndexBuffer = modelCache->GetIndexBuffer(*model);
+			mModelSubmeshes = model->Submeshes();
+		}
 
 		XMStoreFloat4x4(&mModelWorldMatrix, XMMatrixRotationX(0.0f) * XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 4.25f, -4.5f));
 
@@ -182,7 +269,7 @@ namespace Rendering
 
 		mDepthMap = new DepthMap(*mGame, DepthMapWidth, DepthMapHeight);
 		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
-		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"content\\Fonts\\Arial_14_Regular.spritefont");
+		mSpriteFont = SpriteFontLoader::CreateSpriteFont(mGame->Direct3DDevice(), L"content\\Fonts\\Arial_14_Regular.spritefont");
 
 		UpdateDepthBiasState();
 	}
@@ -212,6 +299,13 @@ namespace Rendering
 	{
 		static float blendFactor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
+		// Per-frame values go to the shared constant buffer once; the passes below only set per-object data
+		mFrameConstants->SetAmbientColor(XMLoadColor(&mAmbientColor));
+		mFrameConstants->SetLight(mPointLight->ColorVector(), mPointLight->PositionVector(), mPointLight->Radius());
+		mFrameConstants->SetCameraPosition(mCamera->PositionVector());
+		mFrameConstants->SetShadowMapSize(static_cast<float>(DepthMapWidth), static_cast<float>(DepthMapHeight));
+		mFrameConstants->Commit();
+
 		// Depth map pass (render the teapot model only)
 		mRenderStateHelper.SaveRasterizerState();
 		mDepthMap->Begin();
@@ -220,30 +314,40 @@ namespace Rendering
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		direct3DDeviceContext->ClearDepthStencilView(mDepthMap->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-		Pass* pass = mDepthMapMaterial->CurrentTechnique()->Passes().at(0);
-		ID3D11InputLayout* inputLayout = mDepthMapMaterial->InputLayouts().at(pass);
+		UINT modelPermutation = ShadowMappingTechniquePermutations[mActiveTechnique] | (mUseCompactVertices ? SHADOW_MAPPING_COMPACT : 0);
+		Pass* pass = &mDepthMapEffect->GetPass(mDepthMapPermutations[modelPermutation & DEPTH_MAP_PERMUTATION_FLAGS]);
+		ID3D11InputLayout* inputLayout = mDepthMapMaterial->InputLayout(*pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);
 
 		direct3DDeviceContext->RSSetState(mDepthBiasState);
 
-		UINT stride = mDepthMapMaterial->VertexSize();
+		UINT stride = (mUseCompactVertices ? mDepthMapMaterial->CompactVertexSize() : mDepthMapMaterial->VertexSize());
 		UINT offset = 0;
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mModelPositionVertexBuffer, &stride, &offset);
-		direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+		direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, mModelIndexFormat, 0);
 
 		XMMATRIX modelWorldMatrix = XMLoadFloat4x4(&mModelWorldMatrix);
-		mDepthMapMaterial->WorldLightViewProjection() << modelWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix();
+		XMVECTOR modelPositionScale = XMLoadFloat3(&mModelPositionScale);
+		XMVECTOR modelPositionOffset = XMLoadFloat3(&mModelPositionOffset);
+		DepthMapMaterialConstants& depthMapConstants = mDepthMapMaterial->Constants().Data();
+		MaterialConstantBlock::StoreMatrix(depthMapConstants.WorldLightViewProjection, modelWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix());
+		XMStoreFloat3(&depthMapConstants.PositionScale, modelPositionScale);
+		XMStoreFloat3(&depthMapConstants.PositionOffset, modelPositionOffset);
+		mDepthMapMaterial->Constants().Commit();
 
 		pass->Apply(0, direct3DDeviceContext);
 
-		direct3DDeviceContext->DrawIndexed(mModelIndexCount, 0, 0); //shadow map drawing
+		for (const ModelSubmesh& submesh : mModelSubmeshes)
+		{
+			direct3DDeviceContext->DrawIndexed(submesh.IndexCount, submesh.StartIndex, submesh.BaseVertex); //shadow map drawing
+		}
 
 		mDepthMap->End();
 		mRenderStateHelper.RestoreRasterizerState();
 
 		// Projective texture mapping pass
-		pass = mShadowMappingMaterial->CurrentTechnique()->Passes().at(0);
-		inputLayout = mShadowMappingMaterial->InputLayouts().at(pass);
+		pass = &mShadowMappingEffect->GetPass(mShadowMappingPermutations[ShadowMappingTechniquePermutations[mActiveTechnique]]);
+		inputLayout = mShadowMappingMaterial->InputLayout(*pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);
 
 		// Draw model
@@ -254,26 +358,20 @@ namespace Rendering
 		XMMATRIX planeWorldMatrix = XMLoadFloat4x4(&mPlaneWorldMatrix);
 		XMMATRIX planeWVP = planeWorldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
 		XMMATRIX projectiveTextureMatrix = planeWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix() * XMLoadFloat4x4(&mProjectedTextureScalingMatrix);
-		XMVECTOR ambientColor = XMLoadColor(&mAmbientColor);
 		XMVECTOR specularColor = XMLoadColor(&mSpecularColor);
-		XMVECTOR shadowMapSize = XMVectorSet(static_cast<float>(DepthMapWidth), static_cast<float>(DepthMapHeight), 0.0f, 0.0f);
 
-		mShadowMappingMaterial->WorldViewProjection() << planeWVP;
-		mShadowMappingMaterial->World() << planeWorldMatrix;
-		mShadowMappingMaterial->SpecularColor() << specularColor;
-		mShadowMappingMaterial->SpecularPower() << mSpecularPower;
-		mShadowMappingMaterial->AmbientColor() << ambientColor;
-		mShadowMappingMaterial->LightColor() << mPointLight->ColorVector();
-		mShadowMappingMaterial->LightPosition() << mPointLight->PositionVector();
-		mShadowMappingMaterial->LightRadius() << mPointLight->Radius();
+		ShadowMappingMaterialConstants& shadowMappingConstants = mShadowMappingMaterial->Constants().Data();
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.WorldViewProjection, planeWVP);
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.World, planeWorldMatrix);
+		XMStoreFloat4(&shadowMappingConstants.SpecularColor, specularColor);
+		shadowMappingConstants.SpecularPower = mSpecularPower;
 
 
 		//floor
 		mShadowMappingMaterial->ColorTexture() << mFloorTexture;
-		mShadowMappingMaterial->CameraPosition() << mCamera->PositionVector();
-		mShadowMappingMaterial->ProjectiveTextureMatrix() << projectiveTextureMatrix;
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.ProjectiveTextureMatrix, projectiveTextureMatrix);
 		mShadowMappingMaterial->ShadowMap() << mDepthMap->OutputTexture();
-		mShadowMappingMaterial->ShadowMapSize() << shadowMapSize;
+		mShadowMappingMaterial->Constants().Commit();
 
 		pass->Apply(0, direct3DDeviceContext);
 
@@ -281,30 +379,33 @@ namespace Rendering
 		mGame->UnbindPixelShaderResources(0, 3);
 
 		// Draw model
+		pass = &mShadowMappingEffect->GetPass(mShadowMappingPermutations[modelPermutation]);
+		inputLayout = mShadowMappingMaterial->InputLayout(*pass);
+		direct3DDeviceContext->IASetInputLayout(inputLayout);
+
+		stride = (mUseCompactVertices ? mShadowMappingMaterial->CompactVertexSize() : mShadowMappingMaterial->VertexSize());
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mModelPositionUVNormalVertexBuffer, &stride, &offset);
-		direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+		direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, mModelIndexFormat, 0);
 
 		XMMATRIX modelWVP = modelWorldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
 		projectiveTextureMatrix = modelWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix() * XMLoadFloat4x4(&mProjectedTextureScalingMatrix);
 
-		mShadowMappingMaterial->WorldViewProjection() << modelWVP;
-		mShadowMappingMaterial->World() << modelWorldMatrix;
-		mShadowMappingMaterial->SpecularColor() << specularColor;
-		mShadowMappingMaterial->SpecularPower() << mSpecularPower;
-		mShadowMappingMaterial->AmbientColor() << ambientColor;
-		mShadowMappingMaterial->LightColor() << mPointLight->ColorVector();
-		mShadowMappingMaterial->LightPosition() << mPointLight->PositionVector();
-		mShadowMappingMaterial->LightRadius() << mPointLight->Radius();
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.WorldViewProjection, modelWVP);
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.World, modelWorldMatrix);
 		//house
 		mShadowMappingMaterial->ColorTexture() << mCheckerboardTexture;
-		mShadowMappingMaterial->CameraPosition() << mCamera->PositionVector();
-		mShadowMappingMaterial->ProjectiveTextureMatrix() << projectiveTextureMatrix;
+		MaterialConstantBlock::StoreMatrix(shadowMappingConstants.ProjectiveTextureMatrix, projectiveTextureMatrix);
 		mShadowMappingMaterial->ShadowMap() << mDepthMap->OutputTexture();
-		mShadowMappingMaterial->ShadowMapSize() << shadowMapSize;
+		XMStoreFloat3(&shadowMappingConstants.PositionScale, modelPositionScale);
+		XMStoreFloat3(&shadowMappingConstants.PositionOffset, modelPositionOffset);
+		mShadowMappingMaterial->Constants().Commit();
 
 		pass->Apply(0, direct3DDeviceContext);
 
-		direct3DDeviceContext->DrawIndexed(mModelIndexCount, 0, 0); //draw the main object
+		for (const ModelSubmesh& submesh : mModelSubmeshes)
+		{
+			direct3DDeviceContext->DrawIndexed(submesh.IndexCount, submesh.StartIndex, submesh.BaseVertex); //draw the main object
+		}
 		mGame->UnbindPixelShaderResources(0, 3);
 
 		mProxyModel->Draw(gameTime);
@@ -349,8 +450,7 @@ namespace Rendering
 				mActiveTechnique = (ShadowMappingTechnique)(0);
 			}
 
-			mShadowMappingMaterial->SetCurrentTechnique(*mShadowMappingMaterial->GetEffect()->TechniquesByName().at(ShadowMappingTechniqueNames[mActiveTechnique]));
-			mDepthMapMaterial->SetCurrentTechnique(*mDepthMapMaterial->GetEffect()->TechniquesByName().at(DepthMappingTechniqueNames[mActiveTechnique]));
+			mShadowMappingMaterial->SetCurrentTechnique(mShadowMappingEffect->GetPass(mShadowMappingPermutations[ShadowMappingTechniquePermutations[mActiveTechnique]]).GetTechnique());
 		}
 	}
 
@@ -361,6 +461,7 @@ namespace Rendering
 			if (mKeyboard->IsKeyDown(DIK_O))
 			{
 				mSlopeScaledDepthBias += (float)gameTime.ElapsedGameTime();
+				mSlopeScaledDepthBias = XMMin(mSlopeScaledDepthBias, MaxSlopeScaledDepthBias);
 				UpdateDepthBiasState();
 			}
 
@@ -374,6 +475,7 @@ namespace Rendering
 			if (mKeyboard->IsKeyDown(DIK_J))
 			{
 				mDepthBias += DepthBiasModulationRate * (float)gameTime.ElapsedGameTime();
+				mDepthBias = XMMin(mDepthBias, MaxDepthBias);
 				UpdateDepthBiasState();
 			}
 
@@ -386,22 +488,41 @@ namespace Rendering
 		}
 	}
 
+	// The biases go into the state in steps, and up to a limit, so holding a bias key walks a bounded
+	// set of descriptions: a step already taken, here or by another scene, is a cache hit, and the
+	// frames between steps keep the current state. The states left behind stay cached until the
+	// cache is trimmed.
 	void ShadowMappingBase::UpdateDepthBiasState()
 	{
-		ReleaseObject(mDepthBiasState);
+		StateObjectCache* stateObjectCache = (StateObjectCache*)mGame->Services().GetService(StateObjectCache::TypeIdClass());
+		assert(stateObjectCache != nullptr);
 
 		D3D11_RASTERIZER_DESC rasterizerStateDesc;
 		ZeroMemory(&rasterizerStateDesc, sizeof(rasterizerStateDesc));
 		rasterizerStateDesc.FillMode = D3D11_FILL_SOLID;
 		rasterizerStateDesc.CullMode = D3D11_CULL_BACK;
 		rasterizerStateDesc.DepthClipEnable = true;
-		rasterizerStateDesc.DepthBias = (int)mDepthBias;
-		rasterizerStateDesc.SlopeScaledDepthBias = mSlopeScaledDepthBias;
+		rasterizerStateDesc.DepthBias = (int)(floorf(mDepthBias / DepthBiasStep + 0.5f) * DepthBiasStep);
+		rasterizerStateDesc.SlopeScaledDepthBias = floorf(mSlopeScaledDepthBias / SlopeScaledDepthBiasStep + 0.5f) * SlopeScaledDepthBiasStep;
+
+		if (mDepthBiasState != nullptr)
+		{
+			D3D11_RASTERIZER_DESC currentStateDesc;
+			mDepthBiasState->GetDesc(&currentStateDesc);
+			if (currentStateDesc.DepthBias == rasterizerStateDesc.DepthBias && currentStateDesc.SlopeScaledDepthBias == rasterizerStateDesc.SlopeScaledDepthBias)
+			{
+				return;
+			}
+		}
+
+		ReleaseObject(mDepthBiasState);
+		mDepthBiasState = stateObjectCache->GetRasterizerState(rasterizerStateDesc);
 
-		HRESULT hr = mGame->Direct3DDevice()->CreateRasterizerState(&rasterizerStateDesc, &mDepthBiasState);
-		if (FAILED(hr))
+		// The steps left behind stay cached for a while, so going back over them is a hit; every so
+		// many steps the cache drops the ones nothing holds any more
+		if (++mDepthBiasStepCount % DepthBiasTrimInterval == 0)
 		{
-			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
+			stateObjectCache->Trim();
 		}
 	}
 
@@ -606,6 +727,36 @@ namespace Rendering
 		return mPointLight;
 	}
 
+	bool ShadowMappingBase::UseCompactVertices() const
+	{
+		return mUseCompactVertices;
+	}
+
+	void ShadowMappingBase::SetUseCompactVertices(bool useCompactVertices)
+	{
+		mUseCompactVertices = useCompactVertices;
+	}
+
+	// Both effects generate their techniques from the lists in ShadowMappingPermutations.fxh; the same
+	// lists build the bitmask tables here, so that Draw() and UpdateTechnique() only index them.
+	void ShadowMappingBase::InitializePassHandles()
+	{
+		mShadowMappingPermutations.Initialize(*mShadowMappingEffect, ShadowMappingPermutationList, ARRAYSIZE(ShadowMappingPermutationList), SHADOW_MAPPING_PERMUTATION_COUNT);
+		mDepthMapPermutations.Initialize(*mDepthMapEffect, DepthMapPermutationList, ARRAYSIZE(DepthMapPermutationList), DEPTH_MAP_PERMUTATION_FLAGS + 1);
+
+		for (UINT i = 0; i < ShadowMappingTechniqueEnd; i++)
+		{
+			for (UINT layout = 0; layout <= SHADOW_MAPPING_COMPACT; layout += SHADOW_MAPPING_COMPACT)
+			{
+				UINT permutation = ShadowMappingTechniquePermutations[i] | layout;
+				if (mShadowMappingPermutations.Contains(permutation) == false || mDepthMapPermutations.Contains(permutation & DEPTH_MAP_PERMUTATION_FLAGS) == false)
+				{
+					throw GameException("ShadowMappingPermutations.fxh is missing a permutation ShadowMappingBase selects.");
+				}
+			}
+		}
+	}
+
 	void ShadowMappingBase::InitializeProjectedTextureScalingMatrix()
 	{
 		mProjectedTextureScalingMatrix._11 = 0.5f;
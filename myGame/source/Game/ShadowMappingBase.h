@@ -5,6 +5,9 @@
 #include "RenderStateHelper.h"
 #include "SpotLight.h"
 #include "Camera.h"
+#include "Model.h"
+#include "Pass.h"
+#include "EffectPermutations.h"
 #include <FpsComponent.h>
 
 using namespace Library;
@@ -20,6 +23,8 @@ namespace Library
 	class ShadowMappingMaterial;
 	class DepthMapMaterial;
 	class DepthMap;
+	class Material;
+	class FrameConstants;
 }
 
 namespace DirectX
@@ -38,9 +43,7 @@ namespace Rendering
 		ShadowMappingTechniqueEnd
 	};
 
-	const std::string ShadowMappingTechniqueNames[] = { "shadow_mapping", "shadow_mapping_manual_pcf", "shadow_mapping_pcf" };
 	const std::string ShadowMappingDisplayNames[] = { "Shadow Mapping Simple", "Shadow Mapping w/ Manual PCF", "Shadow Mapping w/ PCF" };
-	const std::string DepthMappingTechniqueNames[] = { "create_depthmap", "create_depthmap", "create_depthmap_w_bias", };
 
 	class ShadowMappingBase : public DrawableGameComponent
 	{
@@ -50,6 +53,7 @@ namespace Rendering
 		ShadowMappingBase(Game& game, Camera& camera);
 		~ShadowMappingBase();
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
 		virtual void Draw(const GameTime& gameTime) override;
@@ -60,6 +64,10 @@ namespace Rendering
 		Light* GetLight();
 		void IncludeObjects(Library::GameState gameState);
 
+		// Draw the environment model from quantized vertices and 16-bit indices; set before Initialize
+		bool UseCompactVertices() const;
+		void SetUseCompactVertices(bool useCompactVertices);
+
 
 	protected:
 		ShadowMappingBase();
@@ -73,6 +81,8 @@ namespace Rendering
 		void UpdatePointLightAndProjector(const GameTime& gameTime);
 		void UpdateSpecularLight(const GameTime& gameTime);
 		void InitializeProjectedTextureScalingMatrix();
+		void RequestSceneAssets(AssetLoader& assetLoader);
+		void InitializePassHandles();
 
 		static const float LightModulationRate;
 		static const float LightMovementRate;
@@ -81,6 +91,11 @@ namespace Rendering
 		static const UINT DepthMapHeight;
 		static const RECT DepthMapDestinationRectangle;
 		static const float DepthBiasModulationRate;
+		static const float DepthBiasStep;
+		static const float MaxDepthBias;
+		static const float SlopeScaledDepthBiasStep;
+		static const float MaxSlopeScaledDepthBias;
+		static const UINT DepthBiasTrimInterval;
 
 		Keyboard* mKeyboard;
 		Mouse* mMouse;
@@ -106,25 +121,34 @@ namespace Rendering
 
 
 
-		Effect* mShadowMappingEffect;
+		std::shared_ptr<Effect> mShadowMappingEffect;
 		ShadowMappingMaterial* mShadowMappingMaterial;
 		ID3D11Buffer* mModelPositionVertexBuffer;
 		ID3D11Buffer* mModelPositionUVNormalVertexBuffer;
 		ID3D11Buffer* mModelIndexBuffer;
-		UINT mModelIndexCount;
+		std::vector<ModelSubmesh> mModelSubmeshes;
+		DXGI_FORMAT mModelIndexFormat;
+		bool mUseCompactVertices;
+		XMFLOAT3 mModelPositionScale;
+		XMFLOAT3 mModelPositionOffset;
 		XMFLOAT4X4 mModelWorldMatrix;
 		XMFLOAT4X4 mProjectedTextureScalingMatrix;
 		
-		Effect* mDepthMapEffect;
+		FrameConstants* mFrameConstants;
+		std::shared_ptr<Effect> mDepthMapEffect;
 		DepthMapMaterial* mDepthMapMaterial;
 		DepthMap* mDepthMap;
 		bool mDrawDepthMap;
 		SpriteBatch* mSpriteBatch;
 		SpriteFont* mSpriteFont;
 		ShadowMappingTechnique mActiveTechnique;
+		// Indexed by SHADOW_MAPPING_* bitmask (see ShadowMappingPermutations.fxh)
+		EffectPermutations mShadowMappingPermutations;
+		EffectPermutations mDepthMapPermutations;
 		XMFLOAT2 mTextPosition;
 		ID3D11RasterizerState* mDepthBiasState;
 		float mDepthBias;
 		float mSlopeScaledDepthBias;
+		UINT mDepthBiasStepCount;
 	};
 }
@@ -35,6 +35,7 @@ namespace Rendering
 		RTTI_DECLARATIONS(ShadowMappingCredits, DrawableGameComponent)
 
 	public:
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		ShadowMappingCredits(Library::Game& game, Library::Camera& camera);
 	};
@@ -7,7 +7,12 @@
 #include "Camera.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "ModelCache.h"
+#include "AssetLoader.h"
 #include "Utility.h"
+#include "TextureCache.h"
+#include "EffectRegistry.h"
+#include "FrameConstants.h"
 #include "PointLight.h"
 #include "Keyboard.h"
 #include "Mouse.h"
@@ -18,6 +23,7 @@
 #include "ShadowMappingMaterial.h"
 #include "DepthMapMaterial.h"
 #include "DepthMap.h"
+#include "SpriteFontLoader.h"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include <sstream>
@@ -30,22 +36,33 @@ namespace Rendering
 
 
 
+	void ShadowMappingEnd::RequestAssets(AssetLoader& assetLoader)
+	{
+		RequestSceneAssets(assetLoader);
+		assetLoader.RequestTexture(L"content\\Textures\\end.png");
+	}
+
 		void ShadowMappingEnd::Initialize()
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
 		// Initialize materials
-		mShadowMappingEffect = new Effect(*mGame);
-		mShadowMappingEffect->LoadCompiledEffect(L"Content\\Effects\\ShadowMapping.cso");
+		EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+		assert(effectRegistry != nullptr);
+
+		mShadowMappingEffect = effectRegistry->GetEffect(L"Content\\Effects\\ShadowMapping.cso");
 
 		mShadowMappingMaterial = new ShadowMappingMaterial();
 		mShadowMappingMaterial->Initialize(*mShadowMappingEffect);
 
-		mDepthMapEffect = new Effect(*mGame);
-		mDepthMapEffect->LoadCompiledEffect(L"Content\\Effects\\DepthMap.cso");
+		mDepthMapEffect = effectRegistry->GetEffect(L"Content\\Effects\\DepthMap.cso");
 
 		mDepthMapMaterial = new DepthMapMaterial();
 		mDepthMapMaterial->Initialize(*mDepthMapEffect);
+		InitializePassHandles();
+
+		mFrameConstants = (FrameConstants*)mGame->Services().GetService(FrameConstants::TypeIdClass());
+		assert(mFrameConstants != nullptr);
 
 		// Plane vertex buffers
 		VertexPositionTextureNormal positionUVNormalVertices[] =
@@ -85,12 +102,11 @@ namespace Rendering
 
 			//create the floor texture
 
+		TextureCache* textureCache = (TextureCache*)mGame->Services().GetService(TextureCache::TypeIdClass());
+		assert(textureCache != nullptr);
+
 		std::wstring textureName = L"content\\Textures\\end.png";
-		HRESULT hr = DirectX::CreateWICTextureFromFile(mGame->Direct3DDevice(), mGame->Direct3DDeviceContext(), textureName.c_str(), nullptr, &mFloorTexture);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateWICTextureFromFile() failed.", hr);
-		}
+		mFloorTexture = textureCache->GetTexture(textureName);
 
 
 		mPointLight = new PointLight(*mGame);
@@ -120,8 +136,6 @@ namespace Rendering
 		InitializeProjectedTextureScalingMatrix();
 
 		// Vertex and index buffers for a second model to render
-		std::unique_ptr<Model> model(new Model(*mGame, "content\\Models\\environment.fbx", true));
-
 		/*Mesh* mesh = model->Meshes().at(0);
 		mDepthMapMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mModelPositionVertexBuffer);
 		mShadowMappingMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mModelPositionUVNormalVertexBuffer);
@@ -135,7 +149,7 @@ namespace Rendering
 
 		mDepthMap = new DepthMap(*mGame, DepthMapWidth, DepthMapHeight);
 		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
-		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"content\\Fonts\\Arial_14_Regular.spritefont");
+		mSpriteFont = SpriteFontLoader::CreateSpriteFont(mGame->Direct3DDevice(), L"content\\Fonts\\Arial_14_Regular.spritefont");
 
 		UpdateDepthBiasState();
 	}
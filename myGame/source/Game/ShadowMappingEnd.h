@@ -35,6 +35,7 @@ namespace Rendering
 		RTTI_DECLARATIONS(ShadowMappingEnd, DrawableGameComponent)
 
 	public:
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		ShadowMappingEnd(Library::Game& game, Library::Camera& camera);
 	};
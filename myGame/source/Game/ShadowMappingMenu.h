@@ -35,6 +35,7 @@ namespace Rendering
 		RTTI_DECLARATIONS(ShadowMappingMenu, DrawableGameComponent)
 
 	public:
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		ShadowMappingMenu(Library::Game& game, Library::Camera& camera);
 	};
@@ -0,0 +1,227 @@
+#include "ArchiveFileSystem.h"
+#include "DirectoryFileSystem.h"
+#include "GameException.h"
+#include <fstream>
+#include <algorithm>
+
+namespace Library
+{
+    const UINT ArchiveFileSystem::Magic = 0x4B415050; // "PPAK"
+    const UINT ArchiveFileSystem::Version = 2;
+    const UINT ArchiveFileSystem::Alignment = 64;
+    const std::wstring ArchiveFileSystem::Extension = L".pak";
+
+    ArchiveFileSystem::ArchiveFileSystem(const std::wstring& filename)
+        : mArchive(), mHeader(nullptr), mEntries(nullptr)
+    {
+        if (DirectoryFileSystem::MapFile(filename, mArchive) == false)
+        {
+            throw GameException("Could not open content archive.", HRESULT_FROM_WIN32(GetLastError()));
+        }
+
+        if (mArchive.Size() < sizeof(ContentArchiveHeader))
+        {
+            throw GameException("Content archive has an invalid size.");
+        }
+
+        mHeader = reinterpret_cast<const ContentArchiveHeader*>(mArchive.Data());
+        if (mHeader->Magic != Magic || mHeader->Version != Version || mHeader->FileSize != mArchive.Size())
+        {
+            throw GameException("Content archive header is invalid or out of date.");
+        }
+
+        UINT64 tableEnd = static_cast<UINT64>(mHeader->EntryOffset) + sizeof(ContentArchiveEntry) * static_cast<UINT64>(mHeader->EntryCount);
+        if (tableEnd > mHeader->FileSize)
+        {
+            throw GameException("Content archive table of contents is out of range.");
+        }
+
+        mEntries = reinterpret_cast<const ContentArchiveEntry*>(mArchive.Data() + mHeader->EntryOffset);
+        for (UINT i = 0; i < mHeader->EntryCount; i++)
+        {
+            if (mEntries[i].Offset + mEntries[i].Size > mHeader->FileSize || static_cast<UINT64>(mEntries[i].PathOffset) + mEntries[i].PathLength > mHeader->FileSize)
+            {
+                throw GameException("Content archive entry is out of range.");
+            }
+        }
+    }
+
+    void ArchiveFileSystem::Pack(const std::wstring& sourceDirectory, const std::wstring& filename)
+    {
+        std::vector<std::pair<std::string, std::wstring>> files;
+        FindFiles(sourceDirectory, "", files);
+
+        std::vector<ContentArchiveEntry> entries(files.size());
+        std::vector<FileData> contents(files.size());
+        for (UINT i = 0; i < files.size(); i++)
+        {
+            if (DirectoryFileSystem::MapFile(files[i].second, contents[i]) == false)
+            {
+                throw GameException("Could not open a file to pack.", HRESULT_FROM_WIN32(GetLastError()));
+            }
+
+            entries[i].PathHash = VirtualFileSystem::HashPath(files[i].first);
+            entries[i].Size = contents[i].Size();
+        }
+
+        // Entries are laid out in hash order too, so the table and the data are walked the same way
+        std::vector<UINT> order(files.size());
+        for (UINT i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&entries](UINT lhs, UINT rhs)
+        {
+            return entries[lhs].PathHash < entries[rhs].PathHash;
+        });
+
+        for (UINT i = 1; i < order.size(); i++)
+        {
+            if (entries[order[i]].PathHash == entries[order[i - 1]].PathHash)
+            {
+                throw GameException(("Content archive path hash collision: " + files[order[i]].first).c_str());
+            }
+        }
+
+        ContentArchiveHeader header;
+        ZeroMemory(&header, sizeof(header));
+        header.Magic = Magic;
+        header.Version = Version;
+        header.EntryCount = files.size();
+        header.EntryOffset = (sizeof(ContentArchiveHeader) + Alignment - 1) & ~(Alignment - 1);
+
+        // The paths follow the table in the same order, then the data starts on the next boundary
+        std::vector<ContentArchiveEntry> table(order.size());
+        std::string paths;
+        UINT pathsOffset = header.EntryOffset + sizeof(ContentArchiveEntry) * header.EntryCount;
+        for (UINT i = 0; i < order.size(); i++)
+        {
+            table[i] = entries[order[i]];
+            table[i].PathOffset = pathsOffset + paths.size();
+            table[i].PathLength = files[order[i]].first.size();
+            paths += files[order[i]].first;
+        }
+
+        UINT64 offset = (pathsOffset + static_cast<UINT64>(paths.size()) + Alignment - 1) & ~static_cast<UINT64>(Alignment - 1);
+        for (UINT i = 0; i < order.size(); i++)
+        {
+            table[i].Offset = offset;
+            offset = (offset + table[i].Size + Alignment - 1) & ~static_cast<UINT64>(Alignment - 1);
+        }
+        header.FileSize = (table.empty() ? header.EntryOffset : table.back().Offset + table.back().Size);
+
+        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            throw GameException("Could not open content archive for writing.");
+        }
+
+        std::vector<byte> padding(Alignment, 0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&padding[0]), header.EntryOffset - sizeof(header));
+        if (table.empty() == false)
+        {
+            file.write(reinterpret_cast<const char*>(&table[0]), sizeof(ContentArchiveEntry) * table.size());
+        }
+        file.write(paths.c_str(), paths.size());
+        UINT64 written = pathsOffset + paths.size();
+
+        for (UINT i = 0; i < table.size(); i++)
+        {
+            const FileData& content = contents[order[i]];
+            file.write(reinterpret_cast<const char*>(&padding[0]), table[i].Offset - written);
+            if (content.Size() > 0)
+            {
+                file.write(reinterpret_cast<const char*>(content.Data()), content.Size());
+            }
+            written = table[i].Offset + table[i].Size;
+        }
+
+        if (file.good() == false)
+        {
+            throw GameException("Failed writing content archive.");
+        }
+    }
+
+    bool ArchiveFileSystem::Exists(const std::string& path) const
+    {
+        return (Find(path) != nullptr);
+    }
+
+    bool ArchiveFileSystem::Open(const std::string& path, FileData& file) const
+    {
+        const ContentArchiveEntry* entry = Find(path);
+        if (entry == nullptr)
+        {
+            return false;
+        }
+
+        file = FileData(mArchive, entry->Offset, entry->Size);
+
+        return true;
+    }
+
+    UINT ArchiveFileSystem::EntryCount() const
+    {
+        return mHeader->EntryCount;
+    }
+
+    void ArchiveFileSystem::FindFiles(const std::wstring& directory, const std::string& relativeDirectory, std::vector<std::pair<std::string, std::wstring>>& files)
+    {
+        WIN32_FIND_DATA findData;
+        HANDLE find = FindFirstFile((directory + L"\\*").c_str(), &findData);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        do
+        {
+            std::wstring name(findData.cFileName);
+            if (name == L"." || name == L"..")
+            {
+                continue;
+            }
+
+            std::string relativePath = relativeDirectory + std::string(name.begin(), name.end());
+            std::string normalizedPath;
+            VirtualFileSystem::NormalizePath(relativePath, normalizedPath);
+
+            if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+            {
+                FindFiles(directory + L"\\" + name, normalizedPath + "\\", files);
+            }
+            else
+            {
+                files.push_back(std::make_pair(normalizedPath, directory + L"\\" + name));
+            }
+        } while (FindNextFile(find, &findData));
+
+        FindClose(find);
+    }
+
+    const ContentArchiveEntry* ArchiveFileSystem::Find(const std::string& path) const
+    {
+        UINT64 hash = VirtualFileSystem::HashPath(path);
+
+        const ContentArchiveEntry* end = mEntries + mHeader->EntryCount;
+        const ContentArchiveEntry* entry = std::lower_bound(mEntries, end, hash, [](const ContentArchiveEntry& lhs, UINT64 rhs)
+        {
+            return lhs.PathHash < rhs;
+        });
+
+        if (entry == end || entry->PathHash != hash)
+        {
+            return nullptr;
+        }
+
+        // A different path with the same hash is a miss, not someone else's bytes
+        if (entry->PathLength != path.size() || memcmp(mArchive.Data() + entry->PathOffset, path.c_str(), path.size()) != 0)
+        {
+            return nullptr;
+        }
+
+        return entry;
+    }
+}
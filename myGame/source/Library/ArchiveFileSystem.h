@@ -0,0 +1,63 @@
+#pragma once
+
+#include "VirtualFileSystem.h"
+
+namespace Library
+{
+    typedef struct _ContentArchiveHeader
+    {
+        UINT Magic;
+        UINT Version;
+        UINT EntryCount;
+        UINT EntryOffset;
+        UINT64 FileSize;
+    } ContentArchiveHeader;
+
+    // Table of contents entry; the table is sorted by PathHash (VirtualFileSystem::HashPath of the
+    // normalized path relative to the archive root) and Offset is a multiple of Alignment. The path
+    // itself sits in the string table after the entries (PathOffset from the start of the archive,
+    // not null terminated), so a lookup never trusts the hash alone.
+    typedef struct _ContentArchiveEntry
+    {
+        UINT64 PathHash;
+        UINT64 Offset;
+        UINT64 Size;
+        UINT PathOffset;
+        UINT PathLength;
+    } ContentArchiveEntry;
+
+    // Single packed file holding a whole content directory (see ContentCooker -pack). The archive
+    // is memory-mapped once; a lookup is a binary search over the path hashes followed by a compare
+    // of the stored path, and opening a file
+    // hands out a view into the mapping, so no entry is ever copied or read with a syscall.
+    class ArchiveFileSystem : public FileSystemBackend
+    {
+    public:
+        static const UINT Magic;
+        static const UINT Version;
+        static const UINT Alignment;
+        static const std::wstring Extension;
+
+        ArchiveFileSystem(const std::wstring& filename);
+
+        static void Pack(const std::wstring& sourceDirectory, const std::wstring& filename);
+
+        virtual bool Exists(const std::string& path) const override;
+        virtual bool Open(const std::string& path, FileData& file) const override;
+
+        UINT EntryCount() const;
+
+    private:
+        ArchiveFileSystem();
+        ArchiveFileSystem(const ArchiveFileSystem& rhs);
+        ArchiveFileSystem& operator=(const ArchiveFileSystem& rhs);
+
+        static void FindFiles(const std::wstring& directory, const std::string& relativeDirectory, std::vector<std::pair<std::string, std::wstring>>& files);
+
+        const ContentArchiveEntry* Find(const std::string& path) const;
+
+        FileData mArchive;
+        const ContentArchiveHeader* mHeader;
+        const ContentArchiveEntry* mEntries;
+    };
+}
@@ -0,0 +1,61 @@
+#include "Arena.h"
+#include "GameException.h"
+
+namespace Library
+{
+    Arena::Arena()
+        : mMemory(nullptr), mCapacity(0), mSize(0), mDestructors()
+    {
+    }
+
+    Arena::~Arena()
+    {
+        Reset();
+    }
+
+    void Arena::Reserve(SIZE_T capacity)
+    {
+        assert(mSize == 0);
+
+        DeleteObjects(mMemory);
+        mMemory = (capacity > 0 ? new BYTE[capacity] : nullptr);
+        mCapacity = capacity;
+    }
+
+    void Arena::Reset()
+    {
+        for (std::vector<std::pair<void*, void(*)(void*)>>::reverse_iterator it = mDestructors.rbegin(); it != mDestructors.rend(); ++it)
+        {
+            it->second(it->first);
+        }
+        mDestructors.clear();
+
+        DeleteObjects(mMemory);
+        mCapacity = 0;
+        mSize = 0;
+    }
+
+    SIZE_T Arena::Size() const
+    {
+        return mSize;
+    }
+
+    SIZE_T Arena::Capacity() const
+    {
+        return mCapacity;
+    }
+
+    void* Arena::Allocate(SIZE_T size, SIZE_T alignment)
+    {
+        UINT_PTR address = reinterpret_cast<UINT_PTR>(mMemory) + mSize;
+        SIZE_T padding = (alignment - address % alignment) % alignment;
+        if (mMemory == nullptr || mSize + padding + size > mCapacity)
+        {
+            throw GameException("Arena capacity exceeded.");
+        }
+
+        mSize += padding + size;
+
+        return reinterpret_cast<void*>(address + padding);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    // Bump allocator for objects that are created together and destroyed together. Reserve() takes
+    // one block up front, Create() constructs each object in place after the previous one, and
+    // Reset() (or the destructor) runs the destructors in reverse order and frees the block.
+    //
+    // The arena never grows, so the objects stay at their addresses; size the block with SizeOf().
+    class Arena
+    {
+    public:
+        Arena();
+        ~Arena();
+
+        // Capacity for count objects of type T, alignment padding included
+        template <typename T>
+        static SIZE_T SizeOf(SIZE_T count)
+        {
+            return (count > 0 ? sizeof(T) * count + __alignof(T) - 1 : 0);
+        }
+
+        // Only while the arena is empty
+        void Reserve(SIZE_T capacity);
+        void Reset();
+
+        SIZE_T Size() const;
+        SIZE_T Capacity() const;
+
+        template <typename T, typename... Args>
+        T* Create(Args&&... args)
+        {
+            T* object = new (Allocate(sizeof(T), __alignof(T))) T(std::forward<Args>(args)...);
+            mDestructors.push_back(std::pair<void*, void(*)(void*)>(object, &Destroy<T>));
+
+            return object;
+        }
+
+    private:
+        Arena(const Arena& rhs);
+        Arena& operator=(const Arena& rhs);
+
+        template <typename T>
+        static void Destroy(void* object)
+        {
+            static_cast<T*>(object)->~T();
+        }
+
+        void* Allocate(SIZE_T size, SIZE_T alignment);
+
+        BYTE* mMemory;
+        SIZE_T mCapacity;
+        SIZE_T mSize;
+        std::vector<std::pair<void*, void(*)(void*)>> mDestructors;
+    };
+}
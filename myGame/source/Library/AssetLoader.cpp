@@ -0,0 +1,346 @@
+#include "AssetLoader.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Model.h"
+#include "ModelCache.h"
+#include "TextureCache.h"
+#include "EffectRegistry.h"
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "Utility.h"
+#include "LoadProfiler.h"
+#include <DDSTextureLoader.h>
+#include <WICTextureLoader.h>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(AssetLoader)
+
+    AssetLoader::AssetLoader(Game& game, UINT threadCount)
+        : mGame(game), mThreads(), mJobs(), mMutex(), mJobAvailable(), mJobsDone(), mPendingJobCount(0), mShuttingDown(false), mError(),
+          mModels(), mTextures(), mFiles()
+    {
+        if (threadCount == 0)
+        {
+            // Leave a core for the main thread, which keeps initializing components meanwhile
+            UINT hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = (hardwareThreads > 1 ? hardwareThreads - 1 : 1);
+        }
+
+        for (UINT i = 0; i < threadCount; i++)
+        {
+            mThreads.push_back(std::thread(&AssetLoader::WorkerThread, this));
+        }
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mShuttingDown = true;
+        }
+        mJobAvailable.notify_all();
+
+        for (std::thread& thread : mThreads)
+        {
+            thread.join();
+        }
+
+        Clear();
+    }
+
+    void AssetLoader::RequestModel(const std::string& filename, bool flipUVs)
+    {
+        std::string key;
+        Utility::NormalizePath(filename, key);
+        key += (flipUVs ? "|1" : "|0");
+
+        PendingModel* pendingModel;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mModels.find(key) != mModels.end())
+            {
+                return;
+            }
+
+            pendingModel = &mModels[key];
+            pendingModel->Filename = filename;
+            pendingModel->FlipUVs = flipUVs;
+        }
+
+        std::string component = LoadProfiler::CurrentComponent();
+        QueueJob([this, pendingModel, filename, flipUVs, component]()
+        {
+            LoadProfileComponent profileComponent(component);
+
+            std::shared_ptr<CookedMesh> cookedMesh;
+            std::shared_ptr<Model> model;
+
+            std::wstring cookedFilename = CookedMesh::CookedFilename(filename);
+            if (VirtualFileSystem::Exists(cookedFilename))
+            {
+                LoadProfileScope profileScope("Cooked mesh map", cookedFilename);
+                cookedMesh = std::make_shared<CookedMesh>(cookedFilename);
+            }
+            else
+            {
+                model = std::make_shared<Model>(mGame, filename, flipUVs);
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            pendingModel->MappedMesh = cookedMesh;
+            pendingModel->ImportedModel = model;
+        });
+    }
+
+    void AssetLoader::RequestTexture(const std::wstring& filename)
+    {
+        std::wstring key;
+        Utility::NormalizePath(filename, key);
+
+        PendingTexture* pendingTexture;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mTextures.find(key) != mTextures.end())
+            {
+                return;
+            }
+
+            pendingTexture = &mTextures[key];
+            pendingTexture->ShaderResourceView = nullptr;
+            pendingTexture->Component = LoadProfiler::CurrentComponent();
+        }
+
+        QueueJob([this, pendingTexture, filename]()
+        {
+            LoadProfileComponent profileComponent(pendingTexture->Component);
+            LoadProfileScope profileScope("Texture load", filename);
+
+            ID3D11ShaderResourceView* shaderResourceView = nullptr;
+            FileData file;
+            if (VirtualFileSystem::Open(CookedTexture::CookedFilename(filename), file))
+            {
+                HRESULT hr = DirectX::CreateDDSTextureFromMemory(mGame.Direct3DDevice(), file.Data(), static_cast<size_t>(file.Size()), nullptr, &shaderResourceView);
+                if (FAILED(hr))
+                {
+                    throw GameException("CreateDDSTextureFromMemory() failed.", hr);
+                }
+
+                LoadProfiler::AddBytesUploaded(TextureCache::TextureSize(shaderResourceView));
+                file.Reset();
+            }
+            else if (VirtualFileSystem::Open(filename, file))
+            {
+                // Fault the mapped pages in here so the decode on the main thread doesn't wait on the disk
+                volatile byte touched = 0;
+                for (UINT64 offset = 0; offset < file.Size(); offset += 4096)
+                {
+                    touched += file.Data()[offset];
+                }
+            }
+            else
+            {
+                throw GameException("Could not open texture.", HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            pendingTexture->ShaderResourceView = shaderResourceView;
+            pendingTexture->File = file;
+        });
+    }
+
+    void AssetLoader::RequestFile(const std::wstring& filename)
+    {
+        std::wstring key;
+        Utility::NormalizePath(filename, key);
+
+        std::vector<char>* pendingFile;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mFiles.find(key) != mFiles.end())
+            {
+                return;
+            }
+
+            pendingFile = &mFiles[key];
+        }
+
+        std::string component = LoadProfiler::CurrentComponent();
+        QueueJob([this, pendingFile, filename, component]()
+        {
+            LoadProfileComponent profileComponent(component);
+            LoadProfileScope profileScope("File read", filename);
+
+            std::vector<char> data;
+            Utility::LoadBinaryFile(filename, data);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            pendingFile->swap(data);
+        });
+    }
+
+    void AssetLoader::RequestEffect(const std::wstring& filename)
+    {
+        EffectRegistry* effectRegistry = (EffectRegistry*)mGame.Services().GetService(EffectRegistry::TypeIdClass());
+        if (effectRegistry == nullptr)
+        {
+            RequestFile(filename);
+            return;
+        }
+
+        effectRegistry->LoadEffectAsync(filename);
+    }
+
+    void AssetLoader::Wait()
+    {
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobsDone.wait(lock, [this]() { return mPendingJobCount == 0; });
+
+            error = mError;
+            mError = nullptr;
+        }
+
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+
+        ModelCache* modelCache = (ModelCache*)mGame.Services().GetService(ModelCache::TypeIdClass());
+        assert(modelCache != nullptr);
+
+        for (std::pair<const std::string, PendingModel>& model : mModels)
+        {
+            modelCache->AddCookedMesh(model.second.Filename, model.second.MappedMesh);
+            if (model.second.ImportedModel != nullptr)
+            {
+                modelCache->AddModel(model.second.Filename, model.second.FlipUVs, model.second.ImportedModel);
+            }
+        }
+        mModels.clear();
+
+        TextureCache* textureCache = (TextureCache*)mGame.Services().GetService(TextureCache::TypeIdClass());
+        assert(textureCache != nullptr);
+
+        for (std::pair<const std::wstring, PendingTexture>& texture : mTextures)
+        {
+            PendingTexture& pendingTexture = texture.second;
+            if (pendingTexture.ShaderResourceView == nullptr && pendingTexture.File.IsValid())
+            {
+                LoadProfileComponent profileComponent(pendingTexture.Component);
+                LoadProfileScope profileScope("Texture decode", texture.first);
+
+                HRESULT hr = DirectX::CreateWICTextureFromMemory(mGame.Direct3DDevice(), mGame.Direct3DDeviceContext(), pendingTexture.File.Data(), static_cast<size_t>(pendingTexture.File.Size()), nullptr, &pendingTexture.ShaderResourceView);
+                if (FAILED(hr))
+                {
+                    throw GameException("CreateWICTextureFromMemory() failed.", hr);
+                }
+
+                LoadProfiler::AddBytesUploaded(TextureCache::TextureSize(pendingTexture.ShaderResourceView));
+                pendingTexture.File.Reset();
+            }
+
+            if (pendingTexture.ShaderResourceView != nullptr)
+            {
+                textureCache->AddTexture(texture.first, TextureLoadOptionsDefault, pendingTexture.ShaderResourceView);
+                ReleaseObject(pendingTexture.ShaderResourceView);
+            }
+        }
+        mTextures.clear();
+
+        EffectRegistry* effectRegistry = (EffectRegistry*)mGame.Services().GetService(EffectRegistry::TypeIdClass());
+        if (effectRegistry != nullptr)
+        {
+            effectRegistry->Wait();
+        }
+    }
+
+    void AssetLoader::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (std::pair<const std::wstring, PendingTexture>& texture : mTextures)
+        {
+            ReleaseObject(texture.second.ShaderResourceView);
+        }
+
+        mModels.clear();
+        mTextures.clear();
+        mFiles.clear();
+    }
+
+    bool AssetLoader::GetFile(const std::wstring& filename, std::vector<char>& data)
+    {
+        std::wstring key;
+        Utility::NormalizePath(filename, key);
+
+        std::map<std::wstring, std::vector<char>>::iterator it = mFiles.find(key);
+        if (it == mFiles.end() || it->second.size() == 0)
+        {
+            return false;
+        }
+
+        data = it->second;
+
+        return true;
+    }
+
+    UINT AssetLoader::ThreadCount() const
+    {
+        return mThreads.size();
+    }
+
+    void AssetLoader::QueueJob(const std::function<void()>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.push_back(job);
+            mPendingJobCount++;
+        }
+
+        mJobAvailable.notify_one();
+    }
+
+    void AssetLoader::WorkerThread()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mJobAvailable.wait(lock, [this]() { return mShuttingDown || mJobs.empty() == false; });
+                if (mJobs.empty())
+                {
+                    return;
+                }
+
+                job = mJobs.front();
+                mJobs.pop_front();
+            }
+
+            try
+            {
+                job();
+            }
+            catch (...)
+            {
+                // Surfaced on the main thread by Wait(); the first failure wins
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mError == nullptr)
+                {
+                    mError = std::current_exception();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPendingJobCount--;
+                if (mPendingJobCount == 0)
+                {
+                    mJobsDone.notify_all();
+                }
+            }
+        }
+    }
+}
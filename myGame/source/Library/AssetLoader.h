@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common.h"
+#include "VirtualFileSystem.h"
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Library
+{
+    class Game;
+    class Model;
+    class CookedMesh;
+
+    // Worker pool that preloads the assets components declare in GameComponent::RequestAssets.
+    // Model imports, cooked mesh mapping, compiled effect reads and DDS texture creation (the
+    // device is free-threaded) run on the workers; Wait() joins them on the main thread, creates
+    // any remaining WIC textures from the preloaded bytes, since their mip generation needs the
+    // immediate context, and hands the models to ModelCache and the textures to TextureCache.
+    // Requested effects are read and parsed by EffectRegistry::LoadEffectAsync meanwhile, and
+    // Wait() also waits for those.
+    //
+    // Preloaded files are served until Clear() is called after initialization.
+    class AssetLoader : public RTTI
+    {
+        RTTI_DECLARATIONS(AssetLoader, RTTI)
+
+    public:
+        AssetLoader(Game& game, UINT threadCount = 0);
+        ~AssetLoader();
+
+        void RequestModel(const std::string& filename, bool flipUVs = false);
+        void RequestTexture(const std::wstring& filename);
+        void RequestFile(const std::wstring& filename);
+        void RequestEffect(const std::wstring& filename);
+
+        void Wait();
+        void Clear();
+
+        bool GetFile(const std::wstring& filename, std::vector<char>& data);
+
+        UINT ThreadCount() const;
+
+    private:
+        AssetLoader();
+        AssetLoader(const AssetLoader& rhs);
+        AssetLoader& operator=(const AssetLoader& rhs);
+
+        struct PendingModel
+        {
+            std::string Filename;
+            bool FlipUVs;
+            std::shared_ptr<Model> ImportedModel;
+            std::shared_ptr<CookedMesh> MappedMesh;
+        };
+
+        struct PendingTexture
+        {
+            ID3D11ShaderResourceView* ShaderResourceView;
+            FileData File;
+            std::string Component;
+        };
+
+        void QueueJob(const std::function<void()>& job);
+        void WorkerThread();
+
+        Game& mGame;
+        std::vector<std::thread> mThreads;
+        std::deque<std::function<void()>> mJobs;
+        std::mutex mMutex;
+        std::condition_variable mJobAvailable;
+        std::condition_variable mJobsDone;
+        UINT mPendingJobCount;
+        bool mShuttingDown;
+        std::exception_ptr mError;
+
+        std::map<std::string, PendingModel> mModels;
+        std::map<std::wstring, PendingTexture> mTextures;
+        std::map<std::wstring, std::vector<char>> mFiles;
+    };
+}
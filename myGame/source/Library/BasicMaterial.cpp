@@ -32,19 +32,19 @@ namespace Library
 
     void BasicMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
     {
-        const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+        const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
 
         std::vector<VertexPositionColor> vertices;
         vertices.reserve(sourceVertices.size());
         if (mesh.VertexColors().size() > 0)
         {
-            std::vector<XMFLOAT4>* vertexColors = mesh.VertexColors().at(0);
-            assert(vertexColors->size() == sourceVertices.size());
+            const Span<XMFLOAT4>& vertexColors = mesh.VertexColors().at(0);
+            assert(vertexColors.size() == sourceVertices.size());
             
             for (UINT i = 0; i < sourceVertices.size(); i++)
             {
                 XMFLOAT3 position = sourceVertices.at(i);
-                XMFLOAT4 color = vertexColors->at(i);
+                XMFLOAT4 color = vertexColors.at(i);
                 vertices.push_back(VertexPositionColor(XMFLOAT4(position.x, position.y, position.z, 1.0f), color));
             }
         }
@@ -1,14 +1,12 @@
 #include "BlendStates.h"
-#include "GameException.h"
+#include "StateObjectCache.h"
 
 namespace Library
 {
 	ID3D11BlendState* BlendStates::MultiplicativeBlending = nullptr;
 
-	void BlendStates::Initialize(ID3D11Device* direct3DDevice)
+	void BlendStates::Initialize(StateObjectCache& stateObjectCache)
 	{
-		assert(direct3DDevice != nullptr);
-
 		D3D11_BLEND_DESC blendStateDesc;
 		ZeroMemory(&blendStateDesc, sizeof(blendStateDesc));
 		blendStateDesc.RenderTarget[0].BlendEnable = true;
@@ -20,11 +18,7 @@ namespace Library
 		blendStateDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 		blendStateDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
 
-		HRESULT hr = direct3DDevice->CreateBlendState(&blendStateDesc, &MultiplicativeBlending);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateBlendState() failed.", hr);
-		}
+		MultiplicativeBlending = stateObjectCache.GetBlendState(blendStateDesc);
 	}
 
 	void BlendStates::Release()
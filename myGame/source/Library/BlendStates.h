@@ -4,12 +4,14 @@
 
 namespace Library
 {
+	class StateObjectCache;
+
 	class BlendStates
 	{
 	public:
 		static ID3D11BlendState* MultiplicativeBlending;		
 
-		static void Initialize(ID3D11Device* direct3DDevice);
+		static void Initialize(StateObjectCache& stateObjectCache);
 		static void Release();
 
 	private:
@@ -11,6 +11,8 @@
 #include "Utility.h"
 #include "ColorHelper.h"
 #include "GaussianBlur.h"
+#include "EffectRegistry.h"
+#include "AssetLoader.h"
 
 namespace Library
 {
@@ -22,14 +24,14 @@ namespace Library
     Bloom::Bloom(Game& game, Camera& camera)
         : DrawableGameComponent(game, camera),
           mBloomEffect(nullptr), mBloomMaterial(nullptr), mSceneTexture(nullptr), mRenderTarget(nullptr),
-		  mFullScreenQuad(nullptr), mGaussianBlur(nullptr), mBloomSettings(DefaultBloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
+		  mFullScreenQuad(nullptr), mExtractPass(0), mCompositePass(0), mNoBloomPass(0), mGaussianBlur(nullptr), mBloomSettings(DefaultBloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
     {
     }
 
     Bloom::Bloom(Game& game, Camera& camera, const BloomSettings& bloomSettings)
         : DrawableGameComponent(game, camera),
           mBloomEffect(nullptr), mBloomMaterial(nullptr), mSceneTexture(nullptr), mRenderTarget(nullptr),
-		  mFullScreenQuad(nullptr), mGaussianBlur(nullptr),  mBloomSettings(bloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
+		  mFullScreenQuad(nullptr), mExtractPass(0), mCompositePass(0), mNoBloomPass(0), mGaussianBlur(nullptr),  mBloomSettings(bloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
     {
     }
 
@@ -39,7 +41,6 @@ namespace Library
         DeleteObject(mFullScreenQuad);
         DeleteObject(mRenderTarget);
 		DeleteObject(mBloomMaterial);
-		DeleteObject(mBloomEffect);
     }
 
     ID3D11ShaderResourceView* Bloom::SceneTexture()
@@ -63,19 +64,34 @@ namespace Library
 		mGaussianBlur->SetBlurAmount(mBloomSettings.BlurAmount);
     }
 
+    void Bloom::RequestAssets(AssetLoader& assetLoader)
+    {
+        // The blur is created in Initialize(), too late to request its own effect
+        assetLoader.RequestEffect(L"Content\\Effects\\Bloom.cso");
+        assetLoader.RequestEffect(L"Content\\Effects\\GaussianBlur.cso");
+    }
+
     void Bloom::Initialize()
     {
         SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-        mBloomEffect = new Effect(*mGame);
-        mBloomEffect->LoadCompiledEffect(L"Content\\Effects\\Bloom.cso");
+        EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+        assert(effectRegistry != nullptr);
+
+        mBloomEffect = effectRegistry->CloneEffect(L"Content\\Effects\\Bloom.cso");
 
         mBloomMaterial = new BloomMaterial();
         mBloomMaterial->Initialize(*mBloomEffect);
+        mExtractPass = mBloomEffect->FindPass("bloom_extract", "p0");
+        mCompositePass = mBloomEffect->FindPass("bloom_composite", "p0");
+        mNoBloomPass = mBloomEffect->FindPass("no_bloom", "p0");
 
         mFullScreenQuad = new FullScreenQuad(*mGame, *mBloomMaterial);		
         mFullScreenQuad->Initialize();
 
+        // The clone is ours alone and every lookup on it is done, so its reflection data can go
+        mBloomEffect->Optimize();
+
         mRenderTarget = new FullScreenRenderTarget(*mGame);
 
 		mGaussianBlur = new GaussianBlur(*mGame, *mCamera, mBloomSettings.BlurAmount);
@@ -101,7 +117,7 @@ namespace Library
 			mRenderTarget->Begin();
             mGame->Direct3DDeviceContext()->ClearRenderTargetView(mRenderTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
             mGame->Direct3DDeviceContext()->ClearDepthStencilView(mRenderTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-			mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
+			mFullScreenQuad->SetMaterial(*mBloomMaterial, mExtractPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
             mFullScreenQuad->Draw(gameTime);
 			mRenderTarget->End();
@@ -112,14 +128,14 @@ namespace Library
 			mGame->UnbindPixelShaderResources(0, 1);
 			
 			// Combine the original scene with the blurred bright spot image
-			mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_composite", "p0");
+			mFullScreenQuad->SetMaterial(*mBloomMaterial, mCompositePass);
 			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomCompositeMaterial, this));
 			mFullScreenQuad->Draw(gameTime);
 			mGame->UnbindPixelShaderResources(0, 2);
         }
         else
         {
-			mFullScreenQuad->SetMaterial(*mBloomMaterial, "no_bloom", "p0");
+			mFullScreenQuad->SetMaterial(*mBloomMaterial, mNoBloomPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateNoBloomMaterial, this));
             mFullScreenQuad->Draw(gameTime);
         }
@@ -127,7 +143,7 @@ namespace Library
 
 	void Bloom::DrawExtractedTexture(const GameTime& gameTime)
 	{
-		mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
+		mFullScreenQuad->SetMaterial(*mBloomMaterial, mExtractPass);
         mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
         mFullScreenQuad->Draw(gameTime);
 	}
@@ -138,7 +154,7 @@ namespace Library
 		mRenderTarget->Begin();
         mGame->Direct3DDeviceContext()->ClearRenderTargetView(mRenderTarget->RenderTargetView() , reinterpret_cast<const float*>(&ColorHelper::Purple));
         mGame->Direct3DDeviceContext()->ClearDepthStencilView(mRenderTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-		mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
+		mFullScreenQuad->SetMaterial(*mBloomMaterial, mExtractPass);
         mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
         mFullScreenQuad->Draw(gameTime);			
 		mRenderTarget->End();
@@ -3,6 +3,7 @@
 #include <functional>
 #include "Common.h"
 #include "DrawableGameComponent.h"
+#include "Pass.h"
 
 namespace Library
 {
@@ -49,6 +50,7 @@ namespace Library
 		std::string DrawModeString() const;
 		void SetDrawMode(BloomDrawMode drawMode);
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		virtual void Draw(const GameTime& gameTime) override;
 
@@ -68,11 +70,14 @@ namespace Library
 		static const std::string DrawModeDisplayNames[];
 		static const BloomSettings DefaultBloomSettings;		
 
-		Effect* mBloomEffect;
+		std::shared_ptr<Effect> mBloomEffect;
 		BloomMaterial* mBloomMaterial;
 		ID3D11ShaderResourceView* mSceneTexture;
 		FullScreenRenderTarget* mRenderTarget;
 		FullScreenQuad* mFullScreenQuad;
+		PassHandle mExtractPass;
+		PassHandle mCompositePass;
+		PassHandle mNoBloomPass;
 		GaussianBlur* mGaussianBlur;
 		BloomSettings mBloomSettings;
 		BloomDrawMode mDrawMode;
@@ -0,0 +1,446 @@
+#include "CookedMesh.h"
+#include "Mesh.h"
+#include "MeshQuantization.h"
+#include "GameException.h"
+#include "LoadProfiler.h"
+#include <fstream>
+#include <algorithm>
+
+namespace Library
+{
+    const UINT CookedMesh::Magic = 0x48534D50; // "PMSH"
+    const UINT CookedMesh::Version = 4;
+    const UINT CookedMesh::Alignment = 16;
+    const std::wstring CookedMesh::Extension = L".pmesh";
+
+    CookedMesh::CookedMesh(const std::wstring& filename)
+        : mFilename(filename), mFile(), mData(nullptr), mHeader(nullptr), mBounds(), mSubmeshes()
+    {
+        if (VirtualFileSystem::Open(filename, mFile) == false)
+        {
+            throw GameException("Could not open cooked mesh.");
+        }
+
+        if (mFile.Size() < sizeof(CookedMeshHeader))
+        {
+            throw GameException("Cooked mesh has an invalid size.");
+        }
+
+        mData = mFile.Data();
+        mHeader = reinterpret_cast<const CookedMeshHeader*>(mData);
+        if (mHeader->Magic != Magic || mHeader->Version != Version || mHeader->FileSize != mFile.Size())
+        {
+            throw GameException("Cooked mesh header is invalid or out of date.");
+        }
+
+        UINT64 indexEnd = static_cast<UINT64>(mHeader->IndexOffset) + sizeof(UINT) * static_cast<UINT64>(mHeader->IndexCount);
+        if (mHeader->IndexCount == 0 || indexEnd > mHeader->FileSize)
+        {
+            throw GameException("Cooked mesh index stream is out of range.");
+        }
+
+        for (UINT i = 0; i < VertexFormatEnd; i++)
+        {
+            UINT64 streamEnd = static_cast<UINT64>(mHeader->StreamOffsets[i]) + VertexStride(VertexFormat(i)) * static_cast<UINT64>(mHeader->VertexCount);
+            if (mHeader->StreamOffsets[i] != 0 && streamEnd > mHeader->FileSize)
+            {
+                throw GameException("Cooked mesh vertex stream is out of range.");
+            }
+        }
+
+        UINT64 submeshEnd = static_cast<UINT64>(mHeader->SubmeshOffset) + sizeof(CookedSubmesh) * static_cast<UINT64>(mHeader->SubmeshCount);
+        if (mHeader->SubmeshCount == 0 || submeshEnd > mHeader->FileSize)
+        {
+            throw GameException("Cooked mesh submesh table is out of range.");
+        }
+
+        const CookedSubmesh* cookedSubmeshes = reinterpret_cast<const CookedSubmesh*>(mData + mHeader->SubmeshOffset);
+        mSubmeshes.resize(mHeader->SubmeshCount);
+        for (UINT i = 0; i < mHeader->SubmeshCount; i++)
+        {
+            const CookedSubmesh& cookedSubmesh = cookedSubmeshes[i];
+            if (cookedSubmesh.LevelOfDetailCount == 0 || cookedSubmesh.LevelOfDetailCount > MeshSimplifier::MaxLevelsOfDetail ||
+                cookedSubmesh.BaseVertex < 0 || static_cast<UINT64>(cookedSubmesh.BaseVertex) + cookedSubmesh.VertexCount > mHeader->VertexCount)
+            {
+                throw GameException("Cooked mesh submesh is invalid.");
+            }
+
+            for (UINT level = 0; level < cookedSubmesh.LevelOfDetailCount; level++)
+            {
+                const MeshLevelOfDetail& levelOfDetail = cookedSubmesh.LevelsOfDetail[level];
+                if (levelOfDetail.IndexCount == 0 || static_cast<UINT64>(levelOfDetail.StartIndex) + levelOfDetail.IndexCount > mHeader->IndexCount)
+                {
+                    throw GameException("Cooked mesh level of detail is out of range.");
+                }
+            }
+
+            ModelSubmesh& submesh = mSubmeshes[i];
+            submesh.StartIndex = cookedSubmesh.StartIndex;
+            submesh.IndexCount = cookedSubmesh.IndexCount;
+            submesh.BaseVertex = cookedSubmesh.BaseVertex;
+            submesh.VertexCount = cookedSubmesh.VertexCount;
+            submesh.MaterialIndex = cookedSubmesh.MaterialIndex;
+            submesh.Bounds.Center = cookedSubmesh.BoundsCenter;
+            submesh.Bounds.Extents = cookedSubmesh.BoundsExtents;
+            submesh.LevelsOfDetail.assign(cookedSubmesh.LevelsOfDetail, cookedSubmesh.LevelsOfDetail + cookedSubmesh.LevelOfDetailCount);
+        }
+
+        mBounds.Center = mHeader->BoundsCenter;
+        mBounds.Extents = mHeader->BoundsExtents;
+    }
+
+    CookedMesh::~CookedMesh()
+    {
+    }
+
+    void CookedMesh::Cook(const Model& model, const std::wstring& filename)
+    {
+        const std::vector<ModelSubmesh>& submeshes = model.Submeshes();
+        if (submeshes.empty())
+        {
+            throw GameException("Model has no triangle meshes to cook.");
+        }
+
+        CookedMeshHeader header;
+        ZeroMemory(&header, sizeof(header));
+        header.Magic = Magic;
+        header.Version = Version;
+        header.VertexCount = model.VertexCount();
+        header.IndexCount = model.IndexCount();
+        header.BoundsCenter = model.Bounds().Center;
+        header.BoundsExtents = model.Bounds().Extents;
+        header.SubmeshCount = submeshes.size();
+
+        std::vector<CookedSubmesh> cookedSubmeshes(submeshes.size());
+        for (UINT i = 0; i < submeshes.size(); i++)
+        {
+            const ModelSubmesh& submesh = submeshes[i];
+            CookedSubmesh& cookedSubmesh = cookedSubmeshes[i];
+            ZeroMemory(&cookedSubmesh, sizeof(cookedSubmesh));
+            cookedSubmesh.StartIndex = submesh.StartIndex;
+            cookedSubmesh.IndexCount = submesh.IndexCount;
+            cookedSubmesh.BaseVertex = submesh.BaseVertex;
+            cookedSubmesh.VertexCount = submesh.VertexCount;
+            cookedSubmesh.MaterialIndex = submesh.MaterialIndex;
+            cookedSubmesh.BoundsCenter = submesh.Bounds.Center;
+            cookedSubmesh.BoundsExtents = submesh.Bounds.Extents;
+            cookedSubmesh.LevelOfDetailCount = (std::min)(static_cast<UINT>(submesh.LevelsOfDetail.size()), MeshSimplifier::MaxLevelsOfDetail);
+            for (UINT level = 0; level < cookedSubmesh.LevelOfDetailCount; level++)
+            {
+                cookedSubmesh.LevelsOfDetail[level] = submesh.LevelsOfDetail[level];
+            }
+        }
+
+        std::vector<byte> streams[VertexFormatEnd];
+        UINT offset = (sizeof(CookedMeshHeader) + Alignment - 1) & ~(Alignment - 1);
+        header.SubmeshOffset = offset;
+        offset = (offset + sizeof(CookedSubmesh) * header.SubmeshCount + Alignment - 1) & ~(Alignment - 1);
+        for (UINT i = 0; i < VertexFormatEnd; i++)
+        {
+            if (SupportsVertexFormat(model, VertexFormat(i)))
+            {
+                BuildVertices(model, VertexFormat(i), streams[i]);
+                header.StreamOffsets[i] = offset;
+                offset = (offset + streams[i].size() + Alignment - 1) & ~(Alignment - 1);
+            }
+        }
+
+        std::vector<UINT> indices;
+        model.BuildIndices(indices);
+        header.IndexOffset = offset;
+        header.FileSize = offset + sizeof(UINT) * header.IndexCount;
+
+        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            throw GameException("Could not open cooked mesh for writing.");
+        }
+
+        std::vector<byte> padding(Alignment, 0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&padding[0]), header.SubmeshOffset - sizeof(header));
+        file.write(reinterpret_cast<const char*>(&cookedSubmeshes[0]), sizeof(CookedSubmesh) * header.SubmeshCount);
+        UINT written = header.SubmeshOffset + sizeof(CookedSubmesh) * header.SubmeshCount;
+
+        for (UINT i = 0; i < VertexFormatEnd; i++)
+        {
+            if (header.StreamOffsets[i] != 0)
+            {
+                file.write(reinterpret_cast<const char*>(&padding[0]), header.StreamOffsets[i] - written);
+                file.write(reinterpret_cast<const char*>(&streams[i][0]), streams[i].size());
+                written = header.StreamOffsets[i] + streams[i].size();
+            }
+        }
+
+        file.write(reinterpret_cast<const char*>(&padding[0]), header.IndexOffset - written);
+        file.write(reinterpret_cast<const char*>(&indices[0]), sizeof(UINT) * header.IndexCount);
+
+        if (file.good() == false)
+        {
+            throw GameException("Failed writing cooked mesh.");
+        }
+    }
+
+    // Quantized positions are relative to the whole model's bounds, so one PositionScale and
+    // PositionOffset serve every submesh.
+    void CookedMesh::BuildVertices(const Model& model, VertexFormat format, std::vector<byte>& vertices)
+    {
+        assert(SupportsVertexFormat(model, format));
+
+        UINT stride = VertexStride(format);
+        vertices.resize(stride * model.VertexCount());
+
+        const std::vector<ModelSubmesh>& submeshes = model.Submeshes();
+        UINT submeshIndex = 0;
+        for (Mesh* mesh : model.Meshes())
+        {
+            if (mesh->IsTriangleList())
+            {
+                WriteVertices(*mesh, format, model.Bounds(), &vertices[stride * submeshes[submeshIndex++].BaseVertex]);
+            }
+        }
+    }
+
+    void CookedMesh::BuildVertices(const Mesh& mesh, VertexFormat format, std::vector<byte>& vertices)
+    {
+        assert(SupportsVertexFormat(mesh, format));
+
+        vertices.resize(VertexStride(format) * mesh.Vertices().size());
+        WriteVertices(mesh, format, MeshQuantization::Bounds(mesh.Vertices()), &vertices[0]);
+    }
+
+    void CookedMesh::WriteVertices(const Mesh& mesh, VertexFormat format, const BoundingBox& bounds, byte* vertices)
+    {
+        const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
+        UINT vertexCount = sourceVertices.size();
+
+        switch (format)
+        {
+            case VertexFormatPosition:
+            {
+                VertexPosition* destination = reinterpret_cast<VertexPosition*>(vertices);
+                for (UINT i = 0; i < vertexCount; i++)
+                {
+                    const XMFLOAT3& position = sourceVertices[i];
+                    destination[i] = VertexPosition(XMFLOAT4(position.x, position.y, position.z, 1.0f));
+                }
+                break;
+            }
+
+            case VertexFormatPositionTexture:
+            {
+                const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+                VertexPositionTexture* destination = reinterpret_cast<VertexPositionTexture*>(vertices);
+                for (UINT i = 0; i < vertexCount; i++)
+                {
+                    const XMFLOAT3& position = sourceVertices[i];
+                    const XMFLOAT3& uv = textureCoordinates[i];
+                    destination[i] = VertexPositionTexture(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y));
+                }
+                break;
+            }
+
+            case VertexFormatPositionTextureNormal:
+            {
+                const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+                const Span<XMFLOAT3>& normals = mesh.Normals();
+                VertexPositionTextureNormal* destination = reinterpret_cast<VertexPositionTextureNormal*>(vertices);
+                for (UINT i = 0; i < vertexCount; i++)
+                {
+                    const XMFLOAT3& position = sourceVertices[i];
+                    const XMFLOAT3& uv = textureCoordinates[i];
+                    destination[i] = VertexPositionTextureNormal(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normals[i]);
+                }
+                break;
+            }
+
+            case VertexFormatPositionQuantized:
+            {
+                VertexPositionQuantized* destination = reinterpret_cast<VertexPositionQuantized*>(vertices);
+                for (UINT i = 0; i < vertexCount; i++)
+                {
+                    destination[i] = VertexPositionQuantized(MeshQuantization::QuantizePosition(sourceVertices[i], bounds));
+                }
+                break;
+            }
+
+            case VertexFormatPositionTextureNormalQuantized:
+            {
+                const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+                const Span<XMFLOAT3>& normals = mesh.Normals();
+                VertexPositionTextureNormalQuantized* destination = reinterpret_cast<VertexPositionTextureNormalQuantized*>(vertices);
+                for (UINT i = 0; i < vertexCount; i++)
+                {
+                    const XMFLOAT3& uv = textureCoordinates[i];
+                    destination[i] = VertexPositionTextureNormalQuantized(MeshQuantization::QuantizePosition(sourceVertices[i], bounds), XMHALF2(uv.x, uv.y), MeshQuantization::EncodeOctahedral(normals[i]));
+                }
+                break;
+            }
+
+            default:
+                throw GameException("Unsupported vertex format.");
+        }
+    }
+
+    bool CookedMesh::SupportsVertexFormat(const Model& model, VertexFormat format)
+    {
+        bool supported = (model.Submeshes().empty() == false);
+        for (Mesh* mesh : model.Meshes())
+        {
+            if (mesh->IsTriangleList() && SupportsVertexFormat(*mesh, format) == false)
+            {
+                supported = false;
+            }
+        }
+
+        return supported;
+    }
+
+    bool CookedMesh::SupportsVertexFormat(const Mesh& mesh, VertexFormat format)
+    {
+        bool hasTextureCoordinates = (mesh.TextureCoordinates().size() > 0);
+        bool hasNormals = (mesh.Normals().size() == mesh.Vertices().size());
+
+        switch (format)
+        {
+            case VertexFormatPosition:
+            case VertexFormatPositionQuantized:
+                return true;
+
+            case VertexFormatPositionTexture:
+                return hasTextureCoordinates;
+
+            case VertexFormatPositionTextureNormal:
+            case VertexFormatPositionTextureNormalQuantized:
+                return hasTextureCoordinates && hasNormals;
+
+            default:
+                return false;
+        }
+    }
+
+    UINT CookedMesh::VertexStride(VertexFormat format)
+    {
+        switch (format)
+        {
+            case VertexFormatPosition:
+                return sizeof(VertexPosition);
+
+            case VertexFormatPositionTexture:
+                return sizeof(VertexPositionTexture);
+
+            case VertexFormatPositionTextureNormal:
+                return sizeof(VertexPositionTextureNormal);
+
+            case VertexFormatPositionQuantized:
+                return sizeof(VertexPositionQuantized);
+
+            case VertexFormatPositionTextureNormalQuantized:
+                return sizeof(VertexPositionTextureNormalQuantized);
+
+            default:
+                return 0;
+        }
+    }
+
+    std::wstring CookedMesh::CookedFilename(const std::string& sourceFilename)
+    {
+        std::wstring filename(sourceFilename.begin(), sourceFilename.end());
+
+        std::wstring::size_type extensionIndex = filename.find_last_of(L'.');
+        std::wstring::size_type separatorIndex = filename.find_last_of(L"\\/");
+        if (extensionIndex != std::wstring::npos && (separatorIndex == std::wstring::npos || extensionIndex > separatorIndex))
+        {
+            filename.erase(extensionIndex);
+        }
+
+        return filename + Extension;
+    }
+
+    const std::wstring& CookedMesh::Filename() const
+    {
+        return mFilename;
+    }
+
+    bool CookedMesh::HasVertexFormat(VertexFormat format) const
+    {
+        return (format < VertexFormatEnd && mHeader->StreamOffsets[format] != 0);
+    }
+
+    const void* CookedMesh::Vertices(VertexFormat format) const
+    {
+        return (HasVertexFormat(format) ? mData + mHeader->StreamOffsets[format] : nullptr);
+    }
+
+    UINT CookedMesh::VertexCount() const
+    {
+        return mHeader->VertexCount;
+    }
+
+    const UINT* CookedMesh::Indices() const
+    {
+        return reinterpret_cast<const UINT*>(mData + mHeader->IndexOffset);
+    }
+
+    UINT CookedMesh::IndexCount() const
+    {
+        return mHeader->IndexCount;
+    }
+
+    const std::vector<ModelSubmesh>& CookedMesh::Submeshes() const
+    {
+        return mSubmeshes;
+    }
+
+    const BoundingBox& CookedMesh::Bounds() const
+    {
+        return mBounds;
+    }
+
+    void CookedMesh::CreateVertexBuffer(ID3D11Device* device, VertexFormat format, ID3D11Buffer** vertexBuffer) const
+    {
+        assert(vertexBuffer != nullptr);
+
+        if (HasVertexFormat(format) == false)
+        {
+            throw GameException("Cooked mesh does not contain the requested vertex format.");
+        }
+
+        D3D11_BUFFER_DESC vertexBufferDesc;
+        ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
+        vertexBufferDesc.ByteWidth = VertexStride(format) * mHeader->VertexCount;
+        vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+        D3D11_SUBRESOURCE_DATA vertexSubResourceData;
+        ZeroMemory(&vertexSubResourceData, sizeof(vertexSubResourceData));
+        vertexSubResourceData.pSysMem = Vertices(format);
+        if (FAILED(device->CreateBuffer(&vertexBufferDesc, &vertexSubResourceData, vertexBuffer)))
+        {
+            throw GameException("ID3D11Device::CreateBuffer() failed.");
+        }
+
+        LoadProfiler::AddBytesUploaded(vertexBufferDesc.ByteWidth);
+    }
+
+    void CookedMesh::CreateIndexBuffer(ID3D11Device* device, ID3D11Buffer** indexBuffer) const
+    {
+        assert(indexBuffer != nullptr);
+
+        D3D11_BUFFER_DESC indexBufferDesc;
+        ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
+        indexBufferDesc.ByteWidth = sizeof(UINT) * mHeader->IndexCount;
+        indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+        D3D11_SUBRESOURCE_DATA indexSubResourceData;
+        ZeroMemory(&indexSubResourceData, sizeof(indexSubResourceData));
+        indexSubResourceData.pSysMem = Indices();
+        if (FAILED(device->CreateBuffer(&indexBufferDesc, &indexSubResourceData, indexBuffer)))
+        {
+            throw GameException("ID3D11Device::CreateBuffer() failed.");
+        }
+
+        LoadProfiler::AddBytesUploaded(indexBufferDesc.ByteWidth);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Common.h"
+#include "VertexDeclarations.h"
+#include "Model.h"
+#include "VirtualFileSystem.h"
+#include <DirectXCollision.h>
+
+namespace Library
+{
+    class Mesh;
+
+    // On-disk layout of a cooked model (.pmesh). Every offset is from the start of the file and
+    // 16-byte aligned; a stream offset of 0 means the format was not cooked for this model. The
+    // streams hold every submesh back to back and the submesh table (CookedSubmesh records at
+    // SubmeshOffset) locates each one, see ModelSubmesh.
+    typedef struct _CookedMeshHeader
+    {
+        UINT Magic;
+        UINT Version;
+        UINT FileSize;
+        UINT VertexCount;
+        UINT IndexCount;
+        UINT IndexOffset;
+        UINT StreamOffsets[VertexFormatEnd];
+        XMFLOAT3 BoundsCenter;
+        XMFLOAT3 BoundsExtents;
+        UINT SubmeshCount;
+        UINT SubmeshOffset;
+    } CookedMeshHeader;
+
+    typedef struct _CookedSubmesh
+    {
+        UINT StartIndex;
+        UINT IndexCount;
+        INT BaseVertex;
+        UINT VertexCount;
+        UINT MaterialIndex;
+        XMFLOAT3 BoundsCenter;
+        XMFLOAT3 BoundsExtents;
+        UINT LevelOfDetailCount;
+        MeshLevelOfDetail LevelsOfDetail[MeshSimplifier::MaxLevelsOfDetail];
+    } CookedSubmesh;
+
+    // Read-only view of a cooked model. The file is memory-mapped (directly or inside the content
+    // archive, see VirtualFileSystem) and the interleaved vertex streams and indices are handed
+    // straight to D3D11_SUBRESOURCE_DATA without a copy.
+    class CookedMesh
+    {
+    public:
+        static const UINT Magic;
+        static const UINT Version;
+        static const UINT Alignment;
+        static const std::wstring Extension;
+
+        CookedMesh(const std::wstring& filename);
+        ~CookedMesh();
+
+        static void Cook(const Model& model, const std::wstring& filename);
+        static void BuildVertices(const Model& model, VertexFormat format, std::vector<byte>& vertices);
+        static void BuildVertices(const Mesh& mesh, VertexFormat format, std::vector<byte>& vertices);
+        static bool SupportsVertexFormat(const Model& model, VertexFormat format);
+        static bool SupportsVertexFormat(const Mesh& mesh, VertexFormat format);
+        static UINT VertexStride(VertexFormat format);
+        static std::wstring CookedFilename(const std::string& sourceFilename);
+
+        const std::wstring& Filename() const;
+        bool HasVertexFormat(VertexFormat format) const;
+        const void* Vertices(VertexFormat format) const;
+        UINT VertexCount() const;
+        const UINT* Indices() const;
+        UINT IndexCount() const;
+        const std::vector<ModelSubmesh>& Submeshes() const;
+        const DirectX::BoundingBox& Bounds() const;
+
+        void CreateVertexBuffer(ID3D11Device* device, VertexFormat format, ID3D11Buffer** vertexBuffer) const;
+        void CreateIndexBuffer(ID3D11Device* device, ID3D11Buffer** indexBuffer) const;
+
+    private:
+        CookedMesh();
+        CookedMesh(const CookedMesh& rhs);
+        CookedMesh& operator=(const CookedMesh& rhs);
+
+        static void WriteVertices(const Mesh& mesh, VertexFormat format, const DirectX::BoundingBox& bounds, byte* vertices);
+
+        std::wstring mFilename;
+        FileData mFile;
+        const byte* mData;
+        const CookedMeshHeader* mHeader;
+        DirectX::BoundingBox mBounds;
+        std::vector<ModelSubmesh> mSubmeshes;
+    };
+}
@@ -0,0 +1,453 @@
+#include "CookedTexture.h"
+#include "GameException.h"
+#include "VirtualFileSystem.h"
+#include <DDSTextureLoader.h>
+#include <WICTextureLoader.h>
+#include <algorithm>
+#include <fstream>
+
+namespace Library
+{
+    namespace
+    {
+        const UINT DdsMagic = 0x20534444; // "DDS "
+        const UINT FourCCDXT1 = 0x31545844; // "DXT1"
+        const UINT FourCCDXT5 = 0x35545844; // "DXT5"
+
+        const UINT DdsHeaderFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+        const UINT DdsPixelFormatFourCC = 0x4;
+        const UINT DdsCaps = 0x8 | 0x1000 | 0x400000; // COMPLEX | TEXTURE | MIPMAP
+
+        USHORT PackColor565(const byte* color)
+        {
+            return USHORT(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+        }
+
+        void UnpackColor565(USHORT packedColor, byte* color)
+        {
+            UINT red = (packedColor >> 11) & 0x1F;
+            UINT green = (packedColor >> 5) & 0x3F;
+            UINT blue = packedColor & 0x1F;
+
+            color[0] = byte((red << 3) | (red >> 2));
+            color[1] = byte((green << 2) | (green >> 4));
+            color[2] = byte((blue << 3) | (blue >> 2));
+        }
+    }
+
+    const std::wstring CookedTexture::Extension = L".dds";
+
+    void CookedTexture::Cook(const std::vector<byte>& pixels, UINT width, UINT height, const std::wstring& filename)
+    {
+        if (CanCook(width, height) == false)
+        {
+            throw GameException("Block-compressed textures need dimensions that are a multiple of 4.");
+        }
+
+        CookedTextureFormat format = (HasAlpha(pixels) ? CookedTextureFormatBC3 : CookedTextureFormatBC1);
+        UINT mipCount = MipCount(width, height);
+
+        CookedTextureHeader header;
+        ZeroMemory(&header, sizeof(header));
+        header.Size = sizeof(CookedTextureHeader);
+        header.Flags = DdsHeaderFlags;
+        header.Height = height;
+        header.Width = width;
+        header.PitchOrLinearSize = (width / 4) * (height / 4) * BlockSize(format);
+        header.MipMapCount = mipCount;
+        header.PixelFormat.Size = sizeof(CookedTexturePixelFormat);
+        header.PixelFormat.Flags = DdsPixelFormatFourCC;
+        header.PixelFormat.FourCC = (format == CookedTextureFormatBC3 ? FourCCDXT5 : FourCCDXT1);
+        header.Caps = DdsCaps;
+
+        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            throw GameException("Could not open cooked texture for writing.");
+        }
+
+        file.write(reinterpret_cast<const char*>(&DdsMagic), sizeof(DdsMagic));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<byte> mip(pixels);
+        std::vector<byte> nextMip;
+        std::vector<byte> blocks;
+        UINT mipWidth = width;
+        UINT mipHeight = height;
+        for (UINT level = 0; level < mipCount; level++)
+        {
+            Compress(mip, mipWidth, mipHeight, format, blocks);
+            file.write(reinterpret_cast<const char*>(&blocks[0]), blocks.size());
+
+            if (level + 1 < mipCount)
+            {
+                GenerateMip(mip, mipWidth, mipHeight, nextMip);
+                mip.swap(nextMip);
+                mipWidth = (std::max)(1U, mipWidth / 2);
+                mipHeight = (std::max)(1U, mipHeight / 2);
+            }
+        }
+
+        if (file.good() == false)
+        {
+            throw GameException("Failed writing cooked texture.");
+        }
+    }
+
+    // 2x2 box filter; odd edges reuse the last row or column. Source images are sRGB, so colors are
+    // averaged in linear space (a straight average of encoded bytes darkens every mip); alpha is linear.
+    void CookedTexture::GenerateMip(const std::vector<byte>& source, UINT sourceWidth, UINT sourceHeight, std::vector<byte>& destination)
+    {
+        UINT width = (std::max)(1U, sourceWidth / 2);
+        UINT height = (std::max)(1U, sourceHeight / 2);
+        destination.resize(width * height * 4);
+
+        const XMUBYTEN4* sourcePixels = reinterpret_cast<const XMUBYTEN4*>(&source[0]);
+        XMUBYTEN4* destinationPixels = reinterpret_cast<XMUBYTEN4*>(&destination[0]);
+
+        for (UINT y = 0; y < height; y++)
+        {
+            const XMUBYTEN4* row0 = sourcePixels + (std::min)(y * 2, sourceHeight - 1) * sourceWidth;
+            const XMUBYTEN4* row1 = sourcePixels + (std::min)(y * 2 + 1, sourceHeight - 1) * sourceWidth;
+
+            for (UINT x = 0; x < width; x++)
+            {
+                UINT x0 = (std::min)(x * 2, sourceWidth - 1);
+                UINT x1 = (std::min)(x * 2 + 1, sourceWidth - 1);
+
+                XMVECTOR sum = XMVectorAdd(XMColorSRGBToRGB(XMLoadUByteN4(&row0[x0])), XMColorSRGBToRGB(XMLoadUByteN4(&row0[x1])));
+                sum = XMVectorAdd(sum, XMColorSRGBToRGB(XMLoadUByteN4(&row1[x0])));
+                sum = XMVectorAdd(sum, XMColorSRGBToRGB(XMLoadUByteN4(&row1[x1])));
+
+                XMStoreUByteN4(&destinationPixels[y * width + x], XMColorRGBToSRGB(XMVectorScale(sum, 0.25f)));
+            }
+        }
+    }
+
+    void CookedTexture::Compress(const std::vector<byte>& pixels, UINT width, UINT height, CookedTextureFormat format, std::vector<byte>& blocks)
+    {
+        UINT blocksWide = (std::max)(1U, (width + 3) / 4);
+        UINT blocksHigh = (std::max)(1U, (height + 3) / 4);
+        UINT blockSize = BlockSize(format);
+        blocks.resize(blocksWide * blocksHigh * blockSize);
+
+        byte block[16 * 4];
+        for (UINT blockY = 0; blockY < blocksHigh; blockY++)
+        {
+            for (UINT blockX = 0; blockX < blocksWide; blockX++)
+            {
+                // Blocks hanging over the edge of small mips repeat the last row or column
+                for (UINT i = 0; i < 16; i++)
+                {
+                    UINT x = (std::min)(blockX * 4 + (i % 4), width - 1);
+                    UINT y = (std::min)(blockY * 4 + (i / 4), height - 1);
+                    memcpy(&block[i * 4], &pixels[(y * width + x) * 4], 4);
+                }
+
+                byte* destination = &blocks[(blockY * blocksWide + blockX) * blockSize];
+                if (format == CookedTextureFormatBC3)
+                {
+                    CompressAlphaBlock(block, destination);
+                    destination += 8;
+                }
+
+                CompressColorBlock(block, destination);
+            }
+        }
+    }
+
+    void CookedTexture::Decompress(const std::vector<byte>& blocks, UINT width, UINT height, CookedTextureFormat format, std::vector<byte>& pixels)
+    {
+        UINT blocksWide = (std::max)(1U, (width + 3) / 4);
+        UINT blocksHigh = (std::max)(1U, (height + 3) / 4);
+        UINT blockSize = BlockSize(format);
+        pixels.resize(width * height * 4);
+
+        byte block[16 * 4];
+        for (UINT blockY = 0; blockY < blocksHigh; blockY++)
+        {
+            for (UINT blockX = 0; blockX < blocksWide; blockX++)
+            {
+                const byte* source = &blocks[(blockY * blocksWide + blockX) * blockSize];
+                if (format == CookedTextureFormatBC3)
+                {
+                    DecompressAlphaBlock(source, block);
+                    source += 8;
+                }
+                else
+                {
+                    for (UINT i = 0; i < 16; i++)
+                    {
+                        block[i * 4 + 3] = 255;
+                    }
+                }
+
+                DecompressColorBlock(source, block);
+
+                for (UINT i = 0; i < 16; i++)
+                {
+                    UINT x = blockX * 4 + (i % 4);
+                    UINT y = blockY * 4 + (i / 4);
+                    if (x < width && y < height)
+                    {
+                        memcpy(&pixels[(y * width + x) * 4], &block[i * 4], 4);
+                    }
+                }
+            }
+        }
+    }
+
+    bool CookedTexture::HasAlpha(const std::vector<byte>& pixels)
+    {
+        for (UINT i = 3; i < pixels.size(); i += 4)
+        {
+            if (pixels[i] != 255)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool CookedTexture::CanCook(UINT width, UINT height)
+    {
+        return (width % 4 == 0 && height % 4 == 0);
+    }
+
+    UINT CookedTexture::MipCount(UINT width, UINT height)
+    {
+        UINT mipCount = 1;
+        for (UINT size = (std::max)(width, height); size > 1; size /= 2)
+        {
+            mipCount++;
+        }
+
+        return mipCount;
+    }
+
+    UINT CookedTexture::BlockSize(CookedTextureFormat format)
+    {
+        return (format == CookedTextureFormatBC3 ? 16 : 8);
+    }
+
+    std::wstring CookedTexture::CookedFilename(const std::wstring& sourceFilename)
+    {
+        std::wstring filename(sourceFilename);
+
+        std::wstring::size_type extensionIndex = filename.find_last_of(L'.');
+        std::wstring::size_type separatorIndex = filename.find_last_of(L"\\/");
+        if (extensionIndex != std::wstring::npos && (separatorIndex == std::wstring::npos || extensionIndex > separatorIndex))
+        {
+            filename.erase(extensionIndex);
+        }
+
+        return filename + Extension;
+    }
+
+    // Both files are read through the VirtualFileSystem and decoded from memory
+    void CookedTexture::CreateShaderResourceView(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::wstring& sourceFilename, ID3D11ShaderResourceView** shaderResourceView)
+    {
+        HRESULT hr;
+        FileData file;
+        if (VirtualFileSystem::Open(CookedFilename(sourceFilename), file))
+        {
+            if (FAILED(hr = DirectX::CreateDDSTextureFromMemory(device, file.Data(), static_cast<size_t>(file.Size()), nullptr, shaderResourceView)))
+            {
+                throw GameException("CreateDDSTextureFromMemory() failed.", hr);
+            }
+        }
+        else if (VirtualFileSystem::Open(sourceFilename, file) == false)
+        {
+            throw GameException("Could not open texture.", HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+        }
+        else if (FAILED(hr = DirectX::CreateWICTextureFromMemory(device, deviceContext, file.Data(), static_cast<size_t>(file.Size()), nullptr, shaderResourceView)))
+        {
+            throw GameException("CreateWICTextureFromMemory() failed.", hr);
+        }
+    }
+
+    // BC1 color block: endpoints from the (slightly inset) RGB bounding box, always in four-color mode.
+    void CookedTexture::CompressColorBlock(const byte* block, byte* destination)
+    {
+        byte minColor[3] = { 255, 255, 255 };
+        byte maxColor[3] = { 0, 0, 0 };
+        for (UINT i = 0; i < 16; i++)
+        {
+            for (UINT channel = 0; channel < 3; channel++)
+            {
+                minColor[channel] = (std::min)(minColor[channel], block[i * 4 + channel]);
+                maxColor[channel] = (std::max)(maxColor[channel], block[i * 4 + channel]);
+            }
+        }
+
+        for (UINT channel = 0; channel < 3; channel++)
+        {
+            byte inset = byte((maxColor[channel] - minColor[channel]) >> 4);
+            minColor[channel] += inset;
+            maxColor[channel] -= inset;
+        }
+
+        USHORT color0 = PackColor565(maxColor);
+        USHORT color1 = PackColor565(minColor);
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        UINT indices = 0;
+        if (color0 != color1)
+        {
+            byte palette[4][3];
+            UnpackColor565(color0, palette[0]);
+            UnpackColor565(color1, palette[1]);
+            for (UINT channel = 0; channel < 3; channel++)
+            {
+                palette[2][channel] = byte((2 * palette[0][channel] + palette[1][channel]) / 3);
+                palette[3][channel] = byte((palette[0][channel] + 2 * palette[1][channel]) / 3);
+            }
+
+            for (UINT i = 0; i < 16; i++)
+            {
+                UINT bestIndex = 0;
+                int bestDistance = INT_MAX;
+                for (UINT j = 0; j < 4; j++)
+                {
+                    int distance = 0;
+                    for (UINT channel = 0; channel < 3; channel++)
+                    {
+                        int delta = int(block[i * 4 + channel]) - int(palette[j][channel]);
+                        distance += delta * delta;
+                    }
+
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = j;
+                    }
+                }
+
+                indices |= bestIndex << (i * 2);
+            }
+        }
+
+        memcpy(destination, &color0, sizeof(USHORT));
+        memcpy(destination + 2, &color1, sizeof(USHORT));
+        memcpy(destination + 4, &indices, sizeof(UINT));
+    }
+
+    // BC3 alpha block: eight interpolated values between the block's min and max alpha.
+    void CookedTexture::CompressAlphaBlock(const byte* block, byte* destination)
+    {
+        byte minAlpha = 255;
+        byte maxAlpha = 0;
+        for (UINT i = 0; i < 16; i++)
+        {
+            minAlpha = (std::min)(minAlpha, block[i * 4 + 3]);
+            maxAlpha = (std::max)(maxAlpha, block[i * 4 + 3]);
+        }
+
+        destination[0] = maxAlpha;
+        destination[1] = minAlpha;
+
+        UINT64 indices = 0;
+        if (maxAlpha != minAlpha)
+        {
+            byte palette[8];
+            palette[0] = maxAlpha;
+            palette[1] = minAlpha;
+            for (UINT j = 2; j < 8; j++)
+            {
+                palette[j] = byte(((8 - j) * maxAlpha + (j - 1) * minAlpha) / 7);
+            }
+
+            for (UINT i = 0; i < 16; i++)
+            {
+                UINT bestIndex = 0;
+                int bestDistance = INT_MAX;
+                for (UINT j = 0; j < 8; j++)
+                {
+                    int distance = abs(int(block[i * 4 + 3]) - int(palette[j]));
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = j;
+                    }
+                }
+
+                indices |= UINT64(bestIndex) << (i * 3);
+            }
+        }
+
+        for (UINT i = 0; i < 6; i++)
+        {
+            destination[2 + i] = byte(indices >> (i * 8));
+        }
+    }
+
+    void CookedTexture::DecompressColorBlock(const byte* source, byte* block)
+    {
+        USHORT color0;
+        USHORT color1;
+        UINT indices;
+        memcpy(&color0, source, sizeof(USHORT));
+        memcpy(&color1, source + 2, sizeof(USHORT));
+        memcpy(&indices, source + 4, sizeof(UINT));
+
+        byte palette[4][3];
+        UnpackColor565(color0, palette[0]);
+        UnpackColor565(color1, palette[1]);
+        for (UINT channel = 0; channel < 3; channel++)
+        {
+            if (color0 > color1)
+            {
+                palette[2][channel] = byte((2 * palette[0][channel] + palette[1][channel]) / 3);
+                palette[3][channel] = byte((palette[0][channel] + 2 * palette[1][channel]) / 3);
+            }
+            else
+            {
+                palette[2][channel] = byte((palette[0][channel] + palette[1][channel]) / 2);
+                palette[3][channel] = 0;
+            }
+        }
+
+        for (UINT i = 0; i < 16; i++)
+        {
+            memcpy(&block[i * 4], palette[(indices >> (i * 2)) & 0x3], 3);
+        }
+    }
+
+    void CookedTexture::DecompressAlphaBlock(const byte* source, byte* block)
+    {
+        byte palette[8];
+        palette[0] = source[0];
+        palette[1] = source[1];
+        if (palette[0] > palette[1])
+        {
+            for (UINT j = 2; j < 8; j++)
+            {
+                palette[j] = byte(((8 - j) * palette[0] + (j - 1) * palette[1]) / 7);
+            }
+        }
+        else
+        {
+            for (UINT j = 2; j < 6; j++)
+            {
+                palette[j] = byte(((6 - j) * palette[0] + (j - 1) * palette[1]) / 5);
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        UINT64 indices = 0;
+        for (UINT i = 0; i < 6; i++)
+        {
+            indices |= UINT64(source[2 + i]) << (i * 8);
+        }
+
+        for (UINT i = 0; i < 16; i++)
+        {
+            block[i * 4 + 3] = palette[(indices >> (i * 3)) & 0x7];
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    // DDS file layout (see DDS_HEADER in the DirectX SDK); only the fields the cooker fills are used.
+    typedef struct _CookedTexturePixelFormat
+    {
+        UINT Size;
+        UINT Flags;
+        UINT FourCC;
+        UINT RGBBitCount;
+        UINT RBitMask;
+        UINT GBitMask;
+        UINT BBitMask;
+        UINT ABitMask;
+    } CookedTexturePixelFormat;
+
+    typedef struct _CookedTextureHeader
+    {
+        UINT Size;
+        UINT Flags;
+        UINT Height;
+        UINT Width;
+        UINT PitchOrLinearSize;
+        UINT Depth;
+        UINT MipMapCount;
+        UINT Reserved1[11];
+        CookedTexturePixelFormat PixelFormat;
+        UINT Caps;
+        UINT Caps2;
+        UINT Caps3;
+        UINT Caps4;
+        UINT Reserved2;
+    } CookedTextureHeader;
+
+    enum CookedTextureFormat
+    {
+        CookedTextureFormatBC1 = 0,
+        CookedTextureFormatBC3
+    };
+
+    // Offline conversion of decoded RGBA8 images into block-compressed DDS files with a full mip
+    // chain, and the runtime loader that prefers those files over the original PNG/JPG sources.
+    //
+    // Direct3D needs the top level of a block-compressed texture to be a multiple of 4 on each side.
+    // Images that are not (CanCook) are left uncooked and keep loading from their source file;
+    // padding them would shift their texture coordinates.
+    class CookedTexture
+    {
+    public:
+        static const std::wstring Extension;
+
+        static void Cook(const std::vector<byte>& pixels, UINT width, UINT height, const std::wstring& filename);
+        static void GenerateMip(const std::vector<byte>& source, UINT sourceWidth, UINT sourceHeight, std::vector<byte>& destination);
+        static void Compress(const std::vector<byte>& pixels, UINT width, UINT height, CookedTextureFormat format, std::vector<byte>& blocks);
+        static void Decompress(const std::vector<byte>& blocks, UINT width, UINT height, CookedTextureFormat format, std::vector<byte>& pixels);
+        static bool HasAlpha(const std::vector<byte>& pixels);
+        static bool CanCook(UINT width, UINT height);
+        static UINT MipCount(UINT width, UINT height);
+        static UINT BlockSize(CookedTextureFormat format);
+        static std::wstring CookedFilename(const std::wstring& sourceFilename);
+
+        static void CreateShaderResourceView(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::wstring& sourceFilename, ID3D11ShaderResourceView** shaderResourceView);
+
+    private:
+        CookedTexture();
+        CookedTexture(const CookedTexture& rhs);
+        CookedTexture& operator=(const CookedTexture& rhs);
+
+        static void CompressColorBlock(const byte* block, byte* destination);
+        static void CompressAlphaBlock(const byte* block, byte* destination);
+        static void DecompressColorBlock(const byte* source, byte* block);
+        static void DecompressAlphaBlock(const byte* source, byte* block);
+    };
+}
@@ -6,19 +6,32 @@ namespace Library
 {
     RTTI_DEFINITIONS(DepthMapMaterial)	
 
+    const char* const DepthMapMaterialConstants::ConstantBufferName = "CBufferPerObject";
+
+    const MaterialConstantMember DepthMapMaterialConstants::Members[] =
+    {
+        MATERIAL_CONSTANT_MEMBER(DepthMapMaterialConstants, WorldLightViewProjection),
+        MATERIAL_CONSTANT_MEMBER(DepthMapMaterialConstants, PositionScale),
+        MATERIAL_CONSTANT_MEMBER(DepthMapMaterialConstants, PositionOffset)
+    };
+
+    const UINT DepthMapMaterialConstants::MemberCount = ARRAYSIZE(DepthMapMaterialConstants::Members);
+
     DepthMapMaterial::DepthMapMaterial()
-        : Material("create_depthmap"),
-          MATERIAL_VARIABLE_INITIALIZATION(WorldLightViewProjection)
+        : Material("create_depthmap"), mConstants()
     {
     }
 
-    MATERIAL_VARIABLE_DEFINITION(DepthMapMaterial, WorldLightViewProjection)
+    MaterialConstants<DepthMapMaterialConstants>& DepthMapMaterial::Constants()
+    {
+        return mConstants;
+    }
 
     void DepthMapMaterial::Initialize(Effect& effect)
     {
         Material::Initialize(effect);
 
-        MATERIAL_VARIABLE_RETRIEVE(WorldLightViewProjection)
+        mConstants.Bind(effect);
 
         D3D11_INPUT_ELEMENT_DESC inputElementDescriptions[] =
         {
@@ -26,13 +39,20 @@ namespace Library
         };
 
         CreateInputLayout("create_depthmap", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));
-		CreateInputLayout("create_depthmap_w_bias", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));
 		CreateInputLayout("create_depthmap_w_render_target", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));		
+
+        D3D11_INPUT_ELEMENT_DESC compactInputElementDescriptions[] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+        };
+
+        CreateInputLayout("create_depthmap_compact", "p0", compactInputElementDescriptions, ARRAYSIZE(compactInputElementDescriptions));
+        CreateInputLayout("create_depthmap_w_render_target_compact", "p0", compactInputElementDescriptions, ARRAYSIZE(compactInputElementDescriptions));
     }
 
     void DepthMapMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
     {
-        const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+        const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
 
         std::vector<VertexPosition> vertices;
         vertices.reserve(sourceVertices.size());
@@ -66,4 +86,9 @@ namespace Library
     {
         return sizeof(VertexPosition);
     }
+
+    UINT DepthMapMaterial::CompactVertexSize() const
+    {
+        return sizeof(VertexPositionQuantized);
+    }
 }
\ No newline at end of file
@@ -3,21 +3,46 @@
 #include "Common.h"
 #include "Material.h"
 #include "VertexDeclarations.h"
+#include "MaterialConstants.h"
 
 namespace Library
 {
+    // Mirrors CBufferPerObject in Content\Effects\DepthMap.fx
+    typedef struct _DepthMapMaterialConstants
+    {
+        XMFLOAT4X4 WorldLightViewProjection;
+        XMFLOAT3 PositionScale;
+        float Padding;
+        XMFLOAT3 PositionOffset;
+        float Padding2;
+
+        static const char* const ConstantBufferName;
+        static const MaterialConstantMember Members[];
+        static const UINT MemberCount;
+
+        _DepthMapMaterialConstants()
+            : WorldLightViewProjection(), PositionScale(1.0f, 1.0f, 1.0f), Padding(0.0f), PositionOffset(0.0f, 0.0f, 0.0f), Padding2(0.0f)
+        {
+        }
+    } DepthMapMaterialConstants;
+
     class DepthMapMaterial : public Material
     {
         RTTI_DECLARATIONS(DepthMapMaterial, Material)
 
-        MATERIAL_VARIABLE_DECLARATION(WorldLightViewProjection)
-
     public:
         DepthMapMaterial();
 
+        // The whole of CBufferPerObject; fill it and Commit() once per draw
+        MaterialConstants<DepthMapMaterialConstants>& Constants();
+
         virtual void Initialize(Effect& effect) override;		
         virtual void CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const override;
         void CreateVertexBuffer(ID3D11Device* device, VertexPosition* vertices, UINT vertexCount, ID3D11Buffer** vertexBuffer) const;
         virtual UINT VertexSize() const override;
+        UINT CompactVertexSize() const;
+
+    private:
+        MaterialConstants<DepthMapMaterialConstants> mConstants;
     };
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "DirectoryFileSystem.h"
+#include "GameException.h"
+
+namespace Library
+{
+    namespace
+    {
+        typedef struct _MappedFile
+        {
+            HANDLE File;
+            HANDLE Mapping;
+            const byte* View;
+
+            _MappedFile()
+                : File(INVALID_HANDLE_VALUE), Mapping(nullptr), View(nullptr) { }
+
+            ~_MappedFile()
+            {
+                if (View != nullptr)
+                {
+                    UnmapViewOfFile(View);
+                }
+
+                if (Mapping != nullptr)
+                {
+                    CloseHandle(Mapping);
+                }
+
+                if (File != INVALID_HANDLE_VALUE)
+                {
+                    CloseHandle(File);
+                }
+            }
+        } MappedFile;
+    }
+
+    DirectoryFileSystem::DirectoryFileSystem(const std::wstring& rootDirectory)
+        : mRootDirectory(rootDirectory)
+    {
+    }
+
+    bool DirectoryFileSystem::Exists(const std::string& path) const
+    {
+        DWORD attributes = GetFileAttributes(FullPath(path).c_str());
+
+        return (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0);
+    }
+
+    bool DirectoryFileSystem::Open(const std::string& path, FileData& file) const
+    {
+        return MapFile(FullPath(path), file);
+    }
+
+    const std::wstring& DirectoryFileSystem::RootDirectory() const
+    {
+        return mRootDirectory;
+    }
+
+    bool DirectoryFileSystem::MapFile(const std::wstring& filename, FileData& file)
+    {
+        std::shared_ptr<MappedFile> mappedFile = std::make_shared<MappedFile>();
+        mappedFile->File = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mappedFile->File == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(mappedFile->File, &fileSize) == FALSE || fileSize.HighPart != 0)
+        {
+            throw GameException("File is too large to map.");
+        }
+
+        // Empty files can't be mapped, but they still exist
+        if (fileSize.QuadPart > 0)
+        {
+            mappedFile->Mapping = CreateFileMapping(mappedFile->File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappedFile->Mapping == nullptr)
+            {
+                throw GameException("CreateFileMapping() failed.", HRESULT_FROM_WIN32(GetLastError()));
+            }
+
+            mappedFile->View = reinterpret_cast<const byte*>(MapViewOfFile(mappedFile->Mapping, FILE_MAP_READ, 0, 0, 0));
+            if (mappedFile->View == nullptr)
+            {
+                throw GameException("MapViewOfFile() failed.", HRESULT_FROM_WIN32(GetLastError()));
+            }
+        }
+
+        file = FileData(mappedFile, mappedFile->View, fileSize.QuadPart);
+
+        return true;
+    }
+
+    std::wstring DirectoryFileSystem::FullPath(const std::string& path) const
+    {
+        std::wstring widePath(path.begin(), path.end());
+
+        return (mRootDirectory.empty() ? widePath : mRootDirectory + L"\\" + widePath);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "VirtualFileSystem.h"
+
+namespace Library
+{
+    // Loose files under a directory on disk. Files are memory-mapped rather than read, so the
+    // data handed out is the page cache itself; an empty root resolves against the current
+    // directory.
+    class DirectoryFileSystem : public FileSystemBackend
+    {
+    public:
+        DirectoryFileSystem(const std::wstring& rootDirectory);
+
+        virtual bool Exists(const std::string& path) const override;
+        virtual bool Open(const std::string& path, FileData& file) const override;
+
+        const std::wstring& RootDirectory() const;
+
+        static bool MapFile(const std::wstring& filename, FileData& file);
+
+    private:
+        DirectoryFileSystem();
+        DirectoryFileSystem(const DirectoryFileSystem& rhs);
+        DirectoryFileSystem& operator=(const DirectoryFileSystem& rhs);
+
+        std::wstring FullPath(const std::string& path) const;
+
+        std::wstring mRootDirectory;
+    };
+}
@@ -10,6 +10,8 @@
 #include "Utility.h"
 #include "ColorHelper.h"
 #include "Mesh.h"
+#include "EffectRegistry.h"
+#include "AssetLoader.h"
 
 namespace Library
 {
@@ -18,7 +20,7 @@ namespace Library
     DistortionMapping::DistortionMapping(Game& game, Camera& camera)
         : DrawableGameComponent(game, camera),
           mDistortionEffect(nullptr),  mDistortionMappingMaterial(nullptr), mDistortionPass(nullptr), mDistortionInputLayout(nullptr),
-		  mDistortionTechnique(DistortionTechniqueDisplacement), mSceneTexture(nullptr), mRenderTarget(nullptr), mFullScreenQuad(nullptr)
+		  mDistortionTechnique(DistortionTechniqueDisplacement), mSceneTexture(nullptr), mRenderTarget(nullptr), mFullScreenQuad(nullptr), mCompositePass(0)
     {		
     }
 
@@ -27,7 +29,6 @@ namespace Library
 		DeleteObject(mFullScreenQuad);
         DeleteObject(mRenderTarget);
 		DeleteObject(mDistortionMappingMaterial);
-		DeleteObject(mDistortionEffect);
     }
 
 	DistortionTechnique DistortionMapping::GetDistortionTechnique() const
@@ -39,7 +40,7 @@ namespace Library
 	{
 		mDistortionTechnique = distortionTechnique;
 		mDistortionPass = mDistortionMappingMaterial->CurrentTechnique()->Passes().at(0);
-        mDistortionInputLayout = mDistortionMappingMaterial->InputLayouts().at(mDistortionPass);
+        mDistortionInputLayout = mDistortionMappingMaterial->InputLayout(*mDistortionPass);
 	}
 
     ID3D11ShaderResourceView* DistortionMapping::SceneTexture()
@@ -57,26 +58,37 @@ namespace Library
 		return mDistortionMappingMaterial;
 	}
 
+    void DistortionMapping::RequestAssets(AssetLoader& assetLoader)
+    {
+        assetLoader.RequestEffect(L"Content\\Effects\\Distortion.cso");
+    }
+
     void DistortionMapping::Initialize()
     {
         SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-        mDistortionEffect = new Effect(*mGame);
-        mDistortionEffect->LoadCompiledEffect(L"Content\\Effects\\Distortion.cso");
+        EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+        assert(effectRegistry != nullptr);
+
+        mDistortionEffect = effectRegistry->CloneEffect(L"Content\\Effects\\Distortion.cso");
 
         mDistortionMappingMaterial = new DistortionMappingMaterial();
         mDistortionMappingMaterial->Initialize(*mDistortionEffect);
 		SetDistortionTechnique(mDistortionTechnique);
+		mCompositePass = mDistortionEffect->FindPass("distortion_composite", "p0");
 
         mRenderTarget = new FullScreenRenderTarget(*mGame);
 
 		mFullScreenQuad = new FullScreenQuad(*mGame, *mDistortionMappingMaterial);		
 		mFullScreenQuad->Initialize();
+
+		// The clone is ours alone and every lookup on it is done, so its reflection data can go
+		mDistortionEffect->Optimize();
     }
 
     void DistortionMapping::Draw(const GameTime& gameTime)
     {
-		mFullScreenQuad->SetActiveTechnique("distortion_composite", "p0");
+		mFullScreenQuad->SetActivePass(mCompositePass);
 		mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&DistortionMapping::UpdateDistortionCompositeMaterial, this));
 		mFullScreenQuad->Draw(gameTime);
 
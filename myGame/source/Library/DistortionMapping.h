@@ -2,11 +2,11 @@
 
 #include "Common.h"
 #include "DrawableGameComponent.h"
+#include "Pass.h"
 
 namespace Library
 {
 	class Effect;
-	class Pass;
 	class DistortionMappingMaterial;
 	class FullScreenRenderTarget;
 	class FullScreenQuad;
@@ -34,6 +34,7 @@ namespace Library
 
 		DistortionMappingMaterial* GetMaterial();
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;		
 		virtual void Draw(const GameTime& gameTime) override;
 
@@ -48,7 +49,7 @@ namespace Library
 
 		void UpdateDistortionCompositeMaterial();
 
-		Effect* mDistortionEffect;
+		std::shared_ptr<Effect> mDistortionEffect;
 		DistortionMappingMaterial* mDistortionMappingMaterial;
 		Pass* mDistortionPass;
 		ID3D11InputLayout* mDistortionInputLayout;
@@ -56,5 +57,6 @@ namespace Library
 		ID3D11ShaderResourceView* mSceneTexture;
 		FullScreenRenderTarget* mRenderTarget;
 		FullScreenQuad* mFullScreenQuad;
+		PassHandle mCompositePass;
 	};
 }
\ No newline at end of file
@@ -2,28 +2,23 @@
 #include "Game.h"
 #include "GameException.h"
 #include "Utility.h"
+#include "AssetLoader.h"
+#include "LoadProfiler.h"
 #include "D3Dcompiler.h"
 
 namespace Library
 {
     Effect::Effect(Game& game)
-        : mGame(game), mEffect(nullptr), mEffectDesc(), mTechniques(), mTechniquesByName(), mVariables(), mVariablesByName()
+        : mGame(game), mEffect(nullptr), mEffectDesc(), mArena(), mTechniques(), mPasses(), mVariables()
     {
     }
 
     Effect::~Effect()
     {
-        for (Technique* technique : mTechniques)
-        {
-            delete technique;
-        }
         mTechniques.clear();
-
-        for (Variable* variable : mVariables)
-        {
-            delete variable;
-        }
+        mPasses.clear();
         mVariables.clear();
+        mArena.Reset();
 
         ReleaseObject(mEffect);
     }
@@ -39,7 +34,12 @@ namespace Library
 
         ID3D10Blob* compiledShader = nullptr;
         ID3D10Blob* errorMessages = nullptr;
-        HRESULT hr = D3DCompileFromFile(filename.c_str(), nullptr, nullptr, nullptr, "fx_5_0", shaderFlags, 0, &compiledShader, &errorMessages);
+        HRESULT hr;
+        {
+            LoadProfileScope compileScope("Effect compile", filename);
+            hr = D3DCompileFromFile(filename.c_str(), nullptr, nullptr, nullptr, "fx_5_0", shaderFlags, 0, &compiledShader, &errorMessages);
+        }
+
         if (errorMessages != nullptr)
         {
             GameException ex((char*)errorMessages->GetBufferPointer(), hr);
@@ -53,6 +53,7 @@ namespace Library
             throw GameException("D3DX11CompileFromFile() failed.", hr);
         }
 
+        LoadProfileScope createScope("Effect create", filename);
         hr = D3DX11CreateEffectFromMemory(compiledShader->GetBufferPointer(), compiledShader->GetBufferSize(), NULL, direct3DDevice, effect);
         if (FAILED(hr))
         {
@@ -64,6 +65,8 @@ namespace Library
 
     void Effect::LoadCompiledEffect(ID3D11Device* direct3DDevice, ID3DX11Effect** effect, const std::wstring& filename)
     {
+        LoadProfileScope profileScope("Effect create", filename);
+
         std::vector<char> compiledShader;
         Utility::LoadBinaryFile(filename, compiledShader);
 
@@ -88,17 +91,10 @@ namespace Library
     {
         if (mEffect != nullptr)
         {
-            for (Technique* technique : mTechniques)
-            {
-                delete technique;
-            }
             mTechniques.clear();
-
-            for (Variable* variable : mVariables)
-            {
-                delete variable;
-            }
+            mPasses.clear();
             mVariables.clear();
+            mArena.Reset();
         }
 
         mEffect = effect;
@@ -115,30 +111,153 @@ namespace Library
         return mTechniques;
     }
 
-    const std::map<std::string, Technique*>& Effect::TechniquesByName() const
+    const std::vector<Pass*>& Effect::Passes() const
+    {
+        return mPasses;
+    }
+
+    UINT Effect::VariableCount() const
+    {
+        return mVariables.size();
+    }
+
+    TechniqueHandle Effect::FindTechnique(const std::string& techniqueName) const
+    {
+        for (Technique* technique : mTechniques)
+        {
+            if (technique->Name() == techniqueName)
+            {
+                return technique->Handle();
+            }
+        }
+
+        throw GameException(("Technique not found: " + techniqueName).c_str());
+    }
+
+    PassHandle Effect::FindPass(const std::string& techniqueName, const std::string& passName) const
+    {
+        return GetTechnique(FindTechnique(techniqueName)).GetPass(passName).Handle();
+    }
+
+    VariableHandle Effect::FindVariable(const std::string& variableName)
+    {
+        Variable* variable = VariableByName(variableName);
+        if (variable == nullptr)
+        {
+            throw GameException(("Variable not found: " + variableName).c_str());
+        }
+
+        return variable->Handle();
+    }
+
+    Variable* Effect::VariableByName(const std::string& variableName)
+    {
+        // Optimize() drops Effects11's name index; only the wrappers already created keep their names
+        if (IsOptimized())
+        {
+            for (Variable* variable : mVariables)
+            {
+                if (variable != nullptr && variable->Name() == variableName)
+                {
+                    return variable;
+                }
+            }
+
+            return nullptr;
+        }
+
+        ID3DX11EffectVariable* effectVariable = mEffect->GetVariableByHashedName(D3DX11EffectNameHash(variableName.c_str()), variableName.c_str());
+        if (effectVariable->IsValid() == false)
+        {
+            return nullptr;
+        }
+
+        return &GetVariable(VariableIndex(effectVariable));
+    }
+
+    // Effects11 hands out pointers into its array of globals, so the index follows from the address
+    VariableHandle Effect::VariableIndex(ID3DX11EffectVariable* effectVariable) const
+    {
+        const byte* first = reinterpret_cast<const byte*>(mEffect->GetVariableByIndex(0));
+        VariableHandle handle = 0;
+        if (mVariables.size() > 1)
+        {
+            ptrdiff_t stride = reinterpret_cast<const byte*>(mEffect->GetVariableByIndex(1)) - first;
+            handle = static_cast<VariableHandle>((reinterpret_cast<const byte*>(effectVariable) - first) / stride);
+        }
+
+        assert(handle < mVariables.size() && mEffect->GetVariableByIndex(handle) == effectVariable);
+
+        return handle;
+    }
+
+    Technique& Effect::GetTechnique(TechniqueHandle handle) const
     {
-        return mTechniquesByName;
+        assert(handle < mTechniques.size());
+        return *mTechniques[handle];
     }
 
-    const std::vector<Variable*>& Effect::Variables() const	
+    Pass& Effect::GetPass(PassHandle handle) const
     {
-        return mVariables;
+        assert(handle < mPasses.size());
+        return *mPasses[handle];
     }
 
-    const std::map<std::string, Variable*>& Effect::VariablesByName() const
+    Variable& Effect::GetVariable(VariableHandle handle)
     {
-        return mVariablesByName;
+        assert(handle < mVariables.size());
+
+        Variable*& variable = mVariables[handle];
+        if (variable == nullptr)
+        {
+            variable = mArena.Create<Variable>(*this, mEffect->GetVariableByIndex(handle), handle);
+        }
+
+        return *variable;
+    }
+
+    void Effect::Optimize()
+    {
+        HRESULT hr = mEffect->Optimize();
+        if (FAILED(hr))
+        {
+            throw GameException("ID3DX11Effect::Optimize() failed.", hr);
+        }
+    }
+
+    bool Effect::IsOptimized() const
+    {
+        return (mEffect != nullptr && mEffect->IsOptimized());
     }
 
     void Effect::CompileFromFile(const std::wstring& filename)
     {
+        LoadProfileScope profileScope("Effect load", filename);
         CompileEffectFromFile(mGame.Direct3DDevice(), &mEffect, filename);
         Initialize();
     }
 
     void Effect::LoadCompiledEffect(const std::wstring& filename)
     {
-        LoadCompiledEffect(mGame.Direct3DDevice(), &mEffect, filename);
+        LoadProfileScope profileScope("Effect load", filename);
+
+        // Use the bytes the asset loader already read when this effect was requested up front
+        std::vector<char> compiledShader;
+        AssetLoader* assetLoader = (AssetLoader*)mGame.Services().GetService(AssetLoader::TypeIdClass());
+        if (assetLoader != nullptr && assetLoader->GetFile(filename, compiledShader))
+        {
+            LoadProfileScope createScope("Effect create", filename);
+            HRESULT hr = D3DX11CreateEffectFromMemory(&compiledShader.front(), compiledShader.size(), NULL, mGame.Direct3DDevice(), &mEffect);
+            if (FAILED(hr))
+            {
+                throw GameException("D3DX11CreateEffectFromMemory() failed.", hr);
+            }
+        }
+        else
+        {
+            LoadCompiledEffect(mGame.Direct3DDevice(), &mEffect, filename);
+        }
+
         Initialize();
     }
 
@@ -150,18 +269,26 @@ namespace Library
             throw GameException("ID3DX11Effect::GetDesc() failed.", hr);
         }
         
+        // One block with room for every wrapper the effect can have, so the arena never grows
+        UINT passCount = 0;
         for (UINT i = 0; i < mEffectDesc.Techniques; i++)
         {
-            Technique* technique = new Technique(mGame, *this, mEffect->GetTechniqueByIndex(i));
-            mTechniques.push_back(technique);
-            mTechniquesByName.insert(std::pair<std::string, Technique*>(technique->Name(), technique));
+            D3DX11_TECHNIQUE_DESC techniqueDesc;
+            mEffect->GetTechniqueByIndex(i)->GetDesc(&techniqueDesc);
+            passCount += techniqueDesc.Passes;
         }
+        mArena.Reserve(Arena::SizeOf<Technique>(mEffectDesc.Techniques) + Arena::SizeOf<Pass>(passCount) + Arena::SizeOf<Variable>(mEffectDesc.GlobalVariables));
 
-        for (UINT i = 0; i < mEffectDesc.GlobalVariables; i++)
+        mTechniques.reserve(mEffectDesc.Techniques);
+        mPasses.reserve(passCount);
+        for (UINT i = 0; i < mEffectDesc.Techniques; i++)
         {
-            Variable* variable = new Variable(*this, mEffect->GetVariableByIndex(i));
-            mVariables.push_back(variable);
-            mVariablesByName.insert(std::pair<std::string, Variable*>(variable->Name(), variable));
+            Technique* technique = mArena.Create<Technique>(mGame, *this, mArena, mEffect->GetTechniqueByIndex(i), i, static_cast<PassHandle>(mPasses.size()));
+            mTechniques.push_back(technique);
+            mPasses.insert(mPasses.end(), technique->Passes().begin(), technique->Passes().end());
         }
+
+        // Most materials touch a few of their effect's variables; the rest are never wrapped
+        mVariables.assign(mEffectDesc.GlobalVariables, nullptr);
     }
 }
\ No newline at end of file
@@ -3,11 +3,14 @@
 #include "Common.h"
 #include "Technique.h"
 #include "Variable.h"
+#include "Arena.h"
 
 namespace Library
 {
     class Game;
 
+    // Wraps an ID3DX11Effect. The Technique and Pass wrappers are created when the effect is set,
+    // the Variable wrappers on first lookup; all of them live in one per-effect arena.
     class Effect
     {
     public:
@@ -22,9 +25,28 @@ namespace Library
         void SetEffect(ID3DX11Effect* effect);
         const D3DX11_EFFECT_DESC& EffectDesc() const;
         const std::vector<Technique*>& Techniques() const;
-        const std::map<std::string, Technique*>& TechniquesByName() const;
-        const std::vector<Variable*>& Variables() const;
-        const std::map<std::string, Variable*>& VariablesByName() const;
+        const std::vector<Pass*>& Passes() const;
+        UINT VariableCount() const;
+
+        // Name lookups for setup code; these throw if the name is not in the effect. Keep the handles
+        // and resolve them with the getters below when drawing, which only index flat vectors.
+        TechniqueHandle FindTechnique(const std::string& techniqueName) const;
+        PassHandle FindPass(const std::string& techniqueName, const std::string& passName) const;
+        VariableHandle FindVariable(const std::string& variableName);
+        // As FindVariable(), but nullptr if the effect has no such variable
+        Variable* VariableByName(const std::string& variableName);
+
+        Technique& GetTechnique(TechniqueHandle handle) const;
+        Pass& GetPass(PassHandle handle) const;
+        Variable& GetVariable(VariableHandle handle);
+
+        // Drops Effects11's reflection data (names, annotations, shader bytecode and input signatures)
+        // and repacks its type data. Call it once the materials using the effect have looked up their
+        // variables and created their input layouts, and never on an effect that will be cloned. The
+        // wrappers keep their names, so lookups of techniques, passes and variables already found
+        // still work; variables never looked up can no longer be found.
+        void Optimize();
+        bool IsOptimized() const;
 
         void CompileFromFile(const std::wstring& filename);
         void LoadCompiledEffect(const std::wstring& filename);
@@ -34,13 +56,15 @@ namespace Library
         Effect& operator=(const Effect& rhs);
 
         void Initialize();
+        VariableHandle VariableIndex(ID3DX11EffectVariable* effectVariable) const;
 
         Game& mGame;
         ID3DX11Effect* mEffect;
         D3DX11_EFFECT_DESC mEffectDesc;
+        Arena mArena;
         std::vector<Technique*> mTechniques;
-        std::map<std::string, Technique*> mTechniquesByName;		
+        std::vector<Pass*> mPasses;
+        // Indexed by VariableHandle; nullptr until the variable is first looked up
         std::vector<Variable*> mVariables;
-        std::map<std::string, Variable*> mVariablesByName;
     };
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "EffectPermutations.h"
+#include "Effect.h"
+#include "GameException.h"
+
+namespace Library
+{
+    const PassHandle EffectPermutations::InvalidPass = UINT_MAX;
+
+    EffectPermutations::EffectPermutations()
+        : mPasses()
+    {
+    }
+
+    void EffectPermutations::Initialize(const Effect& effect, const EffectPermutation* permutations, UINT permutationEntryCount, UINT permutationCount, const std::string& passName)
+    {
+        mPasses.assign(permutationCount, InvalidPass);
+
+        for (UINT i = 0; i < permutationEntryCount; i++)
+        {
+            const EffectPermutation& permutation = permutations[i];
+            if (permutation.Permutation >= permutationCount || mPasses[permutation.Permutation] != InvalidPass)
+            {
+                throw GameException((std::string("Invalid or duplicate permutation: ") + permutation.TechniqueName).c_str());
+            }
+
+            mPasses[permutation.Permutation] = effect.FindPass(permutation.TechniqueName, passName);
+        }
+    }
+
+    bool EffectPermutations::Contains(UINT permutation) const
+    {
+        return (permutation < mPasses.size() && mPasses[permutation] != InvalidPass);
+    }
+
+    PassHandle EffectPermutations::operator[](UINT permutation) const
+    {
+        assert(Contains(permutation));
+
+        return mPasses[permutation];
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Common.h"
+#include "Pass.h"
+
+namespace Library
+{
+    class Effect;
+
+    // One technique an effect generates from its permutation list, and the feature bitmask it was compiled for
+    typedef struct _EffectPermutation
+    {
+        const char* TechniqueName;
+        UINT Permutation;
+    } EffectPermutation;
+
+    // Passes of an effect's permutations, indexed by bitmask. The .fx generates its techniques from a
+    // preprocessor list it shares with the C++ side (e.g. Content\Effects\include\ShadowMappingPermutations.fxh),
+    // which expands the same list into EffectPermutation entries for Initialize(). Selecting a permutation
+    // while drawing is then one array index; a bitmask the list does not contain has no pass.
+    class EffectPermutations
+    {
+    public:
+        EffectPermutations();
+
+        // permutationCount bounds the bitmasks (one past the highest); throws if a technique is missing
+        // from the effect or two entries share a bitmask
+        void Initialize(const Effect& effect, const EffectPermutation* permutations, UINT permutationEntryCount, UINT permutationCount, const std::string& passName = "p0");
+
+        bool Contains(UINT permutation) const;
+        PassHandle operator[](UINT permutation) const;
+
+    private:
+        EffectPermutations(const EffectPermutations& rhs);
+        EffectPermutations& operator=(const EffectPermutations& rhs);
+
+        static const PassHandle InvalidPass;
+
+        std::vector<PassHandle> mPasses;
+    };
+}
@@ -0,0 +1,337 @@
+#include "EffectRegistry.h"
+#include "Effect.h"
+#include "Game.h"
+#include "GameException.h"
+#include "AssetLoader.h"
+#include "LoadProfiler.h"
+#include "FrameConstants.h"
+#include "Utility.h"
+#include <sstream>
+#include <algorithm>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(EffectRegistry)
+
+    EffectRegistry::EffectRegistry(Game& game)
+        : mGame(game), mEffects(), mPendingEffects(), mLoadCounts()
+    {
+    }
+
+    EffectRegistry::~EffectRegistry()
+    {
+        Clear();
+    }
+
+    std::shared_ptr<Effect> EffectRegistry::GetEffect(const std::wstring& filename)
+    {
+        return FindOrLoad(filename).Original;
+    }
+
+    std::shared_ptr<Effect> EffectRegistry::CloneEffect(const std::wstring& filename)
+    {
+        EffectRegistryEntry& entry = FindOrLoad(filename);
+
+        ID3DX11Effect* clonedEffect = nullptr;
+        HRESULT hr = entry.Original->GetEffect()->CloneEffect(0, &clonedEffect);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3DX11Effect::CloneEffect() failed.", hr);
+        }
+
+        std::shared_ptr<Effect> effect = std::make_shared<Effect>(mGame);
+        effect->SetEffect(clonedEffect);
+        BindFrameConstants(GetFrameConstants(), *effect);
+
+        entry.Clones.erase(std::remove_if(entry.Clones.begin(), entry.Clones.end(), [](const std::weak_ptr<Effect>& clone) { return clone.expired(); }), entry.Clones.end());
+        entry.Clones.push_back(effect);
+
+        return effect;
+    }
+
+    std::shared_future<std::shared_ptr<Effect>> EffectRegistry::LoadEffectAsync(const std::wstring& filename)
+    {
+        std::wstring key = EffectKey(filename);
+
+        std::map<std::wstring, PendingEffect>::iterator pendingIt = mPendingEffects.find(key);
+        if (pendingIt != mPendingEffects.end())
+        {
+            return pendingIt->second.Handle;
+        }
+
+        std::map<std::wstring, EffectRegistryEntry>::iterator it = mEffects.find(key);
+        if (it != mEffects.end())
+        {
+            std::promise<std::shared_ptr<Effect>> loadedEffect;
+            loadedEffect.set_value(it->second.Original);
+
+            return loadedEffect.get_future().share();
+        }
+
+        // The services and the asset loader's files are only looked at here, on the main thread
+        std::shared_ptr<std::vector<char>> compiledEffect = std::make_shared<std::vector<char>>();
+        GetPreloadedFile(filename, *compiledEffect);
+        FrameConstants* frameConstants = GetFrameConstants();
+        mLoadCounts[key]++;
+
+        PendingEffect pendingEffect;
+        pendingEffect.Entry = std::make_shared<EffectRegistryEntry>();
+
+        std::shared_ptr<EffectRegistryEntry> entry = pendingEffect.Entry;
+        std::string component = LoadProfiler::CurrentComponent();
+        pendingEffect.Handle = std::async(std::launch::async, [this, filename, compiledEffect, frameConstants, entry, component]()
+        {
+            LoadProfileComponent profileComponent(component);
+            LoadEntry(filename, *compiledEffect, frameConstants, *entry);
+
+            return entry->Original;
+        }).share();
+
+        return mPendingEffects.insert(std::pair<std::wstring, PendingEffect>(key, pendingEffect)).first->second.Handle;
+    }
+
+    void EffectRegistry::Wait()
+    {
+        std::exception_ptr error;
+        while (mPendingEffects.empty() == false)
+        {
+            try
+            {
+                AdoptPendingEffect(mPendingEffects.begin());
+            }
+            catch (...)
+            {
+                if (error == nullptr)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    UINT EffectRegistry::EffectCount() const
+    {
+        return mEffects.size();
+    }
+
+    UINT EffectRegistry::SharedCount() const
+    {
+        UINT count = 0;
+        for (const std::pair<const std::wstring, EffectRegistryEntry>& effect : mEffects)
+        {
+            count += SharedCount(effect.second);
+        }
+
+        return count;
+    }
+
+    UINT EffectRegistry::CloneCount() const
+    {
+        UINT count = 0;
+        for (const std::pair<const std::wstring, EffectRegistryEntry>& effect : mEffects)
+        {
+            count += CloneCount(effect.second);
+        }
+
+        return count;
+    }
+
+    std::vector<std::wstring> EffectRegistry::Filenames() const
+    {
+        std::vector<std::wstring> filenames;
+        filenames.reserve(mEffects.size());
+        for (const std::pair<const std::wstring, EffectRegistryEntry>& effect : mEffects)
+        {
+            filenames.push_back(effect.first);
+        }
+
+        return filenames;
+    }
+
+    // Compiled bytecode once per file plus a set of constant buffers for the original and each clone
+    UINT64 EffectRegistry::MemoryUsage() const
+    {
+        UINT64 size = 0;
+        for (const std::pair<const std::wstring, EffectRegistryEntry>& effect : mEffects)
+        {
+            const EffectRegistryEntry& entry = effect.second;
+            size += entry.CompiledSize + entry.ConstantBufferSize * (1 + CloneCount(entry));
+        }
+
+        return size;
+    }
+
+    void EffectRegistry::ReportUsage() const
+    {
+        std::wostringstream report;
+        report << L"Effects: " << mEffects.size() << L" (" << SharedCount() << L" shared users, " << CloneCount() << L" clones), " << (MemoryUsage() / 1024) << L" KB" << std::endl;
+        for (const std::pair<const std::wstring, EffectRegistryEntry>& effect : mEffects)
+        {
+            const EffectRegistryEntry& entry = effect.second;
+            report << L"    " << effect.first << L": " << mLoadCounts.at(effect.first) << L" loads, " << SharedCount(entry) << L" shared, " << CloneCount(entry) << L" clones, "
+                   << (entry.CompiledSize / 1024) << L" KB compiled, " << entry.ConstantBufferSize << L" bytes of constant buffers per instance" << std::endl;
+        }
+
+        OutputDebugString(report.str().c_str());
+    }
+
+    // Drops the effects nothing holds any more
+    void EffectRegistry::Trim()
+    {
+        std::map<std::wstring, EffectRegistryEntry>::iterator it = mEffects.begin();
+        while (it != mEffects.end())
+        {
+            if (SharedCount(it->second) == 0 && CloneCount(it->second) == 0)
+            {
+                it = mEffects.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void EffectRegistry::Clear()
+    {
+        // The workers write into the pending entries and use the device until they finish
+        for (std::pair<const std::wstring, PendingEffect>& pendingEffect : mPendingEffects)
+        {
+            pendingEffect.second.Handle.wait();
+        }
+
+        mPendingEffects.clear();
+        mEffects.clear();
+    }
+
+    std::wstring EffectRegistry::EffectKey(const std::wstring& filename)
+    {
+        std::wstring key;
+        Utility::NormalizePath(filename, key);
+
+        return key;
+    }
+
+    UINT EffectRegistry::SharedCount(const EffectRegistryEntry& entry)
+    {
+        // Less the registry's own reference
+        return static_cast<UINT>(entry.Original.use_count() - 1);
+    }
+
+    UINT EffectRegistry::CloneCount(const EffectRegistryEntry& entry)
+    {
+        UINT count = 0;
+        for (const std::weak_ptr<Effect>& clone : entry.Clones)
+        {
+            if (clone.expired() == false)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    void EffectRegistry::BindFrameConstants(FrameConstants* frameConstants, Effect& effect)
+    {
+        if (frameConstants != nullptr)
+        {
+            frameConstants->Bind(effect);
+        }
+    }
+
+    FrameConstants* EffectRegistry::GetFrameConstants() const
+    {
+        return (FrameConstants*)mGame.Services().GetService(FrameConstants::TypeIdClass());
+    }
+
+    // The bytes the asset loader already read when this effect was requested up front, if any
+    bool EffectRegistry::GetPreloadedFile(const std::wstring& filename, std::vector<char>& compiledEffect) const
+    {
+        AssetLoader* assetLoader = (AssetLoader*)mGame.Services().GetService(AssetLoader::TypeIdClass());
+
+        return (assetLoader != nullptr && assetLoader->GetFile(filename, compiledEffect));
+    }
+
+    // Runs on the main thread for GetEffect()/CloneEffect() and on a worker for LoadEffectAsync(), so
+    // it touches nothing but the file, the device and the new effect
+    void EffectRegistry::LoadEntry(const std::wstring& filename, std::vector<char>& compiledEffect, FrameConstants* frameConstants, EffectRegistryEntry& entry) const
+    {
+        LoadProfileScope profileScope("Effect load", filename);
+
+        if (compiledEffect.empty())
+        {
+            Utility::LoadBinaryFile(filename, compiledEffect);
+        }
+
+        ID3DX11Effect* d3dEffect = nullptr;
+        {
+            LoadProfileScope createScope("Effect create", filename);
+            HRESULT hr = D3DX11CreateEffectFromMemory(&compiledEffect.front(), compiledEffect.size(), NULL, mGame.Direct3DDevice(), &d3dEffect);
+            if (FAILED(hr))
+            {
+                throw GameException("D3DX11CreateEffectFromMemory() failed.", hr);
+            }
+        }
+
+        entry.Original = std::make_shared<Effect>(mGame);
+        entry.Original->SetEffect(d3dEffect);
+        BindFrameConstants(frameConstants, *entry.Original);
+        entry.CompiledSize = compiledEffect.size();
+        entry.ConstantBufferSize = 0;
+
+        const D3DX11_EFFECT_DESC& effectDesc = entry.Original->EffectDesc();
+        for (UINT i = 0; i < effectDesc.ConstantBuffers; i++)
+        {
+            D3DX11_EFFECT_TYPE_DESC typeDesc;
+            if (SUCCEEDED(d3dEffect->GetConstantBufferByIndex(i)->GetType()->GetDesc(&typeDesc)))
+            {
+                entry.ConstantBufferSize += typeDesc.UnpackedSize;
+            }
+        }
+    }
+
+    // Waits for the worker and moves its entry into the registry. A failed load is dropped, so asking
+    // for the file again reads it again.
+    EffectRegistry::EffectRegistryEntry& EffectRegistry::AdoptPendingEffect(std::map<std::wstring, PendingEffect>::iterator it)
+    {
+        std::wstring key = it->first;
+        PendingEffect pendingEffect = it->second;
+        mPendingEffects.erase(it);
+
+        pendingEffect.Handle.get();
+
+        return mEffects.insert(std::pair<std::wstring, EffectRegistryEntry>(key, *pendingEffect.Entry)).first->second;
+    }
+
+    EffectRegistry::EffectRegistryEntry& EffectRegistry::FindOrLoad(const std::wstring& filename)
+    {
+        std::wstring key = EffectKey(filename);
+
+        std::map<std::wstring, EffectRegistryEntry>::iterator it = mEffects.find(key);
+        if (it != mEffects.end())
+        {
+            return it->second;
+        }
+
+        std::map<std::wstring, PendingEffect>::iterator pendingIt = mPendingEffects.find(key);
+        if (pendingIt != mPendingEffects.end())
+        {
+            return AdoptPendingEffect(pendingIt);
+        }
+
+        std::vector<char> compiledEffect;
+        GetPreloadedFile(filename, compiledEffect);
+        mLoadCounts[key]++;
+
+        EffectRegistryEntry entry;
+        LoadEntry(filename, compiledEffect, GetFrameConstants(), entry);
+
+        return mEffects.insert(std::pair<std::wstring, EffectRegistryEntry>(key, entry)).first->second;
+    }
+}
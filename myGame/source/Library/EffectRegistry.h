@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Common.h"
+#include <future>
+
+namespace Library
+{
+    class Game;
+    class Effect;
+    class FrameConstants;
+
+    // Process-wide registry of compiled effects (.cso). Each file is read and parsed once; callers
+    // then either share that Effect, when they set every variable they use before each Apply(), or
+    // get a clone of it (ID3DX11Effect::CloneEffect). A clone has its own variable values and
+    // constant buffers but shares the shaders, state blocks and reflection data with the original.
+    // Both have their CBufferFrameConstants, if any, pointed at the shared FrameConstants buffer.
+    //
+    // Effects are handed out as shared_ptrs; the registry keeps the parsed original until Trim()
+    // finds that nothing uses it or its clones any more, or until Clear().
+    //
+    // LoadEffectAsync() reads and parses the file on a worker thread instead (the device is
+    // free-threaded) and returns a handle to wait on. The registry takes the effect in on the main
+    // thread when GetEffect()/CloneEffect() asks for that file or Wait() is called.
+    class EffectRegistry : public RTTI
+    {
+        RTTI_DECLARATIONS(EffectRegistry, RTTI)
+
+    public:
+        EffectRegistry(Game& game);
+        ~EffectRegistry();
+
+        std::shared_ptr<Effect> GetEffect(const std::wstring& filename);
+        std::shared_ptr<Effect> CloneEffect(const std::wstring& filename);
+
+        // Returns at once; get() waits for the load and rethrows its failure. Files already loaded
+        // or loading get the same effect.
+        std::shared_future<std::shared_ptr<Effect>> LoadEffectAsync(const std::wstring& filename);
+        // Adopts every load in flight, rethrowing the first failure once all have finished
+        void Wait();
+
+        UINT EffectCount() const;
+        UINT SharedCount() const;
+        UINT CloneCount() const;
+        // Normalized filenames of the effects held
+        std::vector<std::wstring> Filenames() const;
+        UINT64 MemoryUsage() const;
+
+        void ReportUsage() const;
+        void Trim();
+        void Clear();
+
+    private:
+        EffectRegistry();
+        EffectRegistry(const EffectRegistry& rhs);
+        EffectRegistry& operator=(const EffectRegistry& rhs);
+
+        typedef struct _EffectRegistryEntry
+        {
+            std::shared_ptr<Effect> Original;
+            std::vector<std::weak_ptr<Effect>> Clones;
+            UINT64 CompiledSize;
+            UINT64 ConstantBufferSize;
+        } EffectRegistryEntry;
+
+        // The worker fills Entry; the main thread reads it only once Handle is ready
+        typedef struct _PendingEffect
+        {
+            std::shared_future<std::shared_ptr<Effect>> Handle;
+            std::shared_ptr<EffectRegistryEntry> Entry;
+        } PendingEffect;
+
+        static std::wstring EffectKey(const std::wstring& filename);
+        static UINT SharedCount(const EffectRegistryEntry& entry);
+        static UINT CloneCount(const EffectRegistryEntry& entry);
+
+        static void BindFrameConstants(FrameConstants* frameConstants, Effect& effect);
+
+        FrameConstants* GetFrameConstants() const;
+        bool GetPreloadedFile(const std::wstring& filename, std::vector<char>& compiledEffect) const;
+        void LoadEntry(const std::wstring& filename, std::vector<char>& compiledEffect, FrameConstants* frameConstants, EffectRegistryEntry& entry) const;
+        EffectRegistryEntry& AdoptPendingEffect(std::map<std::wstring, PendingEffect>::iterator it);
+        EffectRegistryEntry& FindOrLoad(const std::wstring& filename);
+
+        Game& mGame;
+        std::map<std::wstring, EffectRegistryEntry> mEffects;
+        std::map<std::wstring, PendingEffect> mPendingEffects;
+        std::map<std::wstring, UINT> mLoadCounts;
+    };
+}
@@ -5,6 +5,7 @@
 #include <SpriteFont.h>
 #include "Game.h"
 #include "Utility.h"
+#include "SpriteFontLoader.h"
 #include <string>
 
 namespace Library
@@ -38,7 +39,7 @@ namespace Library
         SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
         mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
-        mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
+        mSpriteFont = SpriteFontLoader::CreateSpriteFont(mGame->Direct3DDevice(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
     }
 
     void FpsComponent::Update(const GameTime& gameTime)
@@ -0,0 +1,103 @@
+#include "FrameConstants.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Effect.h"
+
+namespace Library
+{
+    RTTI_DEFINITIONS(FrameConstants)
+
+    const std::string FrameConstants::ConstantBufferName = "CBufferFrameConstants";
+    const uint32_t FrameConstants::ConstantBufferNameHash = D3DX11EffectNameHash("CBufferFrameConstants");
+
+    FrameConstants::FrameConstants(Game& game)
+        : mGame(game), mData(), mConstantBuffer(nullptr), mDirty(true), mCommitCount(0)
+    {
+        static_assert(sizeof(FrameConstantsData) % 16 == 0, "Constant buffers are a whole number of 16-byte registers.");
+
+        D3D11_BUFFER_DESC constantBufferDesc;
+        ZeroMemory(&constantBufferDesc, sizeof(constantBufferDesc));
+        constantBufferDesc.ByteWidth = sizeof(FrameConstantsData);
+        constantBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+        HRESULT hr = mGame.Direct3DDevice()->CreateBuffer(&constantBufferDesc, nullptr, &mConstantBuffer);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3D11Device::CreateBuffer() failed.", hr);
+        }
+    }
+
+    FrameConstants::~FrameConstants()
+    {
+        ReleaseObject(mConstantBuffer);
+    }
+
+    const FrameConstantsData& FrameConstants::Data() const
+    {
+        return mData;
+    }
+
+    ID3D11Buffer* FrameConstants::ConstantBuffer() const
+    {
+        return mConstantBuffer;
+    }
+
+    void FrameConstants::SetAmbientColor(FXMVECTOR color)
+    {
+        XMStoreFloat4(&mData.AmbientColor, color);
+        mDirty = true;
+    }
+
+    void FrameConstants::SetLight(FXMVECTOR color, FXMVECTOR position, float radius)
+    {
+        XMStoreFloat4(&mData.LightColor, color);
+        XMStoreFloat3(&mData.LightPosition, position);
+        mData.LightRadius = radius;
+        mDirty = true;
+    }
+
+    void FrameConstants::SetCameraPosition(FXMVECTOR position)
+    {
+        XMStoreFloat3(&mData.CameraPosition, position);
+        mDirty = true;
+    }
+
+    void FrameConstants::SetShadowMapSize(float width, float height)
+    {
+        mData.ShadowMapSize = XMFLOAT2(width, height);
+        mDirty = true;
+    }
+
+    void FrameConstants::Bind(Effect& effect)
+    {
+        ID3DX11EffectConstantBuffer* constantBuffer = effect.GetEffect()->GetConstantBufferByHashedName(ConstantBufferNameHash, ConstantBufferName.c_str());
+        if (constantBuffer->IsValid() == false)
+        {
+            return;
+        }
+
+        HRESULT hr = constantBuffer->SetConstantBuffer(mConstantBuffer);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3DX11EffectConstantBuffer::SetConstantBuffer() failed.", hr);
+        }
+    }
+
+    void FrameConstants::Commit()
+    {
+        if (mDirty == false)
+        {
+            return;
+        }
+
+        mGame.Direct3DDeviceContext()->UpdateSubresource(mConstantBuffer, 0, nullptr, &mData, 0, 0);
+        mDirty = false;
+        mCommitCount++;
+    }
+
+    UINT FrameConstants::CommitCount() const
+    {
+        return mCommitCount;
+    }
+}
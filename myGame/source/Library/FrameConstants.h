@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    class Game;
+    class Effect;
+
+    // Mirrors CBufferFrameConstants in Content\Effects\include\FrameConstants.fxh, including the
+    // HLSL packing (a vector never straddles a 16-byte register).
+    typedef struct _FrameConstantsData
+    {
+        XMFLOAT4 AmbientColor;
+        XMFLOAT4 LightColor;
+        XMFLOAT3 LightPosition;
+        float LightRadius;
+        XMFLOAT3 CameraPosition;
+        float Padding;
+        XMFLOAT2 ShadowMapSize;
+        XMFLOAT2 Padding2;
+
+        _FrameConstantsData()
+            : AmbientColor(1.0f, 1.0f, 1.0f, 0.0f), LightColor(1.0f, 1.0f, 1.0f, 1.0f), LightPosition(0.0f, 0.0f, 0.0f), LightRadius(10.0f),
+              CameraPosition(0.0f, 0.0f, 0.0f), Padding(0.0f), ShadowMapSize(1024.0f, 1024.0f), Padding2(0.0f, 0.0f)
+        {
+        }
+    } FrameConstantsData;
+
+    // Per-frame values (camera, light, ambient colour, shadow map size) shared by every effect.
+    // They live in a single constant buffer that replaces each effect's CBufferFrameConstants, so
+    // Pass::Apply() binds it at slot b0 without uploading anything; the scene fills in the values
+    // once and Commit() uploads them once per frame. Materials only update their per-object data.
+    class FrameConstants : public RTTI
+    {
+        RTTI_DECLARATIONS(FrameConstants, RTTI)
+
+    public:
+        static const std::string ConstantBufferName;
+        // D3DX11EffectNameHash of ConstantBufferName, computed at compile time
+        static const uint32_t ConstantBufferNameHash;
+
+        FrameConstants(Game& game);
+        ~FrameConstants();
+
+        const FrameConstantsData& Data() const;
+        ID3D11Buffer* ConstantBuffer() const;
+
+        void SetAmbientColor(FXMVECTOR color);
+        void SetLight(FXMVECTOR color, FXMVECTOR position, float radius);
+        void SetCameraPosition(FXMVECTOR position);
+        void SetShadowMapSize(float width, float height);
+
+        // Points the effect's CBufferFrameConstants, if it declares one, at the shared buffer
+        void Bind(Effect& effect);
+
+        // Uploads the values if they changed since the last commit
+        void Commit();
+        UINT CommitCount() const;
+
+    private:
+        FrameConstants();
+        FrameConstants(const FrameConstants& rhs);
+        FrameConstants& operator=(const FrameConstants& rhs);
+
+        Game& mGame;
+        FrameConstantsData mData;
+        ID3D11Buffer* mConstantBuffer;
+        bool mDirty;
+        UINT mCommitCount;
+    };
+}
@@ -39,14 +39,22 @@ namespace Library
         SetActiveTechnique(techniqueName, passName);
     }
 
+    void FullScreenQuad::SetMaterial(Material& material, PassHandle pass)
+    {
+        mMaterial = &material;
+        SetActivePass(pass);
+    }
+
     void FullScreenQuad::SetActiveTechnique(const std::string& techniqueName, const std::string& passName)
     {
-        Technique* technique = mMaterial->GetEffect()->TechniquesByName().at(techniqueName);
-        assert(technique != nullptr);
-        
-        mPass = technique->PassesByName().at(passName);
-        assert(mPass != nullptr);
-        mInputLayout = mMaterial->InputLayouts().at(mPass);
+        SetActivePass(mMaterial->GetEffect()->FindPass(techniqueName, passName));
+    }
+
+    void FullScreenQuad::SetActivePass(PassHandle pass)
+    {
+        mPass = &mMaterial->GetEffect()->GetPass(pass);
+        mInputLayout = mMaterial->InputLayout(pass);
+        assert(mInputLayout != nullptr);
     }
 
     void FullScreenQuad::SetCustomUpdateMaterial(std::function<void()> callback)
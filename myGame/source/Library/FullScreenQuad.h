@@ -2,12 +2,12 @@
 
 #include <functional>
 #include "DrawableGameComponent.h"
+#include "Pass.h"
 
 namespace Library
 {
 	class Effect;
     class Material;
-	class Pass;
 	
     class FullScreenQuad : public DrawableGameComponent
     {
@@ -20,7 +20,10 @@ namespace Library
 
 		Material* GetMaterial();
         void SetMaterial(Material& material, const std::string& techniqueName, const std::string& passName);
+        void SetMaterial(Material& material, PassHandle pass);
 		void SetActiveTechnique(const std::string& techniqueName, const std::string& passName);
+		// Per-frame switching; look the handle up once with Effect::FindPass()
+		void SetActivePass(PassHandle pass);
 		void SetCustomUpdateMaterial(std::function<void()> callback);
 
         virtual void Initialize() override;
@@ -1,6 +1,12 @@
 #include "Game.h"
 #include "DrawableGameComponent.h"
 #include "GameException.h"
+#include "AssetLoader.h"
+#include "Utility.h"
+#include "LoadProfiler.h"
+#include <chrono>
+#include <sstream>
+#include <typeinfo>
 
 namespace Library
 {
@@ -139,8 +145,13 @@ namespace Library
         
     void Game::Run()
     {
+        std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+        bool firstFrame = true;
+
         InitializeWindow();
         InitializeDirectX();
+
+        LoadProfiler::Begin();
         Initialize();
 
         MSG message;
@@ -160,6 +171,14 @@ namespace Library
                 mGameClock.UpdateGameTime(mGameTime);
                 Update(mGameTime);
                 Draw(mGameTime);
+
+                if (firstFrame)
+                {
+                    std::wostringstream timeToFirstFrame;
+                    timeToFirstFrame << L"Time to first frame: " << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() << L" ms\n";
+                    OutputDebugString(timeToFirstFrame.str().c_str());
+                    firstFrame = false;
+                }
             }
         }
 
@@ -191,26 +210,41 @@ namespace Library
 
     void Game::Initialize()
     {
-        for (GameComponent* component : commonComponents)
-        {
-            component->Initialize();
-        }
-        for (GameComponent* component : gameComponents)
-        {
-            component->Initialize();
-        }
-        for (GameComponent* component : menuComponents)
-        {
-            component->Initialize();
-        }
-        for (GameComponent* component : credentialsComponents)
+        std::vector<GameComponent*> components;
+        components.insert(components.end(), commonComponents.begin(), commonComponents.end());
+        components.insert(components.end(), gameComponents.begin(), gameComponents.end());
+        components.insert(components.end(), menuComponents.begin(), menuComponents.end());
+        components.insert(components.end(), credentialsComponents.begin(), credentialsComponents.end());
+        components.insert(components.end(), endComponents.begin(), endComponents.end());
+
+        // Let every component queue its asset loads first, then join them before initializing
+        AssetLoader* assetLoader = (AssetLoader*)mServices.GetService(AssetLoader::TypeIdClass());
+        if (assetLoader != nullptr)
         {
-            component->Initialize();
+            // Workers resolve content paths the same way the components do
+            SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
+
+            for (GameComponent* component : components)
+            {
+                LoadProfileComponent profileComponent(ComponentName(*component));
+                component->RequestAssets(*assetLoader);
+            }
+
+            LoadProfileScope profileScope("Asset preload wait", "");
+            assetLoader->Wait();
         }
-        for (GameComponent* component : endComponents)
+
+        for (GameComponent* component : components)
         {
+            std::string componentName = ComponentName(*component);
+            LoadProfileComponent profileComponent(componentName);
+            LoadProfileScope profileScope("Component initialize", componentName);
+
             component->Initialize();
         }
+
+        LoadProfiler::End();
+        LoadProfiler::WriteReport();
     }
 
     void Game::Update(const GameTime& gameTime)
@@ -482,4 +516,13 @@ namespace Library
 
         return center;
     }	
+
+    // "class Library::ModelFromFile" -> "ModelFromFile", for the load profile
+    std::string Game::ComponentName(const GameComponent& component)
+    {
+        std::string name = typeid(component).name();
+        std::string::size_type separator = name.find_last_of(": ");
+
+        return (separator != std::string::npos ? name.substr(separator + 1) : name);
+    }
 }
\ No newline at end of file
@@ -112,6 +112,7 @@ namespace Library
         Game& operator=(const Game& rhs);
 
         POINT CenterWindow(int windowWidth, int windowHeight);
+        static std::string ComponentName(const GameComponent& component);
         static LRESULT WINAPI WndProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam);		
     };
 }
\ No newline at end of file
@@ -39,6 +39,10 @@ namespace Library
         mEnabled = enabled;
     }
 
+    void GameComponent::RequestAssets(AssetLoader& assetLoader)
+    {
+    }
+
     void GameComponent::Initialize()
     {
     }
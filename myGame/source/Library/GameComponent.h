@@ -6,6 +6,7 @@ namespace Library
 {
     class Game;
     class GameTime;
+    class AssetLoader;
 
     class GameComponent : public RTTI
     {
@@ -21,6 +22,8 @@ namespace Library
         bool Enabled() const;
         void SetEnabled(bool enabled);
 
+        // Called before Initialize so the assets it will load can be fetched in parallel
+        virtual void RequestAssets(AssetLoader& assetLoader);
         virtual void Initialize();
         virtual void Update(const GameTime& gameTime);
 
@@ -9,6 +9,8 @@
 #include "MatrixHelper.h"
 #include "Utility.h"
 #include "ColorHelper.h"
+#include "EffectRegistry.h"
+#include "AssetLoader.h"
 
 namespace Library
 {
@@ -18,14 +20,14 @@ namespace Library
 
     GaussianBlur::GaussianBlur(Game& game, Camera& camera)
         : DrawableGameComponent(game, camera),
-          mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr),
+          mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr), mBlurPass(0), mNoBlurPass(0),
           mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(DefaultBlurAmount)
     {
     }
 
     GaussianBlur::GaussianBlur(Game& game, Camera& camera, float blurAmount)
         : DrawableGameComponent(game, camera),
-          mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr),
+          mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr), mBlurPass(0), mNoBlurPass(0),
           mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(blurAmount)
     {
     }
@@ -36,7 +38,6 @@ namespace Library
         DeleteObject(mVerticalBlurTarget);
 		DeleteObject(mHorizontalBlurTarget);        
         DeleteObject(mMaterial);
-        DeleteObject(mEffect);
     }
 
     ID3D11ShaderResourceView* GaussianBlur::SceneTexture()
@@ -65,19 +66,32 @@ namespace Library
         InitializeSampleWeights();
     }
 
+    void GaussianBlur::RequestAssets(AssetLoader& assetLoader)
+    {
+        assetLoader.RequestEffect(L"Content\\Effects\\GaussianBlur.cso");
+    }
+
     void GaussianBlur::Initialize()
     {
         SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-        mEffect = new Effect(*mGame);
-        mEffect->LoadCompiledEffect(L"Content\\Effects\\GaussianBlur.cso");
+        EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+        assert(effectRegistry != nullptr);
+
+        // Blurs can be nested in other post-processing passes, so each one works on its own copy
+        mEffect = effectRegistry->CloneEffect(L"Content\\Effects\\GaussianBlur.cso");
 
         mMaterial = new GaussianBlurMaterial();
         mMaterial->Initialize(*mEffect);
+        mBlurPass = mEffect->FindPass("blur", "p0");
+        mNoBlurPass = mEffect->FindPass("no_blur", "p0");
 
         mFullScreenQuad = new FullScreenQuad(*mGame, *mMaterial);
         mFullScreenQuad->Initialize();        
 
+        // The clone is ours alone and every lookup on it is done, so its reflection data can go
+        mEffect->Optimize();
+
         InitializeSampleWeights();
         InitializeSampleOffsets();
 
@@ -95,7 +109,7 @@ namespace Library
             mHorizontalBlurTarget->Begin();
             mGame->Direct3DDeviceContext()->ClearRenderTargetView(mHorizontalBlurTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
             mGame->Direct3DDeviceContext()->ClearDepthStencilView(mHorizontalBlurTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-			mFullScreenQuad->SetActiveTechnique("blur", "p0");
+			mFullScreenQuad->SetActivePass(mBlurPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithHorizontalOffsets, this));
             mFullScreenQuad->Draw(gameTime);
             mHorizontalBlurTarget->End();
@@ -106,7 +120,7 @@ namespace Library
         }
         else
         {
-			mFullScreenQuad->SetActiveTechnique("no_blur", "p0");
+			mFullScreenQuad->SetActivePass(mNoBlurPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialNoBlur, this));
             mFullScreenQuad->Draw(gameTime);
         }
@@ -120,7 +134,7 @@ namespace Library
             mHorizontalBlurTarget->Begin();
             mGame->Direct3DDeviceContext()->ClearRenderTargetView(mHorizontalBlurTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
             mGame->Direct3DDeviceContext()->ClearDepthStencilView(mHorizontalBlurTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-			mFullScreenQuad->SetActiveTechnique("blur", "p0");
+			mFullScreenQuad->SetActivePass(mBlurPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithHorizontalOffsets, this));
             mFullScreenQuad->Draw(gameTime);
             mHorizontalBlurTarget->End();
@@ -141,7 +155,7 @@ namespace Library
         else
         {
 			mHorizontalBlurTarget->Begin();
-			mFullScreenQuad->SetActiveTechnique("no_blur", "p0");
+			mFullScreenQuad->SetActivePass(mNoBlurPass);
             mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialNoBlur, this));
             mFullScreenQuad->Draw(gameTime);
 			mHorizontalBlurTarget->End();
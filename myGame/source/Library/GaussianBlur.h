@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "DrawableGameComponent.h"
+#include "Pass.h"
 
 namespace Library
 {
@@ -27,6 +28,7 @@ namespace Library
 		float BlurAmount() const;
 		void SetBlurAmount(float blurAmount);
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		virtual void Draw(const GameTime& gameTime) override;
 		void DrawToTexture(const GameTime& gameTime);
@@ -46,13 +48,15 @@ namespace Library
 
 		static const float DefaultBlurAmount;
 
-		Effect* mEffect;
+		std::shared_ptr<Effect> mEffect;
 		GaussianBlurMaterial* mMaterial;
 		ID3D11ShaderResourceView* mSceneTexture;
 		ID3D11ShaderResourceView* mOutputTexture;
 		FullScreenRenderTarget* mHorizontalBlurTarget;
 		FullScreenRenderTarget* mVerticalBlurTarget;
 		FullScreenQuad* mFullScreenQuad;
+		PassHandle mBlurPass;
+		PassHandle mNoBlurPass;
 
 		std::vector<XMFLOAT2> mHorizontalSampleOffsets;
 		std::vector<XMFLOAT2> mVerticalSampleOffsets;
@@ -5,6 +5,7 @@
 
 namespace Library
 {
+	class Effect;
 	class BasicMaterial;	
 	class Pass;
 
@@ -42,6 +43,7 @@ namespace Library
 		static const UINT DefaultScale;
 		static const XMFLOAT4 DefaultColor;
 
+		std::shared_ptr<Effect> mEffect;
 		BasicMaterial* mMaterial;
 		Pass* mPass;
 		ID3D11InputLayout* mInputLayout;
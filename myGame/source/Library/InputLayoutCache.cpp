@@ -0,0 +1,152 @@
+#include "InputLayoutCache.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Pass.h"
+#include <sstream>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(InputLayoutCache)
+
+    InputLayoutCache::InputLayoutCache(Game& game)
+        : mGame(game), mInputLayouts(), mCreateCount(0), mHitCount(0)
+    {
+    }
+
+    InputLayoutCache::~InputLayoutCache()
+    {
+        Clear();
+    }
+
+    ID3D11InputLayout* InputLayoutCache::GetInputLayout(const Pass& pass, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount)
+    {
+        const D3DX11_PASS_DESC& passDesc = pass.PassDesc();
+
+        return GetInputLayout(passDesc.pIAInputSignature, passDesc.IAInputSignatureSize, inputElementDescriptions, inputElementDescriptionCount);
+    }
+
+    ID3D11InputLayout* InputLayoutCache::GetInputLayout(const void* inputSignature, SIZE_T inputSignatureSize, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount)
+    {
+        std::vector<BYTE> key;
+        BuildKey(inputSignature, inputSignatureSize, inputElementDescriptions, inputElementDescriptionCount, key);
+        UINT64 hash = HashKey(key);
+
+        std::pair<std::multimap<UINT64, InputLayoutCacheEntry>::iterator, std::multimap<UINT64, InputLayoutCacheEntry>::iterator> range = mInputLayouts.equal_range(hash);
+        for (std::multimap<UINT64, InputLayoutCacheEntry>::iterator it = range.first; it != range.second; ++it)
+        {
+            if (it->second.Key == key)
+            {
+                mHitCount++;
+                it->second.InputLayout->AddRef();
+
+                return it->second.InputLayout;
+            }
+        }
+
+        InputLayoutCacheEntry entry;
+        entry.ElementCount = inputElementDescriptionCount;
+        entry.InputLayout = nullptr;
+
+        HRESULT hr = mGame.Direct3DDevice()->CreateInputLayout(inputElementDescriptions, inputElementDescriptionCount, inputSignature, inputSignatureSize, &entry.InputLayout);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3D11Device::CreateInputLayout() failed.", hr);
+        }
+        mCreateCount++;
+
+        entry.Key.swap(key);
+        std::multimap<UINT64, InputLayoutCacheEntry>::iterator it = mInputLayouts.insert(std::pair<UINT64, InputLayoutCacheEntry>(hash, entry));
+        it->second.InputLayout->AddRef();
+
+        return it->second.InputLayout;
+    }
+
+    UINT InputLayoutCache::InputLayoutCount() const
+    {
+        return mInputLayouts.size();
+    }
+
+    UINT InputLayoutCache::CreateCount() const
+    {
+        return mCreateCount;
+    }
+
+    UINT InputLayoutCache::HitCount() const
+    {
+        return mHitCount;
+    }
+
+    void InputLayoutCache::ReportUsage() const
+    {
+        std::wostringstream report;
+        report << L"Input layouts: " << mInputLayouts.size() << L" (" << mCreateCount << L" created, " << mHitCount << L" shared)" << std::endl;
+        for (const std::pair<const UINT64, InputLayoutCacheEntry>& inputLayout : mInputLayouts)
+        {
+            report << L"    " << std::hex << inputLayout.first << std::dec << L": " << inputLayout.second.ElementCount << L" elements" << std::endl;
+        }
+
+        OutputDebugString(report.str().c_str());
+    }
+
+    // Releases the layouts no material holds any more
+    void InputLayoutCache::Trim()
+    {
+        std::multimap<UINT64, InputLayoutCacheEntry>::iterator it = mInputLayouts.begin();
+        while (it != mInputLayouts.end())
+        {
+            ID3D11InputLayout* inputLayout = it->second.InputLayout;
+            inputLayout->AddRef();
+            if (inputLayout->Release() == 1)
+            {
+                ReleaseObject(inputLayout);
+                it = mInputLayouts.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void InputLayoutCache::Clear()
+    {
+        for (std::pair<const UINT64, InputLayoutCacheEntry>& inputLayout : mInputLayouts)
+        {
+            ReleaseObject(inputLayout.second.InputLayout);
+        }
+
+        mInputLayouts.clear();
+    }
+
+    // The signature bytes followed by each element, semantic name included by value so that equal
+    // declarations built from different string literals still match
+    void InputLayoutCache::BuildKey(const void* inputSignature, SIZE_T inputSignatureSize, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount, std::vector<BYTE>& key)
+    {
+        const BYTE* signature = reinterpret_cast<const BYTE*>(inputSignature);
+        key.assign(signature, signature + inputSignatureSize);
+
+        for (UINT i = 0; i < inputElementDescriptionCount; i++)
+        {
+            const D3D11_INPUT_ELEMENT_DESC& element = inputElementDescriptions[i];
+            const BYTE* semanticName = reinterpret_cast<const BYTE*>(element.SemanticName);
+            key.insert(key.end(), semanticName, semanticName + strlen(element.SemanticName) + 1);
+
+            UINT fields[] = { element.SemanticIndex, static_cast<UINT>(element.Format), element.InputSlot, element.AlignedByteOffset, static_cast<UINT>(element.InputSlotClass), element.InstanceDataStepRate };
+            const BYTE* fieldBytes = reinterpret_cast<const BYTE*>(fields);
+            key.insert(key.end(), fieldBytes, fieldBytes + sizeof(fields));
+        }
+    }
+
+    // 64-bit FNV-1a
+    UINT64 InputLayoutCache::HashKey(const std::vector<BYTE>& key)
+    {
+        UINT64 hash = 14695981039346656037ULL;
+        for (BYTE value : key)
+        {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+}
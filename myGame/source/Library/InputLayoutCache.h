@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    class Game;
+    class Pass;
+
+    // Process-wide cache of input layouts. A layout depends only on the vertex shader's input
+    // signature and the element descriptions, so every pass that agrees on both (in any effect or
+    // material) gets the same device object, and drawing with one after the other binds the same
+    // layout again instead of a new one.
+    //
+    // Entries are found by a hash of the signature bytes and the element descriptions (semantic
+    // names by value), then compared in full. Layouts are handed out with an extra reference
+    // (AddRef); callers release them as usual. The cache keeps its own reference until Trim()
+    // finds it is the last one, or Clear().
+    class InputLayoutCache : public RTTI
+    {
+        RTTI_DECLARATIONS(InputLayoutCache, RTTI)
+
+    public:
+        InputLayoutCache(Game& game);
+        ~InputLayoutCache();
+
+        ID3D11InputLayout* GetInputLayout(const Pass& pass, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount);
+        ID3D11InputLayout* GetInputLayout(const void* inputSignature, SIZE_T inputSignatureSize, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount);
+
+        UINT InputLayoutCount() const;
+        UINT CreateCount() const;
+        UINT HitCount() const;
+
+        void ReportUsage() const;
+        void Trim();
+        void Clear();
+
+    private:
+        InputLayoutCache();
+        InputLayoutCache(const InputLayoutCache& rhs);
+        InputLayoutCache& operator=(const InputLayoutCache& rhs);
+
+        typedef struct _InputLayoutCacheEntry
+        {
+            std::vector<BYTE> Key;
+            UINT ElementCount;
+            ID3D11InputLayout* InputLayout;
+        } InputLayoutCacheEntry;
+
+        static void BuildKey(const void* inputSignature, SIZE_T inputSignatureSize, const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount, std::vector<BYTE>& key);
+        static UINT64 HashKey(const std::vector<BYTE>& key);
+
+        Game& mGame;
+        std::multimap<UINT64, InputLayoutCacheEntry> mInputLayouts;
+        UINT mCreateCount;
+        UINT mHitCount;
+    };
+}
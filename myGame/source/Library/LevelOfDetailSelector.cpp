@@ -0,0 +1,67 @@
+#include "LevelOfDetailSelector.h"
+#include "Camera.h"
+#include <algorithm>
+
+namespace Library
+{
+    const float LevelOfDetailSelector::ScreenSizeThresholds[] = { 0.25f, 0.12f, 0.06f };
+    const float LevelOfDetailSelector::Hysteresis = 0.1f;
+
+    LevelOfDetailSelector::LevelOfDetailSelector()
+        : mCurrentLevel(0)
+    {
+    }
+
+    float LevelOfDetailSelector::ProjectedSize(const DirectX::BoundingBox& bounds, CXMMATRIX worldMatrix, const Camera& camera)
+    {
+        DirectX::BoundingSphere sphere;
+        DirectX::BoundingSphere::CreateFromBoundingBox(sphere, bounds);
+        sphere.Transform(sphere, worldMatrix);
+
+        float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&sphere.Center), camera.PositionVector())));
+        if (distance <= sphere.Radius)
+        {
+            return 1.0f;
+        }
+
+        return sphere.Radius / (distance * tanf(camera.FieldOfView() * 0.5f));
+    }
+
+    // Submeshes with a shorter chain stay on their last level
+    UINT LevelOfDetailSelector::LevelCount(const std::vector<ModelSubmesh>& submeshes)
+    {
+        UINT levelCount = 1;
+        for (const ModelSubmesh& submesh : submeshes)
+        {
+            levelCount = (std::max)(levelCount, static_cast<UINT>(submesh.LevelsOfDetail.size()));
+        }
+
+        return levelCount;
+    }
+
+    UINT LevelOfDetailSelector::Select(float projectedSize, UINT levelCount)
+    {
+        assert(levelCount > 0);
+
+        // Threshold i separates level i from level i + 1
+        UINT level = (std::min)(mCurrentLevel, levelCount - 1);
+        while (level + 1 < levelCount && projectedSize < ScreenSizeThresholds[level] * (1.0f - Hysteresis))
+        {
+            level++;
+        }
+
+        while (level > 0 && projectedSize > ScreenSizeThresholds[level - 1] * (1.0f + Hysteresis))
+        {
+            level--;
+        }
+
+        mCurrentLevel = level;
+
+        return mCurrentLevel;
+    }
+
+    UINT LevelOfDetailSelector::CurrentLevel() const
+    {
+        return mCurrentLevel;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Common.h"
+#include "Model.h"
+#include <DirectXCollision.h>
+
+namespace Library
+{
+    class Camera;
+
+    // Picks a mesh level of detail from the fraction of the screen height covered by the model's
+    // bounding sphere. A level only changes once the size has moved Hysteresis past the threshold,
+    // so a model sitting on a boundary doesn't pop between levels every frame.
+    class LevelOfDetailSelector
+    {
+    public:
+        static const float ScreenSizeThresholds[MeshSimplifier::MaxLevelsOfDetail - 1];
+        static const float Hysteresis;
+
+        LevelOfDetailSelector();
+
+        static float ProjectedSize(const DirectX::BoundingBox& bounds, CXMMATRIX worldMatrix, const Camera& camera);
+        static UINT LevelCount(const std::vector<ModelSubmesh>& submeshes);
+
+        UINT Select(float projectedSize, UINT levelCount);
+        UINT CurrentLevel() const;
+
+    private:
+        UINT mCurrentLevel;
+    };
+}
@@ -0,0 +1,294 @@
+#include "LoadProfiler.h"
+#include "Utility.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace Library
+{
+    std::atomic<bool> LoadProfiler::sEnabled(false);
+    std::chrono::high_resolution_clock::time_point LoadProfiler::sStartTime;
+    double LoadProfiler::sTotalMilliseconds = 0.0;
+    std::vector<LoadProfileRecord> LoadProfiler::sRecords;
+    std::mutex LoadProfiler::sMutex;
+    thread_local LoadProfileScope* LoadProfiler::sCurrentScope = nullptr;
+    thread_local std::string LoadProfiler::sCurrentComponent;
+
+    void LoadProfiler::Begin()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sRecords.clear();
+        sTotalMilliseconds = 0.0;
+        sStartTime = std::chrono::high_resolution_clock::now();
+        sEnabled = true;
+    }
+
+    void LoadProfiler::End()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        if (sEnabled)
+        {
+            sTotalMilliseconds = MillisecondsSince(sStartTime);
+            sEnabled = false;
+        }
+    }
+
+    bool LoadProfiler::IsEnabled()
+    {
+        return sEnabled;
+    }
+
+    void LoadProfiler::AddBytesRead(UINT64 size)
+    {
+        if (sCurrentScope != nullptr)
+        {
+            sCurrentScope->mRecord.BytesRead += size;
+        }
+    }
+
+    void LoadProfiler::AddBytesUploaded(UINT64 size)
+    {
+        if (sCurrentScope != nullptr)
+        {
+            sCurrentScope->mRecord.BytesUploaded += size;
+        }
+    }
+
+    const std::string& LoadProfiler::CurrentComponent()
+    {
+        return sCurrentComponent;
+    }
+
+    std::vector<LoadProfileRecord> LoadProfiler::Records()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sRecords;
+    }
+
+    void LoadProfiler::WriteReport(const std::wstring& textFilename, const std::wstring& jsonFilename)
+    {
+        std::vector<LoadProfileRecord> records = Records();
+        std::sort(records.begin(), records.end(), [](const LoadProfileRecord& lhs, const LoadProfileRecord& rhs) { return lhs.Milliseconds > rhs.Milliseconds; });
+
+        std::vector<LoadProfilePhase> phases;
+        SummarizePhases(records, phases);
+
+        // Nested steps are already part of their parents' totals
+        UINT64 totalBytesRead = 0;
+        UINT64 totalBytesUploaded = 0;
+        for (const LoadProfileRecord& record : records)
+        {
+            if (record.Depth == 0)
+            {
+                totalBytesRead += record.BytesRead;
+                totalBytesUploaded += record.BytesUploaded;
+            }
+        }
+
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(1);
+        summary << "Load profile: " << sTotalMilliseconds << " ms, " << records.size() << " steps, " << (totalBytesRead / 1024) << " KB read, " << (totalBytesUploaded / 1024) << " KB uploaded" << std::endl;
+
+        std::ofstream text(textFilename.c_str());
+        if (text.good())
+        {
+            text << summary.str() << std::endl;
+            text << std::fixed << std::setprecision(2);
+
+            text << "Phases, slowest first (time and bytes include nested steps)" << std::endl;
+            text << std::setw(12) << "ms" << std::setw(8) << "count" << std::setw(12) << "KB read" << std::setw(12) << "KB upload" << "  phase" << std::endl;
+            for (const LoadProfilePhase& phase : phases)
+            {
+                text << std::setw(12) << phase.Milliseconds << std::setw(8) << phase.Count << std::setw(12) << (phase.BytesRead / 1024) << std::setw(12) << (phase.BytesUploaded / 1024) << "  " << phase.Phase << std::endl;
+            }
+            text << std::endl;
+
+            text << "Steps, slowest first" << std::endl;
+            text << std::setw(12) << "ms" << std::setw(12) << "start ms" << std::setw(12) << "KB read" << std::setw(12) << "KB upload" << "  phase: asset [component]" << std::endl;
+            for (const LoadProfileRecord& record : records)
+            {
+                text << std::setw(12) << record.Milliseconds << std::setw(12) << record.StartMilliseconds << std::setw(12) << (record.BytesRead / 1024) << std::setw(12) << (record.BytesUploaded / 1024) << "  " << record.Phase << ": " << record.Asset;
+                if (record.Component.empty() == false)
+                {
+                    text << " [" << record.Component << "]";
+                }
+                text << std::endl;
+            }
+        }
+
+        std::ofstream json(jsonFilename.c_str());
+        if (json.good())
+        {
+            json << std::fixed << std::setprecision(3);
+            json << "{" << std::endl;
+            json << "  \"totalMilliseconds\": " << sTotalMilliseconds << "," << std::endl;
+            json << "  \"bytesRead\": " << totalBytesRead << "," << std::endl;
+            json << "  \"bytesUploaded\": " << totalBytesUploaded << "," << std::endl;
+
+            json << "  \"phases\": [";
+            for (UINT i = 0; i < phases.size(); i++)
+            {
+                const LoadProfilePhase& phase = phases[i];
+                json << (i > 0 ? "," : "") << std::endl;
+                json << "    { \"phase\": " << JsonString(phase.Phase) << ", \"count\": " << phase.Count << ", \"milliseconds\": " << phase.Milliseconds
+                     << ", \"bytesRead\": " << phase.BytesRead << ", \"bytesUploaded\": " << phase.BytesUploaded << " }";
+            }
+            json << std::endl << "  ]," << std::endl;
+
+            json << "  \"steps\": [";
+            for (UINT i = 0; i < records.size(); i++)
+            {
+                const LoadProfileRecord& record = records[i];
+                json << (i > 0 ? "," : "") << std::endl;
+                json << "    { \"phase\": " << JsonString(record.Phase) << ", \"asset\": " << JsonString(record.Asset) << ", \"component\": " << JsonString(record.Component)
+                     << ", \"startMilliseconds\": " << record.StartMilliseconds << ", \"milliseconds\": " << record.Milliseconds
+                     << ", \"bytesRead\": " << record.BytesRead << ", \"bytesUploaded\": " << record.BytesUploaded << ", \"depth\": " << record.Depth << " }";
+            }
+            json << std::endl << "  ]" << std::endl;
+            json << "}" << std::endl;
+        }
+
+        OutputDebugStringA(summary.str().c_str());
+    }
+
+    void LoadProfiler::WriteReport()
+    {
+        std::wstring directory = Utility::ExecutableDirectory();
+        WriteReport(directory + L"\\LoadProfile.txt", directory + L"\\LoadProfile.json");
+    }
+
+    double LoadProfiler::MillisecondsSince(const std::chrono::high_resolution_clock::time_point& time)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - time).count();
+    }
+
+    void LoadProfiler::AddRecord(const LoadProfileRecord& record)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sRecords.push_back(record);
+    }
+
+    void LoadProfiler::SummarizePhases(const std::vector<LoadProfileRecord>& records, std::vector<LoadProfilePhase>& phases)
+    {
+        std::map<std::string, LoadProfilePhase> phaseMap;
+        for (const LoadProfileRecord& record : records)
+        {
+            LoadProfilePhase& phase = phaseMap[record.Phase];
+            if (phase.Count == 0)
+            {
+                phase.Phase = record.Phase;
+            }
+
+            phase.Count++;
+            phase.Milliseconds += record.Milliseconds;
+            phase.BytesRead += record.BytesRead;
+            phase.BytesUploaded += record.BytesUploaded;
+        }
+
+        phases.clear();
+        for (const std::pair<const std::string, LoadProfilePhase>& phase : phaseMap)
+        {
+            phases.push_back(phase.second);
+        }
+
+        std::sort(phases.begin(), phases.end(), [](const LoadProfilePhase& lhs, const LoadProfilePhase& rhs) { return lhs.Milliseconds > rhs.Milliseconds; });
+    }
+
+    std::string LoadProfiler::JsonString(const std::string& value)
+    {
+        std::ostringstream escaped;
+        escaped << "\"";
+        for (char character : value)
+        {
+            switch (character)
+            {
+            case '"':
+                escaped << "\\\"";
+                break;
+
+            case '\\':
+                escaped << "\\\\";
+                break;
+
+            default:
+                if (static_cast<byte>(character) < 0x20)
+                {
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<UINT>(static_cast<byte>(character)) << std::dec << std::setfill(' ');
+                }
+                else
+                {
+                    escaped << character;
+                }
+                break;
+            }
+        }
+        escaped << "\"";
+
+        return escaped.str();
+    }
+
+    LoadProfileScope::LoadProfileScope(const char* phase, const std::string& asset)
+        : mActive(false), mRecord(), mStartTime(), mParent(nullptr)
+    {
+        if (LoadProfiler::sEnabled)
+        {
+            Start(phase, asset);
+        }
+    }
+
+    LoadProfileScope::LoadProfileScope(const char* phase, const std::wstring& asset)
+        : mActive(false), mRecord(), mStartTime(), mParent(nullptr)
+    {
+        if (LoadProfiler::sEnabled)
+        {
+            Start(phase, std::string(asset.begin(), asset.end()));
+        }
+    }
+
+    LoadProfileScope::~LoadProfileScope()
+    {
+        if (mActive == false)
+        {
+            return;
+        }
+
+        mRecord.Milliseconds = LoadProfiler::MillisecondsSince(mStartTime);
+        LoadProfiler::sCurrentScope = mParent;
+        if (mParent != nullptr)
+        {
+            mParent->mRecord.BytesRead += mRecord.BytesRead;
+            mParent->mRecord.BytesUploaded += mRecord.BytesUploaded;
+        }
+
+        LoadProfiler::AddRecord(mRecord);
+    }
+
+    void LoadProfileScope::Start(const char* phase, const std::string& asset)
+    {
+        mActive = true;
+        mRecord.Phase = phase;
+        mRecord.Asset = asset;
+        mRecord.Component = LoadProfiler::sCurrentComponent;
+        mRecord.BytesRead = 0;
+        mRecord.BytesUploaded = 0;
+
+        mParent = LoadProfiler::sCurrentScope;
+        mRecord.Depth = (mParent != nullptr ? mParent->mRecord.Depth + 1 : 0);
+        LoadProfiler::sCurrentScope = this;
+
+        mStartTime = std::chrono::high_resolution_clock::now();
+        mRecord.StartMilliseconds = std::chrono::duration<double, std::milli>(mStartTime - LoadProfiler::sStartTime).count();
+    }
+
+    LoadProfileComponent::LoadProfileComponent(const std::string& component)
+        : mPreviousComponent(LoadProfiler::sCurrentComponent)
+    {
+        LoadProfiler::sCurrentComponent = component;
+    }
+
+    LoadProfileComponent::~LoadProfileComponent()
+    {
+        LoadProfiler::sCurrentComponent = mPreviousComponent;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Common.h"
+#include <chrono>
+#include <mutex>
+#include <atomic>
+
+namespace Library
+{
+    class LoadProfileScope;
+
+    // One timed load step. Time and bytes are inclusive of the steps nested inside it on the same
+    // thread; bytes read are what was opened through the VirtualFileSystem, bytes uploaded what
+    // was handed to the device for buffers and textures.
+    typedef struct _LoadProfileRecord
+    {
+        std::string Phase;
+        std::string Asset;
+        std::string Component;
+        double StartMilliseconds;
+        double Milliseconds;
+        UINT64 BytesRead;
+        UINT64 BytesUploaded;
+        UINT Depth;
+    } LoadProfileRecord;
+
+    // Startup load-time profiler. Game::Run starts a session before Initialize(); the loaders
+    // time themselves with LoadProfileScope, and Game::Initialize writes LoadProfile.txt and
+    // LoadProfile.json next to the executable, slowest steps first, once every component is ready.
+    //
+    // Outside a session a scope only tests a flag, so the instrumentation stays in release builds.
+    class LoadProfiler
+    {
+        friend class LoadProfileScope;
+        friend class LoadProfileComponent;
+
+    public:
+        static void Begin();
+        static void End();
+        static bool IsEnabled();
+
+        // Attributed to the innermost scope open on the calling thread
+        static void AddBytesRead(UINT64 size);
+        static void AddBytesUploaded(UINT64 size);
+
+        static const std::string& CurrentComponent();
+        static std::vector<LoadProfileRecord> Records();
+
+        static void WriteReport(const std::wstring& textFilename, const std::wstring& jsonFilename);
+        static void WriteReport();
+
+    private:
+        LoadProfiler();
+        LoadProfiler(const LoadProfiler& rhs);
+        LoadProfiler& operator=(const LoadProfiler& rhs);
+
+        typedef struct _LoadProfilePhase
+        {
+            std::string Phase;
+            UINT Count;
+            double Milliseconds;
+            UINT64 BytesRead;
+            UINT64 BytesUploaded;
+        } LoadProfilePhase;
+
+        static double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& time);
+        static void AddRecord(const LoadProfileRecord& record);
+        static void SummarizePhases(const std::vector<LoadProfileRecord>& records, std::vector<LoadProfilePhase>& phases);
+        static std::string JsonString(const std::string& value);
+
+        // Set under sMutex; LoadProfileScope tests it on worker threads without taking the lock
+        static std::atomic<bool> sEnabled;
+        static std::chrono::high_resolution_clock::time_point sStartTime;
+        static double sTotalMilliseconds;
+        static std::vector<LoadProfileRecord> sRecords;
+        static std::mutex sMutex;
+
+        static thread_local LoadProfileScope* sCurrentScope;
+        static thread_local std::string sCurrentComponent;
+    };
+
+    // Times the enclosing block as one step of a phase ("Assimp import", "Effect compile", ...)
+    class LoadProfileScope
+    {
+    public:
+        LoadProfileScope(const char* phase, const std::string& asset);
+        LoadProfileScope(const char* phase, const std::wstring& asset);
+        ~LoadProfileScope();
+
+    private:
+        LoadProfileScope();
+        LoadProfileScope(const LoadProfileScope& rhs);
+        LoadProfileScope& operator=(const LoadProfileScope& rhs);
+
+        void Start(const char* phase, const std::string& asset);
+
+        bool mActive;
+        LoadProfileRecord mRecord;
+        std::chrono::high_resolution_clock::time_point mStartTime;
+        LoadProfileScope* mParent;
+
+        friend class LoadProfiler;
+    };
+
+    // Names the component the steps on this thread load for, until the end of the enclosing block.
+    // AssetLoader carries it over to the jobs a component requests.
+    class LoadProfileComponent
+    {
+    public:
+        LoadProfileComponent(const std::string& component);
+        ~LoadProfileComponent();
+
+    private:
+        LoadProfileComponent();
+        LoadProfileComponent(const LoadProfileComponent& rhs);
+        LoadProfileComponent& operator=(const LoadProfileComponent& rhs);
+
+        std::string mPreviousComponent;
+    };
+}
@@ -1,6 +1,8 @@
 #include "Material.h"
 #include "GameException.h"
 #include "Model.h"
+#include "Game.h"
+#include "InputLayoutCache.h"
 
 namespace Library
 {	
@@ -18,24 +20,20 @@ namespace Library
 
     Material::~Material()
     {
-        for (std::pair<Pass*, ID3D11InputLayout*> inputLayout : mInputLayouts)
+        for (ID3D11InputLayout* inputLayout : mInputLayouts)
         {
-            ReleaseObject(inputLayout.second);
+            ReleaseObject(inputLayout);
         }
     }
 
     Variable* Material::operator[](const std::string& variableName)
     {
-        const std::map<std::string, Variable*>& variables = mEffect->VariablesByName();
-        Variable* foundVariable = nullptr;		
-
-        std::map<std::string, Variable*>::const_iterator found = variables.find(variableName);
-        if (found != variables.end())
-        {
-            foundVariable = found->second;
-        }
+        return mEffect->VariableByName(variableName);
+    }
 
-        return foundVariable;
+    Variable* Material::operator[](VariableHandle variable) const
+    {
+        return &mEffect->GetVariable(variable);
     }
 
     Effect* Material::GetEffect() const
@@ -53,16 +51,26 @@ namespace Library
         mCurrentTechnique = &currentTechnique;
     }
 
-    const std::map<Pass*, ID3D11InputLayout*>& Material::InputLayouts() const
+    const std::vector<ID3D11InputLayout*>& Material::InputLayouts() const
     {
         return mInputLayouts;
     }
 
+    ID3D11InputLayout* Material::InputLayout(PassHandle pass) const
+    {
+        return (pass < mInputLayouts.size() ? mInputLayouts[pass] : nullptr);
+    }
+
+    ID3D11InputLayout* Material::InputLayout(const Pass& pass) const
+    {
+        return InputLayout(pass.Handle());
+    }
+
     void Material::Initialize(Effect& effect)
     {
-		for (std::pair<Pass*, ID3D11InputLayout*> inputLayout : mInputLayouts)
+		for (ID3D11InputLayout* inputLayout : mInputLayouts)
         {
-            ReleaseObject(inputLayout.second);
+            ReleaseObject(inputLayout);
         }
 		mInputLayouts.clear();
 
@@ -72,8 +80,7 @@ namespace Library
         assert(mEffect->Techniques().size() > 0);
         if (mDefaultTechniqueName.empty() == false)
         {
-            defaultTechnique = mEffect->TechniquesByName().at(mDefaultTechniqueName);
-            assert(defaultTechnique != nullptr);
+            defaultTechnique = &mEffect->GetTechnique(mEffect->FindTechnique(mDefaultTechniqueName));
         }
         else
         {
@@ -96,23 +103,30 @@ namespace Library
 
     void Material::CreateInputLayout(const std::string& techniqueName, const std::string& passName, D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount)
     {
-        Technique* technique = mEffect->TechniquesByName().at(techniqueName);
-        assert(technique != nullptr);
-
-        Pass* pass = technique->PassesByName().at(passName);
-        assert(pass != nullptr);
-
-        ID3D11InputLayout* inputLayout;
-        pass->CreateInputLayout(inputElementDescriptions, inputElementDescriptionCount, &inputLayout);
-
-        mInputLayouts.insert(std::pair<Pass*, ID3D11InputLayout*>(pass, inputLayout));
+        Pass& pass = mEffect->GetPass(mEffect->FindPass(techniqueName, passName));
+        CreateInputLayout(pass, inputElementDescriptions, inputElementDescriptionCount);
     }
 
 	void Material::CreateInputLayout(Pass& pass, D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT inputElementDescriptionCount)
     {
+        // Shared with every other pass that has the same input signature and vertex declaration
         ID3D11InputLayout* inputLayout;
-        pass.CreateInputLayout(inputElementDescriptions, inputElementDescriptionCount, &inputLayout);
+        InputLayoutCache* inputLayoutCache = (InputLayoutCache*)mEffect->GetGame().Services().GetService(InputLayoutCache::TypeIdClass());
+        if (inputLayoutCache != nullptr)
+        {
+            inputLayout = inputLayoutCache->GetInputLayout(pass, inputElementDescriptions, inputElementDescriptionCount);
+        }
+        else
+        {
+            pass.CreateInputLayout(inputElementDescriptions, inputElementDescriptionCount, &inputLayout);
+        }
+
+        if (pass.Handle() >= mInputLayouts.size())
+        {
+            mInputLayouts.resize(mEffect->Passes().size(), nullptr);
+        }
 
-        mInputLayouts.insert(std::pair<Pass*, ID3D11InputLayout*>(&pass, inputLayout));
+        ReleaseObject(mInputLayouts[pass.Handle()]);
+        mInputLayouts[pass.Handle()] = inputLayout;
     }
 }
\ No newline at end of file
@@ -18,10 +18,15 @@ namespace Library
         virtual ~Material();
 
         Variable* operator[](const std::string& variableName);
+        Variable* operator[](VariableHandle variable) const;
         Effect* GetEffect() const;
         Technique* CurrentTechnique() const;
         void SetCurrentTechnique(Technique& currentTechnique);
-        const std::map<Pass*, ID3D11InputLayout*>& InputLayouts() const;
+
+        // Indexed by PassHandle; nullptr for passes this material has no layout for
+        const std::vector<ID3D11InputLayout*>& InputLayouts() const;
+        ID3D11InputLayout* InputLayout(PassHandle pass) const;
+        ID3D11InputLayout* InputLayout(const Pass& pass) const;
 
         virtual void Initialize(Effect& effect);
         virtual void CreateVertexBuffer(ID3D11Device* device, const Model& model, std::vector<ID3D11Buffer*>& vertexBuffers) const;
@@ -38,7 +43,7 @@ namespace Library
         Effect* mEffect;
         Technique* mCurrentTechnique;
         std::string mDefaultTechniqueName;
-        std::map<Pass*, ID3D11InputLayout*> mInputLayouts;
+        std::vector<ID3D11InputLayout*> mInputLayouts;
     };
 
     #define MATERIAL_VARIABLE_DECLARATION(VariableName)	\
@@ -57,5 +62,5 @@ namespace Library
     #define MATERIAL_VARIABLE_INITIALIZATION(VariableName) m ## VariableName(NULL)
 
     #define MATERIAL_VARIABLE_RETRIEVE(VariableName)						\
-        m ## VariableName = mEffect->VariablesByName().at(#VariableName);
+        m ## VariableName = &mEffect->GetVariable(mEffect->FindVariable(#VariableName));
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "MaterialConstants.h"
+#include "Effect.h"
+#include "GameException.h"
+#include <sstream>
+
+namespace Library
+{
+    MaterialConstantBlock::MaterialConstantBlock()
+        : mConstantBuffer(nullptr)
+    {
+    }
+
+    void MaterialConstantBlock::StoreMatrix(XMFLOAT4X4& destination, CXMMATRIX matrix)
+    {
+        XMStoreFloat4x4(&destination, XMMatrixTranspose(matrix));
+    }
+
+    void MaterialConstantBlock::Bind(Effect& effect, const char* constantBufferName, const MaterialConstantMember* members, UINT memberCount, UINT size)
+    {
+        ID3DX11EffectConstantBuffer* constantBuffer = effect.GetEffect()->GetConstantBufferByName(constantBufferName);
+        if (constantBuffer->IsValid() == false)
+        {
+            throw GameException((std::string("Constant buffer not found: ") + constantBufferName).c_str());
+        }
+
+        D3DX11_EFFECT_TYPE_DESC constantBufferDesc;
+        HRESULT hr = constantBuffer->GetType()->GetDesc(&constantBufferDesc);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3DX11EffectType::GetDesc() failed.", hr);
+        }
+
+        std::ostringstream mismatch;
+        if (constantBufferDesc.UnpackedSize != size)
+        {
+            mismatch << "is " << constantBufferDesc.UnpackedSize << " bytes, the C++ block " << size;
+        }
+
+        // Every reflected member must be mirrored, since Commit() overwrites the whole buffer
+        for (UINT i = 0; i < constantBufferDesc.Members && mismatch.tellp() == 0; i++)
+        {
+            ID3DX11EffectVariable* variable = constantBuffer->GetMemberByIndex(i);
+
+            D3DX11_EFFECT_VARIABLE_DESC variableDesc;
+            D3DX11_EFFECT_TYPE_DESC typeDesc;
+            variable->GetDesc(&variableDesc);
+            variable->GetType()->GetDesc(&typeDesc);
+
+            const MaterialConstantMember* member = nullptr;
+            for (UINT j = 0; j < memberCount; j++)
+            {
+                if (strcmp(members[j].Name, variableDesc.Name) == 0)
+                {
+                    member = &members[j];
+                    break;
+                }
+            }
+
+            if (member == nullptr)
+            {
+                mismatch << "has " << variableDesc.Name << ", missing from the C++ block";
+            }
+            else if (member->Offset != variableDesc.BufferOffset || member->Size != typeDesc.PackedSize)
+            {
+                mismatch << "has " << variableDesc.Name << " at " << variableDesc.BufferOffset << " (" << typeDesc.PackedSize << " bytes), the C++ block at "
+                         << member->Offset << " (" << member->Size << " bytes)";
+            }
+            else if (typeDesc.Class == D3D_SVC_MATRIX_ROWS)
+            {
+                mismatch << "declares " << variableDesc.Name << " row_major; StoreMatrix() writes column_major";
+            }
+        }
+
+        if (mismatch.tellp() == 0 && constantBufferDesc.Members != memberCount)
+        {
+            mismatch << "has " << constantBufferDesc.Members << " members, the C++ block " << memberCount;
+        }
+
+        if (mismatch.tellp() != 0)
+        {
+            throw GameException((std::string("Constant buffer ") + constantBufferName + " " + mismatch.str() + ".").c_str());
+        }
+
+        mConstantBuffer = constantBuffer;
+    }
+
+    void MaterialConstantBlock::Write(const void* data, UINT size)
+    {
+        assert(mConstantBuffer != nullptr);
+
+        HRESULT hr = mConstantBuffer->SetRawValue(data, 0, size);
+        if (FAILED(hr))
+        {
+            throw GameException("ID3DX11EffectConstantBuffer::SetRawValue() failed.", hr);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common.h"
+#include <cstddef>
+
+namespace Library
+{
+    class Effect;
+
+    // One member of a constant block as the C++ struct lays it out
+    typedef struct _MaterialConstantMember
+    {
+        const char* Name;
+        UINT Offset;
+        UINT Size;
+    } MaterialConstantMember;
+
+    #define MATERIAL_CONSTANT_MEMBER(Block, Member) { #Member, offsetof(Block, Member), sizeof(((Block*)nullptr)->Member) }
+
+    // The untyped half of MaterialConstants<T>: finds the cbuffer, checks the C++ layout against the
+    // reflected one and writes the bytes.
+    class MaterialConstantBlock
+    {
+    public:
+        // HLSL's default column_major packing wants matrices stored transposed
+        static void StoreMatrix(XMFLOAT4X4& destination, CXMMATRIX matrix);
+
+    protected:
+        MaterialConstantBlock();
+
+        void Bind(Effect& effect, const char* constantBufferName, const MaterialConstantMember* members, UINT memberCount, UINT size);
+        void Write(const void* data, UINT size);
+
+    private:
+        MaterialConstantBlock(const MaterialConstantBlock& rhs);
+        MaterialConstantBlock& operator=(const MaterialConstantBlock& rhs);
+
+        ID3DX11EffectConstantBuffer* mConstantBuffer;
+    };
+
+    // One cbuffer of a material's effect, written as a whole from a C++ struct. T mirrors the HLSL
+    // cbuffer with its packing (a vector never straddles a 16-byte register) and declares
+    //
+    //     static const char* const ConstantBufferName;
+    //     static const MaterialConstantMember Members[];    // built with MATERIAL_CONSTANT_MEMBER
+    //     static const UINT MemberCount;
+    //
+    // Bind() checks every member's offset and size against the effect's reflected layout once, when
+    // the material is initialized, and throws if the struct and the shader disagree or the struct
+    // leaves a member out. Draw code then fills Data() and Commit() copies the whole block into the
+    // effect's constant buffer with one SetRawValue(); Effects11 uploads it on the next Apply().
+    //
+    // Commit() always writes: materials sharing an effect each keep their own block.
+    template <typename T>
+    class MaterialConstants : public MaterialConstantBlock
+    {
+    public:
+        MaterialConstants()
+            : MaterialConstantBlock(), mData()
+        {
+            static_assert(sizeof(T) % 16 == 0, "Constant buffers are a whole number of 16-byte registers.");
+        }
+
+        void Bind(Effect& effect)
+        {
+            MaterialConstantBlock::Bind(effect, T::ConstantBufferName, T::Members, T::MemberCount, sizeof(T));
+        }
+
+        T& Data()
+        {
+            return mData;
+        }
+
+        const T& Data() const
+        {
+            return mData;
+        }
+
+        void Commit()
+        {
+            Write(&mData, sizeof(T));
+        }
+
+    private:
+        T mData;
+    };
+}
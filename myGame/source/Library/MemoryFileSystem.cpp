@@ -0,0 +1,42 @@
+#include "MemoryFileSystem.h"
+
+namespace Library
+{
+    MemoryFileSystem::MemoryFileSystem()
+        : mFiles()
+    {
+    }
+
+    void MemoryFileSystem::AddFile(const std::string& path, const std::vector<byte>& data)
+    {
+        std::string key;
+        VirtualFileSystem::NormalizePath(path, key);
+
+        mFiles[key] = std::make_shared<const std::vector<byte>>(data);
+    }
+
+    void MemoryFileSystem::AddFile(const std::string& path, const void* data, UINT size)
+    {
+        const byte* bytes = reinterpret_cast<const byte*>(data);
+        AddFile(path, std::vector<byte>(bytes, bytes + size));
+    }
+
+    bool MemoryFileSystem::Exists(const std::string& path) const
+    {
+        return (mFiles.find(path) != mFiles.end());
+    }
+
+    bool MemoryFileSystem::Open(const std::string& path, FileData& file) const
+    {
+        std::map<std::string, std::shared_ptr<const std::vector<byte>>>::const_iterator it = mFiles.find(path);
+        if (it == mFiles.end())
+        {
+            return false;
+        }
+
+        const std::vector<byte>& data = *it->second;
+        file = FileData(it->second, (data.empty() ? nullptr : &data[0]), data.size());
+
+        return true;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "VirtualFileSystem.h"
+
+namespace Library
+{
+    // Files held in memory, for tests and generated content. Add every file before mounting;
+    // the backend is read-only once lookups may run on other threads.
+    class MemoryFileSystem : public FileSystemBackend
+    {
+    public:
+        MemoryFileSystem();
+
+        void AddFile(const std::string& path, const std::vector<byte>& data);
+        void AddFile(const std::string& path, const void* data, UINT size);
+
+        virtual bool Exists(const std::string& path) const override;
+        virtual bool Open(const std::string& path, FileData& file) const override;
+
+    private:
+        MemoryFileSystem(const MemoryFileSystem& rhs);
+        MemoryFileSystem& operator=(const MemoryFileSystem& rhs);
+
+        std::map<std::string, std::shared_ptr<const std::vector<byte>>> mFiles;
+    };
+}
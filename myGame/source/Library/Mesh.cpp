@@ -3,106 +3,234 @@
 #include "Material.h"
 #include "Game.h"
 #include "GameException.h"
+#include "MeshOptimizer.h"
+#include "LoadProfiler.h"
 #include <assimp/scene.h>
 
 namespace Library
 {
+    namespace
+    {
+        template <typename T>
+        Span<T> CopyStream(byte*& cursor, const void* source, UINT count)
+        {
+            T* destination = reinterpret_cast<T*>(cursor);
+            memcpy(destination, source, sizeof(T) * count);
+            cursor += sizeof(T) * count;
+
+            return Span<T>(destination, count);
+        }
+
+        // Points a view into the old storage block at the same offset in the new one
+        template <typename T>
+        Span<T> RebaseStream(const Span<T>& stream, const byte* oldStorage, byte* newStorage)
+        {
+            if (stream.data() == nullptr)
+            {
+                return stream;
+            }
+
+            const byte* data = newStorage + (reinterpret_cast<const byte*>(stream.data()) - oldStorage);
+
+            return Span<T>(reinterpret_cast<const T*>(data), stream.size());
+        }
+
+        // The views are read-only; the Mesh writes through its own storage block at the same offset
+        template <typename T>
+        T* WritableStream(const Span<T>& stream, byte* storage)
+        {
+            assert(stream.data() != nullptr);
+
+            return reinterpret_cast<T*>(storage + (reinterpret_cast<const byte*>(stream.data()) - storage));
+        }
+
+        // Moves each element to its new slot
+        template <typename T>
+        void RemapStream(const Span<T>& stream, byte* storage, const std::vector<UINT>& remap)
+        {
+            if (stream.empty())
+            {
+                return;
+            }
+
+            std::vector<T> source(stream.begin(), stream.end());
+            T* destination = WritableStream(stream, storage);
+            for (UINT i = 0; i < source.size(); i++)
+            {
+                destination[remap[i]] = source[i];
+            }
+        }
+    }
+
     Mesh::Mesh(Model& model, ModelMaterial* material)
-        : mModel(model), mMaterial(material), mName(), mVertices(), mNormals(), mTangents(), mBiNormals(), mTextureCoordinates(), mVertexColors(), mFaceCount(0), mIndices(),
+        : mModel(model), mMaterial(material), mName(), mStorage(nullptr), mVertices(), mNormals(), mTangents(), mBiNormals(), mTextureCoordinates(), mVertexColors(), mFaceCount(0), mIndices(), mLevelOfDetailIndices(), mLevelsOfDetail(),
 		  mVertexBuffer(), mIndexBuffer()
     {
     }
 
     Mesh::Mesh(Model& model, ModelMaterial* material, aiMesh* mesh)
-        : mModel(model), mMaterial(material), mName(mesh->mName.C_Str()), mVertices(), mNormals(), mTangents(), mBiNormals(), mTextureCoordinates(), mVertexColors(), mFaceCount(0), mIndices()
+        : mModel(model), mMaterial(material), mName(mesh->mName.C_Str()), mStorage(nullptr), mVertices(), mNormals(), mTangents(), mBiNormals(), mTextureCoordinates(), mVertexColors(), mFaceCount(0), mIndices(), mLevelOfDetailIndices(), mLevelsOfDetail()
     {
-        // Vertices
-        mVertices.reserve(mesh->mNumVertices);
-        for (UINT i = 0; i < mesh->mNumVertices; i++)
+        UINT vertexCount = mesh->mNumVertices;
+        UINT uvChannelCount = mesh->GetNumUVChannels();
+        UINT colorChannelCount = mesh->GetNumColorChannels();
+        bool trianglesOnly = (mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE);
+
+        // Size every stream up front so the whole mesh is a single allocation
+        UINT indexCount = 0;
+        if (mesh->HasFaces())
         {
-            mVertices.push_back(XMFLOAT3(reinterpret_cast<const float*>(&mesh->mVertices[i])));			
+            mFaceCount = mesh->mNumFaces;
+            if (trianglesOnly)
+            {
+                indexCount = mFaceCount * 3;
+            }
+            else
+            {
+                for (UINT i = 0; i < mFaceCount; i++)
+                {
+                    indexCount += mesh->mFaces[i].mNumIndices;
+                }
+            }
         }
 
-        // Normals
+        UINT float3StreamCount = 1 + (mesh->HasNormals() ? 1 : 0) + (mesh->HasTangentsAndBitangents() ? 2 : 0) + uvChannelCount;
+        size_t storageSize = sizeof(XMFLOAT3) * vertexCount * float3StreamCount + sizeof(XMFLOAT4) * vertexCount * colorChannelCount + sizeof(UINT) * indexCount;
+        mStorage = new byte[storageSize];
+        byte* cursor = mStorage;
+
+        // Assimp's aiVector3D and aiColor4D are laid out like XMFLOAT3 and XMFLOAT4, so each stream is a straight copy
+        mVertices = CopyStream<XMFLOAT3>(cursor, mesh->mVertices, vertexCount);
+
         if (mesh->HasNormals())
         {
-            mNormals.reserve(mesh->mNumVertices);
-            for (UINT i = 0; i < mesh->mNumVertices; i++)
-            {
-                mNormals.push_back(XMFLOAT3(reinterpret_cast<const float*>(&mesh->mNormals[i])));
-            }
+            mNormals = CopyStream<XMFLOAT3>(cursor, mesh->mNormals, vertexCount);
         }
 
-        // Tangents and Binormals
         if (mesh->HasTangentsAndBitangents())
         {
-            mTangents.reserve(mesh->mNumVertices);
-            mBiNormals.reserve(mesh->mNumVertices);
-            for (UINT i = 0; i < mesh->mNumVertices; i++)
-            {
-                mTangents.push_back(XMFLOAT3(reinterpret_cast<const float*>(&mesh->mTangents[i])));
-                mBiNormals.push_back(XMFLOAT3(reinterpret_cast<const float*>(&mesh->mBitangents[i])));
-            }
+            mTangents = CopyStream<XMFLOAT3>(cursor, mesh->mTangents, vertexCount);
+            mBiNormals = CopyStream<XMFLOAT3>(cursor, mesh->mBitangents, vertexCount);
         }
 
-        // Texture Coordinates
-        UINT uvChannelCount = mesh->GetNumUVChannels();
+        mTextureCoordinates.reserve(uvChannelCount);
         for (UINT i = 0; i < uvChannelCount; i++)
         {
-            std::vector<XMFLOAT3>* textureCoordinates = new std::vector<XMFLOAT3>();
-            textureCoordinates->reserve(mesh->mNumVertices);
-            mTextureCoordinates.push_back(textureCoordinates);
-
-            aiVector3D* aiTextureCoordinates = mesh->mTextureCoords[i];
-            for (UINT j = 0; j < mesh->mNumVertices; j++)
-            {
-                textureCoordinates->push_back(XMFLOAT3(reinterpret_cast<const float*>(&aiTextureCoordinates[j])));
-            }
+            mTextureCoordinates.push_back(CopyStream<XMFLOAT3>(cursor, mesh->mTextureCoords[i], vertexCount));
         }
 
-        // Vertex Colors
-        UINT colorChannelCount = mesh->GetNumColorChannels();
+        mVertexColors.reserve(colorChannelCount);
         for (UINT i = 0; i < colorChannelCount; i++)
         {
-            std::vector<XMFLOAT4>* vertexColors = new std::vector<XMFLOAT4>();
-            vertexColors->reserve(mesh->mNumVertices);
-            mVertexColors.push_back(vertexColors);
+            mVertexColors.push_back(CopyStream<XMFLOAT4>(cursor, mesh->mColors[i], vertexCount));
+        }
 
-            aiColor4D* aiVertexColors = mesh->mColors[i];
-            for (UINT j = 0; j < mesh->mNumVertices; j++)
+        // Faces
+        UINT* indices = reinterpret_cast<UINT*>(cursor);
+        if (trianglesOnly)
+        {
+            for (UINT i = 0; i < mFaceCount; i++)
             {
-                vertexColors->push_back(XMFLOAT4(reinterpret_cast<const float*>(&aiVertexColors[j])));
+                memcpy(&indices[i * 3], mesh->mFaces[i].mIndices, sizeof(UINT) * 3);
             }
         }
-
-        // Faces (note: could pre-reserve if we limit primitive types)
-        if (mesh->HasFaces())
+        else
         {
-            mFaceCount = mesh->mNumFaces;
+            UINT* destination = indices;
             for (UINT i = 0; i < mFaceCount; i++)
             {
-                aiFace* face = &mesh->mFaces[i];
-            
-                for (UINT j = 0; j < face->mNumIndices; j++)
-                {		
-                    mIndices.push_back(face->mIndices[j]);
-                }
+                const aiFace& face = mesh->mFaces[i];
+                memcpy(destination, face.mIndices, sizeof(UINT) * face.mNumIndices);
+                destination += face.mNumIndices;
             }
         }
+        mIndices = Span<UINT>(indices, indexCount);
+        mLevelOfDetailIndices = mIndices;
+        mLevelsOfDetail.push_back(MeshLevelOfDetail(0, indexCount, 0.0f));
     }
 
-    Mesh::~Mesh()
+    // Appends simplified index lists to the storage block; the indices are its last stream, so
+    // every level stays contiguous with level 0 and uploads as one index buffer.
+    void Mesh::BuildLevelsOfDetail()
     {
-        for (std::vector<XMFLOAT3>* textureCoordinates : mTextureCoordinates)
+        if (IsTriangleList() == false)
         {
-            delete textureCoordinates;
+            return;
         }
 
-        for (std::vector<XMFLOAT4>* vertexColors : mVertexColors)
+        std::vector<UINT> levelIndices;
+        MeshSimplifier::BuildLevelsOfDetail(mIndices.data(), mIndices.size(), mVertices.data(), mVertices.size(), levelIndices, mLevelsOfDetail);
+        if (levelIndices.empty())
         {
-            delete vertexColors;
+            return;
         }
 
+        size_t storageSize = reinterpret_cast<const byte*>(mIndices.data() + mIndices.size()) - mStorage;
+        byte* storage = new byte[storageSize + sizeof(UINT) * levelIndices.size()];
+        memcpy(storage, mStorage, storageSize);
+        memcpy(storage + storageSize, &levelIndices[0], sizeof(UINT) * levelIndices.size());
+
+        mVertices = RebaseStream(mVertices, mStorage, storage);
+        mNormals = RebaseStream(mNormals, mStorage, storage);
+        mTangents = RebaseStream(mTangents, mStorage, storage);
+        mBiNormals = RebaseStream(mBiNormals, mStorage, storage);
+        for (Span<XMFLOAT3>& textureCoordinates : mTextureCoordinates)
+        {
+            textureCoordinates = RebaseStream(textureCoordinates, mStorage, storage);
+        }
+        for (Span<XMFLOAT4>& vertexColors : mVertexColors)
+        {
+            vertexColors = RebaseStream(vertexColors, mStorage, storage);
+        }
+        mIndices = RebaseStream(mIndices, mStorage, storage);
+        mLevelOfDetailIndices = Span<UINT>(mIndices.data(), mIndices.size() + levelIndices.size());
+
+        DeleteObjects(mStorage);
+        mStorage = storage;
+    }
+
+    // Reorders triangles for the post-transform cache and overdraw, level by level, then renumbers
+    // vertices in first-use order across every level. Only triangle lists are touched; lines and
+    // points keep their import order.
+    void Mesh::Optimize()
+    {
+        if (IsTriangleList() == false)
+        {
+            return;
+        }
+
+        UINT* indices = WritableStream(mLevelOfDetailIndices, mStorage);
+        UINT vertexCount = mVertices.size();
+
+        std::vector<UINT> clusters;
+        for (const MeshLevelOfDetail& level : mLevelsOfDetail)
+        {
+            MeshOptimizer::OptimizeVertexCache(indices + level.StartIndex, level.IndexCount, vertexCount, clusters);
+            MeshOptimizer::OptimizeOverdraw(indices + level.StartIndex, level.IndexCount, mVertices.data(), clusters);
+        }
+
+        // Level 0 comes first, so the vertex order follows the full-detail mesh
+        std::vector<UINT> remap;
+        MeshOptimizer::OptimizeVertexFetch(indices, mLevelOfDetailIndices.size(), vertexCount, remap);
+
+        RemapStream(mVertices, mStorage, remap);
+        RemapStream(mNormals, mStorage, remap);
+        RemapStream(mTangents, mStorage, remap);
+        RemapStream(mBiNormals, mStorage, remap);
+        for (const Span<XMFLOAT3>& textureCoordinates : mTextureCoordinates)
+        {
+            RemapStream(textureCoordinates, mStorage, remap);
+        }
+        for (const Span<XMFLOAT4>& vertexColors : mVertexColors)
+        {
+            RemapStream(vertexColors, mStorage, remap);
+        }
+    }
+
+    Mesh::~Mesh()
+    {
+        DeleteObjects(mStorage);
+
 		mVertexBuffer.ReleaseBuffer();
 		mIndexBuffer.ReleaseBuffer();
     }
@@ -122,32 +250,32 @@ namespace Library
         return mName;
     }
 
-    const std::vector<XMFLOAT3>& Mesh::Vertices() const
+    const Span<XMFLOAT3>& Mesh::Vertices() const
     {
         return mVertices;
     }
 
-    const std::vector<XMFLOAT3>& Mesh::Normals() const
+    const Span<XMFLOAT3>& Mesh::Normals() const
     {
         return mNormals;
     }
 
-    const std::vector<XMFLOAT3>& Mesh::Tangents() const
+    const Span<XMFLOAT3>& Mesh::Tangents() const
     {
         return mTangents;
     }
 
-    const std::vector<XMFLOAT3>& Mesh::BiNormals() const
+    const Span<XMFLOAT3>& Mesh::BiNormals() const
     {
         return mBiNormals;
     }
 
-    const std::vector<std::vector<XMFLOAT3>*>& Mesh::TextureCoordinates() const
+    const std::vector<Span<XMFLOAT3>>& Mesh::TextureCoordinates() const
     {
         return mTextureCoordinates;
     }
 
-    const std::vector<std::vector<XMFLOAT4>*>& Mesh::VertexColors() const
+    const std::vector<Span<XMFLOAT4>>& Mesh::VertexColors() const
     {
         return mVertexColors;
     }
@@ -157,11 +285,26 @@ namespace Library
         return mFaceCount;
     }
 
-    const std::vector<UINT>& Mesh::Indices() const
+    const Span<UINT>& Mesh::Indices() const
     {
         return mIndices;
     }
 
+    const Span<UINT>& Mesh::LevelOfDetailIndices() const
+    {
+        return mLevelOfDetailIndices;
+    }
+
+    const std::vector<MeshLevelOfDetail>& Mesh::LevelsOfDetail() const
+    {
+        return mLevelsOfDetail;
+    }
+
+    bool Mesh::IsTriangleList() const
+    {
+        return (mIndices.empty() == false && mIndices.size() == mFaceCount * 3);
+    }
+
 	BufferContainer& Mesh::VertexBuffer()
 	{
 		return mVertexBuffer;
@@ -192,17 +335,19 @@ namespace Library
 
         D3D11_BUFFER_DESC indexBufferDesc;
         ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
-        indexBufferDesc.ByteWidth = sizeof(UINT) * mIndices.size();
+        indexBufferDesc.ByteWidth = sizeof(UINT) * mLevelOfDetailIndices.size();
         indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;		
         indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
         D3D11_SUBRESOURCE_DATA indexSubResourceData;
         ZeroMemory(&indexSubResourceData, sizeof(indexSubResourceData));
-        indexSubResourceData.pSysMem = &mIndices[0];
+        indexSubResourceData.pSysMem = mLevelOfDetailIndices.data();
         if (FAILED(mModel.GetGame().Direct3DDevice()->CreateBuffer(&indexBufferDesc, &indexSubResourceData, indexBuffer)))
         {
             throw GameException("ID3D11Device::CreateBuffer() failed.");
         }
+
+        LoadProfiler::AddBytesUploaded(indexBufferDesc.ByteWidth);
     }
 
 	void Mesh::CreateCachedVertexAndIndexBuffers(ID3D11Device& device, const Material& material)
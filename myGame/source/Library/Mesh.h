@@ -2,6 +2,8 @@
 
 #include "Common.h"
 #include "BufferContainer.h"
+#include "Span.h"
+#include "MeshSimplifier.h"
 
 struct aiMesh;
 
@@ -10,6 +12,10 @@ namespace Library
     class Material;
     class ModelMaterial;
 
+    // Every attribute stream and the index list live in one block allocated at import; the
+    // accessors return views into it. Simplified levels of detail are appended after the level 0
+    // indices and share its vertices; Indices() is always level 0. The views stay read-only; the
+    // import-time rewrites (Optimize, BuildLevelsOfDetail) go through mStorage.
     class Mesh
     {
         friend class Model;
@@ -22,14 +28,17 @@ namespace Library
         ModelMaterial* GetMaterial();
         const std::string& Name() const;
 
-        const std::vector<XMFLOAT3>& Vertices() const;
-        const std::vector<XMFLOAT3>& Normals() const;
-        const std::vector<XMFLOAT3>& Tangents() const;
-        const std::vector<XMFLOAT3>& BiNormals() const;
-        const std::vector<std::vector<XMFLOAT3>*>& TextureCoordinates() const;
-        const std::vector<std::vector<XMFLOAT4>*>& VertexColors() const;
+        const Span<XMFLOAT3>& Vertices() const;
+        const Span<XMFLOAT3>& Normals() const;
+        const Span<XMFLOAT3>& Tangents() const;
+        const Span<XMFLOAT3>& BiNormals() const;
+        const std::vector<Span<XMFLOAT3>>& TextureCoordinates() const;
+        const std::vector<Span<XMFLOAT4>>& VertexColors() const;
         UINT FaceCount() const;
-        const std::vector<UINT>& Indices() const;
+        const Span<UINT>& Indices() const;
+        const Span<UINT>& LevelOfDetailIndices() const;
+        const std::vector<MeshLevelOfDetail>& LevelsOfDetail() const;
+        bool IsTriangleList() const;
 
 		BufferContainer& VertexBuffer();
 		BufferContainer& IndexBuffer();
@@ -45,17 +54,23 @@ namespace Library
         Mesh(const Mesh& rhs);
         Mesh& operator=(const Mesh& rhs);
 
+        void BuildLevelsOfDetail();
+        void Optimize();
+
         Model& mModel;
         ModelMaterial* mMaterial;
         std::string mName;
-        std::vector<XMFLOAT3> mVertices;
-        std::vector<XMFLOAT3> mNormals;
-        std::vector<XMFLOAT3> mTangents;
-        std::vector<XMFLOAT3> mBiNormals;
-        std::vector<std::vector<XMFLOAT3>*> mTextureCoordinates;
-        std::vector<std::vector<XMFLOAT4>*> mVertexColors;
+        byte* mStorage;
+        Span<XMFLOAT3> mVertices;
+        Span<XMFLOAT3> mNormals;
+        Span<XMFLOAT3> mTangents;
+        Span<XMFLOAT3> mBiNormals;
+        std::vector<Span<XMFLOAT3>> mTextureCoordinates;
+        std::vector<Span<XMFLOAT4>> mVertexColors;
         UINT mFaceCount;
-        std::vector<UINT> mIndices;
+        Span<UINT> mIndices;
+        Span<UINT> mLevelOfDetailIndices;
+        std::vector<MeshLevelOfDetail> mLevelsOfDetail;
 
 		BufferContainer mVertexBuffer;
 		BufferContainer mIndexBuffer;
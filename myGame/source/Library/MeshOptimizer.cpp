@@ -0,0 +1,275 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+namespace Library
+{
+    const UINT MeshOptimizer::VertexCacheSize = 16;
+
+    void MeshOptimizer::OptimizeVertexCache(UINT* indices, UINT indexCount, UINT vertexCount, std::vector<UINT>& clusters)
+    {
+        assert(indexCount % 3 == 0);
+
+        clusters.clear();
+        UINT triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        // Vertex to triangle adjacency, packed per vertex
+        std::vector<UINT> liveTriangles(vertexCount, 0);
+        for (UINT i = 0; i < indexCount; i++)
+        {
+            liveTriangles[indices[i]]++;
+        }
+
+        std::vector<UINT> adjacencyOffsets(vertexCount + 1, 0);
+        for (UINT i = 0; i < vertexCount; i++)
+        {
+            adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+        }
+
+        std::vector<UINT> adjacency(indexCount);
+        std::vector<UINT> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (UINT i = 0; i < indexCount; i++)
+        {
+            adjacency[adjacencyFill[indices[i]]++] = i / 3;
+        }
+
+        std::vector<UINT> cacheTimeStamps(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<UINT> deadEnds;
+        std::vector<UINT> candidates;
+        std::vector<UINT> output;
+        output.reserve(indexCount);
+
+        UINT timeStamp = VertexCacheSize + 1;
+        UINT cursor = 0;
+        int fanningVertex = indices[0];
+        clusters.push_back(0);
+
+        while (fanningVertex >= 0)
+        {
+            // Emit every remaining triangle around the fanning vertex
+            candidates.clear();
+            for (UINT i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+            {
+                UINT triangle = adjacency[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                for (UINT corner = 0; corner < 3; corner++)
+                {
+                    UINT vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+
+                    if (timeStamp - cacheTimeStamps[vertex] > VertexCacheSize)
+                    {
+                        cacheTimeStamps[vertex] = timeStamp++;
+                    }
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // Prefer the oldest candidate that will still be cached once its own fan is emitted
+            int nextVertex = -1;
+            int bestPriority = -1;
+            for (UINT vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                int priority = 0;
+                if (timeStamp - cacheTimeStamps[vertex] + 2 * liveTriangles[vertex] <= VertexCacheSize)
+                {
+                    priority = timeStamp - cacheTimeStamps[vertex];
+                }
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            if (nextVertex == -1)
+            {
+                // Dead end; the cache is effectively flushed here, which makes it a cluster boundary for OptimizeOverdraw
+                while (deadEnds.empty() == false && nextVertex == -1)
+                {
+                    UINT vertex = deadEnds.back();
+                    deadEnds.pop_back();
+                    if (liveTriangles[vertex] > 0)
+                    {
+                        nextVertex = vertex;
+                    }
+                }
+
+                while (nextVertex == -1 && cursor < vertexCount)
+                {
+                    if (liveTriangles[cursor] > 0)
+                    {
+                        nextVertex = cursor;
+                    }
+                    cursor++;
+                }
+
+                UINT emittedTriangles = output.size() / 3;
+                if (nextVertex != -1 && emittedTriangles > clusters.back())
+                {
+                    clusters.push_back(emittedTriangles);
+                }
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        assert(output.size() == indexCount);
+        memcpy(indices, &output[0], sizeof(UINT) * indexCount);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(UINT* indices, UINT indexCount, const XMFLOAT3* positions, const std::vector<UINT>& clusters)
+    {
+        struct Cluster
+        {
+            UINT Begin;
+            UINT End;
+            XMFLOAT3 Normal;
+            XMFLOAT3 Centroid;
+            float SortKey;
+        };
+
+        UINT triangleCount = indexCount / 3;
+        if (clusters.size() < 2)
+        {
+            return;
+        }
+
+        std::vector<Cluster> sortedClusters(clusters.size());
+        XMVECTOR meshCentroid = XMVectorZero();
+        float meshArea = 0.0f;
+        for (UINT i = 0; i < clusters.size(); i++)
+        {
+            Cluster& cluster = sortedClusters[i];
+            cluster.Begin = clusters[i];
+            cluster.End = (i + 1 < clusters.size() ? clusters[i + 1] : triangleCount);
+
+            XMVECTOR normal = XMVectorZero();
+            XMVECTOR centroid = XMVectorZero();
+            float area = 0.0f;
+            for (UINT triangle = cluster.Begin; triangle < cluster.End; triangle++)
+            {
+                XMVECTOR a = XMLoadFloat3(&positions[indices[triangle * 3]]);
+                XMVECTOR b = XMLoadFloat3(&positions[indices[triangle * 3 + 1]]);
+                XMVECTOR c = XMLoadFloat3(&positions[indices[triangle * 3 + 2]]);
+
+                // Front faces are clockwise in this right-handed scene (see Model::ImportFlags)
+                XMVECTOR faceNormal = XMVector3Cross(XMVectorSubtract(c, a), XMVectorSubtract(b, a));
+                float faceArea = XMVectorGetX(XMVector3Length(faceNormal));
+
+                normal = XMVectorAdd(normal, faceNormal);
+                centroid = XMVectorAdd(centroid, XMVectorScale(XMVectorAdd(XMVectorAdd(a, b), c), faceArea / 3.0f));
+                area += faceArea;
+            }
+
+            XMStoreFloat3(&cluster.Normal, XMVector3Normalize(normal));
+            XMStoreFloat3(&cluster.Centroid, (area > 0.0f ? XMVectorScale(centroid, 1.0f / area) : centroid));
+
+            meshCentroid = XMVectorAdd(meshCentroid, centroid);
+            meshArea += area;
+        }
+
+        if (meshArea <= 0.0f)
+        {
+            return;
+        }
+        meshCentroid = XMVectorScale(meshCentroid, 1.0f / meshArea);
+
+        // Clusters facing away from the centre are the likeliest occluders, so they are drawn first
+        for (Cluster& cluster : sortedClusters)
+        {
+            XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&cluster.Centroid), meshCentroid);
+            cluster.SortKey = XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&cluster.Normal)));
+        }
+
+        std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster& lhs, const Cluster& rhs)
+        {
+            return lhs.SortKey > rhs.SortKey;
+        });
+
+        std::vector<UINT> output;
+        output.reserve(indexCount);
+        for (const Cluster& cluster : sortedClusters)
+        {
+            output.insert(output.end(), indices + cluster.Begin * 3, indices + cluster.End * 3);
+        }
+
+        memcpy(indices, &output[0], sizeof(UINT) * indexCount);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(UINT* indices, UINT indexCount, UINT vertexCount, std::vector<UINT>& remap)
+    {
+        // Number vertices in the order the index list first touches them; unreferenced ones go last
+        remap.assign(vertexCount, UINT_MAX);
+
+        UINT nextVertex = 0;
+        for (UINT i = 0; i < indexCount; i++)
+        {
+            UINT& newIndex = remap[indices[i]];
+            if (newIndex == UINT_MAX)
+            {
+                newIndex = nextVertex++;
+            }
+
+            indices[i] = newIndex;
+        }
+
+        for (UINT i = 0; i < vertexCount; i++)
+        {
+            if (remap[i] == UINT_MAX)
+            {
+                remap[i] = nextVertex++;
+            }
+        }
+    }
+
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const UINT* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+    {
+        // FIFO cache: a vertex is resident while fewer than cacheSize misses happened since it was loaded
+        std::vector<UINT> loadTimes(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        UINT transformCount = 0;
+        UINT referencedCount = 0;
+
+        for (UINT i = 0; i < indexCount; i++)
+        {
+            UINT vertex = indices[i];
+            if (referenced[vertex] == false)
+            {
+                referenced[vertex] = true;
+                referencedCount++;
+            }
+            else if (transformCount - loadTimes[vertex] <= cacheSize)
+            {
+                continue;
+            }
+
+            loadTimes[vertex] = transformCount++;
+        }
+
+        VertexCacheStatistics statistics;
+        statistics.TransformCount = transformCount;
+        statistics.ACMR = (indexCount > 0 ? float(transformCount) / (indexCount / 3) : 0.0f);
+        statistics.ATVR = (referencedCount > 0 ? float(transformCount) / referencedCount : 0.0f);
+
+        return statistics;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    typedef struct _VertexCacheStatistics
+    {
+        UINT TransformCount;
+        float ACMR;
+        float ATVR;
+    } VertexCacheStatistics;
+
+    // Triangle list reordering run by Mesh at import: Tipsify (Sander, Nehab and Barczak, "Fast
+    // Triangle Reordering for Vertex Locality and Reduced Overdraw") for the post-transform cache,
+    // then its clusters sorted front to back for overdraw, then vertices renumbered in first-use
+    // order for fetch locality. Winding order is preserved throughout.
+    class MeshOptimizer
+    {
+    public:
+        static const UINT VertexCacheSize;
+
+        static void OptimizeVertexCache(UINT* indices, UINT indexCount, UINT vertexCount, std::vector<UINT>& clusters);
+        static void OptimizeOverdraw(UINT* indices, UINT indexCount, const XMFLOAT3* positions, const std::vector<UINT>& clusters);
+        static void OptimizeVertexFetch(UINT* indices, UINT indexCount, UINT vertexCount, std::vector<UINT>& remap);
+
+        static VertexCacheStatistics AnalyzeVertexCache(const UINT* indices, UINT indexCount, UINT vertexCount, UINT cacheSize = VertexCacheSize);
+
+    private:
+        MeshOptimizer();
+        MeshOptimizer(const MeshOptimizer& rhs);
+        MeshOptimizer& operator=(const MeshOptimizer& rhs);
+    };
+}
@@ -0,0 +1,157 @@
+#include "MeshQuantization.h"
+#include "GameException.h"
+#include "LoadProfiler.h"
+#include <cmath>
+#include <algorithm>
+
+namespace Library
+{
+    BoundingBox MeshQuantization::Bounds(const Span<XMFLOAT3>& positions)
+    {
+        BoundingBox bounds;
+        if (positions.empty() == false)
+        {
+            BoundingBox::CreateFromPoints(bounds, positions.size(), positions.data(), sizeof(XMFLOAT3));
+        }
+
+        return bounds;
+    }
+
+    XMFLOAT3 MeshQuantization::PositionScale(const BoundingBox& bounds)
+    {
+        return XMFLOAT3(bounds.Extents.x * 2.0f, bounds.Extents.y * 2.0f, bounds.Extents.z * 2.0f);
+    }
+
+    XMFLOAT3 MeshQuantization::PositionOffset(const BoundingBox& bounds)
+    {
+        return XMFLOAT3(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+    }
+
+    XMUSHORTN4 MeshQuantization::QuantizePosition(const XMFLOAT3& position, const BoundingBox& bounds)
+    {
+        XMFLOAT3 positionScale = PositionScale(bounds);
+        XMFLOAT3 positionOffset = PositionOffset(bounds);
+        XMVECTOR scale = XMLoadFloat3(&positionScale);
+        XMVECTOR offset = XMLoadFloat3(&positionOffset);
+
+        // A flat axis has no extent to quantize against; every vertex sits at the offset
+        XMVECTOR flat = XMVectorEqual(scale, XMVectorZero());
+        XMVECTOR normalized = XMVectorDivide(XMVectorSubtract(XMLoadFloat3(&position), offset), XMVectorSelect(scale, XMVectorSplatOne(), flat));
+        normalized = XMVectorSelect(normalized, XMVectorZero(), flat);
+        normalized = XMVectorSetW(XMVectorSaturate(normalized), 1.0f);
+
+        XMUSHORTN4 quantized;
+        XMStoreUShortN4(&quantized, normalized);
+
+        return quantized;
+    }
+
+    XMFLOAT3 MeshQuantization::DequantizePosition(const XMUSHORTN4& position, const BoundingBox& bounds)
+    {
+        XMFLOAT3 positionScale = PositionScale(bounds);
+        XMFLOAT3 positionOffset = PositionOffset(bounds);
+        XMVECTOR scale = XMLoadFloat3(&positionScale);
+        XMVECTOR offset = XMLoadFloat3(&positionOffset);
+
+        XMFLOAT3 dequantized;
+        XMStoreFloat3(&dequantized, XMVectorMultiplyAdd(XMLoadUShortN4(&position), scale, offset));
+
+        return dequantized;
+    }
+
+    XMSHORTN2 MeshQuantization::EncodeOctahedral(const XMFLOAT3& direction)
+    {
+        // Project onto the octahedron |x| + |y| + |z| = 1 and fold the lower hemisphere over the diagonals
+        float length = fabs(direction.x) + fabs(direction.y) + fabs(direction.z);
+        if (length == 0.0f)
+        {
+            return XMSHORTN2(0.0f, 0.0f);
+        }
+
+        float x = direction.x / length;
+        float y = direction.y / length;
+        if (direction.z < 0.0f)
+        {
+            float foldedX = (1.0f - fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float foldedY = (1.0f - fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        return XMSHORTN2(x, y);
+    }
+
+    XMFLOAT3 MeshQuantization::DecodeOctahedral(const XMSHORTN2& direction)
+    {
+        XMFLOAT2 encoded;
+        XMStoreFloat2(&encoded, XMLoadShortN2(&direction));
+
+        XMFLOAT3 decoded(encoded.x, encoded.y, 1.0f - fabs(encoded.x) - fabs(encoded.y));
+        if (decoded.z < 0.0f)
+        {
+            decoded.x = (1.0f - fabs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f);
+            decoded.y = (1.0f - fabs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        XMStoreFloat3(&decoded, XMVector3Normalize(XMLoadFloat3(&decoded)));
+
+        return decoded;
+    }
+
+    DXGI_FORMAT MeshQuantization::IndexFormat(UINT vertexCount)
+    {
+        return (vertexCount <= USHRT_MAX + 1U ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT);
+    }
+
+    // Submesh indices are relative to their base vertex, so only the largest submesh matters
+    DXGI_FORMAT MeshQuantization::IndexFormat(const std::vector<ModelSubmesh>& submeshes)
+    {
+        UINT vertexCount = 0;
+        for (const ModelSubmesh& submesh : submeshes)
+        {
+            vertexCount = (std::max)(vertexCount, submesh.VertexCount);
+        }
+
+        return IndexFormat(vertexCount);
+    }
+
+    UINT MeshQuantization::IndexSize(DXGI_FORMAT format)
+    {
+        return (format == DXGI_FORMAT_R16_UINT ? sizeof(USHORT) : sizeof(UINT));
+    }
+
+    void MeshQuantization::CreateIndexBuffer(ID3D11Device* device, const UINT* indices, UINT indexCount, DXGI_FORMAT format, ID3D11Buffer** indexBuffer)
+    {
+        assert(indexBuffer != nullptr);
+
+        std::vector<USHORT> narrowIndices;
+        const void* data = indices;
+        if (format == DXGI_FORMAT_R16_UINT)
+        {
+            narrowIndices.reserve(indexCount);
+            for (UINT i = 0; i < indexCount; i++)
+            {
+                assert(indices[i] <= USHRT_MAX);
+                narrowIndices.push_back(static_cast<USHORT>(indices[i]));
+            }
+
+            data = &narrowIndices[0];
+        }
+
+        D3D11_BUFFER_DESC indexBufferDesc;
+        ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
+        indexBufferDesc.ByteWidth = IndexSize(format) * indexCount;
+        indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+        D3D11_SUBRESOURCE_DATA indexSubResourceData;
+        ZeroMemory(&indexSubResourceData, sizeof(indexSubResourceData));
+        indexSubResourceData.pSysMem = data;
+        if (FAILED(device->CreateBuffer(&indexBufferDesc, &indexSubResourceData, indexBuffer)))
+        {
+            throw GameException("ID3D11Device::CreateBuffer() failed.");
+        }
+
+        LoadProfiler::AddBytesUploaded(indexBufferDesc.ByteWidth);
+    }
+}
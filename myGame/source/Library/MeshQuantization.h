@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common.h"
+#include "Span.h"
+#include "Model.h"
+#include <DirectXCollision.h>
+
+namespace Library
+{
+    // Encoders for the compact vertex formats (see VertexFormatPositionQuantized): positions as
+    // 16-bit unorm relative to the mesh bounds, unit vectors octahedral-encoded into two snorm16
+    // and 16-bit indices whenever the vertex count allows it. The matching decode lives in
+    // Common.fxh; PositionScale/PositionOffset are the constants the shaders need for it.
+    class MeshQuantization
+    {
+    public:
+        static BoundingBox Bounds(const Span<XMFLOAT3>& positions);
+        static XMFLOAT3 PositionScale(const BoundingBox& bounds);
+        static XMFLOAT3 PositionOffset(const BoundingBox& bounds);
+
+        static XMUSHORTN4 QuantizePosition(const XMFLOAT3& position, const BoundingBox& bounds);
+        static XMFLOAT3 DequantizePosition(const XMUSHORTN4& position, const BoundingBox& bounds);
+        static XMSHORTN2 EncodeOctahedral(const XMFLOAT3& direction);
+        static XMFLOAT3 DecodeOctahedral(const XMSHORTN2& direction);
+
+        static DXGI_FORMAT IndexFormat(UINT vertexCount);
+        static DXGI_FORMAT IndexFormat(const std::vector<ModelSubmesh>& submeshes);
+        static UINT IndexSize(DXGI_FORMAT format);
+        static void CreateIndexBuffer(ID3D11Device* device, const UINT* indices, UINT indexCount, DXGI_FORMAT format, ID3D11Buffer** indexBuffer);
+
+    private:
+        MeshQuantization();
+        MeshQuantization(const MeshQuantization& rhs);
+        MeshQuantization& operator=(const MeshQuantization& rhs);
+    };
+}
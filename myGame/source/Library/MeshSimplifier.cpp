@@ -0,0 +1,315 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+namespace Library
+{
+    namespace
+    {
+        // Symmetric 4x4 matrix of the plane equations summed at a vertex; only the upper triangle is stored
+        typedef struct _Quadric
+        {
+            double A2, AB, AC, AD, B2, BC, BD, C2, CD, D2;
+        } Quadric;
+
+        typedef struct _Collapse
+        {
+            UINT From;
+            UINT To;
+            double Cost;
+        } Collapse;
+
+        typedef struct _PositionKey
+        {
+            float X, Y, Z;
+
+            bool operator<(const _PositionKey& rhs) const
+            {
+                if (X != rhs.X) return X < rhs.X;
+                if (Y != rhs.Y) return Y < rhs.Y;
+                return Z < rhs.Z;
+            }
+        } PositionKey;
+
+        void AddPlane(Quadric& quadric, double a, double b, double c, double d)
+        {
+            quadric.A2 += a * a; quadric.AB += a * b; quadric.AC += a * c; quadric.AD += a * d;
+            quadric.B2 += b * b; quadric.BC += b * c; quadric.BD += b * d;
+            quadric.C2 += c * c; quadric.CD += c * d;
+            quadric.D2 += d * d;
+        }
+
+        void AddQuadric(Quadric& quadric, const Quadric& rhs)
+        {
+            quadric.A2 += rhs.A2; quadric.AB += rhs.AB; quadric.AC += rhs.AC; quadric.AD += rhs.AD;
+            quadric.B2 += rhs.B2; quadric.BC += rhs.BC; quadric.BD += rhs.BD;
+            quadric.C2 += rhs.C2; quadric.CD += rhs.CD;
+            quadric.D2 += rhs.D2;
+        }
+
+        // Sum of squared distances from the position to every plane in the quadric
+        double EvaluateQuadric(const Quadric& quadric, const XMFLOAT3& position)
+        {
+            double x = position.x;
+            double y = position.y;
+            double z = position.z;
+
+            return quadric.A2 * x * x + 2.0 * quadric.AB * x * y + 2.0 * quadric.AC * x * z + 2.0 * quadric.AD * x
+                + quadric.B2 * y * y + 2.0 * quadric.BC * y * z + 2.0 * quadric.BD * y
+                + quadric.C2 * z * z + 2.0 * quadric.CD * z
+                + quadric.D2;
+        }
+
+        // Front faces are clockwise in this right-handed scene (see Model::ImportFlags)
+        XMVECTOR FaceNormal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+        {
+            XMVECTOR positionA = XMLoadFloat3(&a);
+
+            return XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&c), positionA), XMVectorSubtract(XMLoadFloat3(&b), positionA));
+        }
+    }
+
+    float MeshSimplifier::Simplify(const UINT* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexCount, UINT targetIndexCount, std::vector<UINT>& destination)
+    {
+        assert(indexCount % 3 == 0);
+
+        destination.assign(indices, indices + indexCount);
+        if (indexCount <= targetIndexCount)
+        {
+            return 0.0f;
+        }
+
+        // Plane quadrics and locks come from the unsimplified mesh
+        Quadric zero;
+        ZeroMemory(&zero, sizeof(zero));
+        std::vector<Quadric> quadrics(vertexCount, zero);
+        std::map<std::pair<UINT, UINT>, UINT> edgeUseCounts;
+        for (UINT i = 0; i < indexCount; i += 3)
+        {
+            XMFLOAT3 normal;
+            XMStoreFloat3(&normal, XMVector3Normalize(FaceNormal(positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]])));
+            const XMFLOAT3& a = positions[indices[i]];
+            double d = -(double(normal.x) * a.x + double(normal.y) * a.y + double(normal.z) * a.z);
+
+            for (UINT corner = 0; corner < 3; corner++)
+            {
+                AddPlane(quadrics[indices[i + corner]], normal.x, normal.y, normal.z, d);
+
+                UINT v0 = indices[i + corner];
+                UINT v1 = indices[i + (corner + 1) % 3];
+                edgeUseCounts[std::make_pair((std::min)(v0, v1), (std::max)(v0, v1))]++;
+            }
+        }
+
+        // Open borders, non-manifold edges and seams (split vertices sharing a position) must stay put
+        std::vector<bool> locked(vertexCount, false);
+        for (const auto& edge : edgeUseCounts)
+        {
+            if (edge.second != 2)
+            {
+                locked[edge.first.first] = true;
+                locked[edge.first.second] = true;
+            }
+        }
+
+        std::map<PositionKey, UINT> firstVertexAtPosition;
+        for (UINT i = 0; i < vertexCount; i++)
+        {
+            PositionKey key = { positions[i].x, positions[i].y, positions[i].z };
+            auto inserted = firstVertexAtPosition.insert(std::make_pair(key, i));
+            if (inserted.second == false)
+            {
+                locked[i] = true;
+                locked[inserted.first->second] = true;
+            }
+        }
+
+        std::vector<UINT> remap(vertexCount);
+        for (UINT i = 0; i < vertexCount; i++)
+        {
+            remap[i] = i;
+        }
+
+        std::vector<UINT> adjacencyOffsets;
+        std::vector<UINT> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<bool> touched;
+        double maxCost = 0.0;
+
+        // Each pass applies the cheapest collapses whose neighbourhoods don't overlap, then compacts the list
+        while (destination.size() > targetIndexCount)
+        {
+            UINT currentIndexCount = destination.size();
+            UINT triangleCount = currentIndexCount / 3;
+
+            adjacencyOffsets.assign(vertexCount + 1, 0);
+            for (UINT i = 0; i < currentIndexCount; i++)
+            {
+                adjacencyOffsets[destination[i] + 1]++;
+            }
+            for (UINT i = 0; i < vertexCount; i++)
+            {
+                adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+            }
+
+            adjacency.resize(currentIndexCount);
+            std::vector<UINT> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (UINT i = 0; i < currentIndexCount; i++)
+            {
+                adjacency[adjacencyFill[destination[i]]++] = i / 3;
+            }
+
+            collapses.clear();
+            for (UINT i = 0; i < currentIndexCount; i += 3)
+            {
+                for (UINT corner = 0; corner < 3; corner++)
+                {
+                    UINT v0 = destination[i + corner];
+                    UINT v1 = destination[i + (corner + 1) % 3];
+
+                    if (locked[v0] == false)
+                    {
+                        Quadric quadric = quadrics[v0];
+                        AddQuadric(quadric, quadrics[v1]);
+                        Collapse collapse = { v0, v1, EvaluateQuadric(quadric, positions[v1]) };
+                        collapses.push_back(collapse);
+                    }
+
+                    if (locked[v1] == false)
+                    {
+                        Quadric quadric = quadrics[v1];
+                        AddQuadric(quadric, quadrics[v0]);
+                        Collapse collapse = { v1, v0, EvaluateQuadric(quadric, positions[v0]) };
+                        collapses.push_back(collapse);
+                    }
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs)
+            {
+                return lhs.Cost < rhs.Cost;
+            });
+
+            // Capping the pass keeps the cost order meaningful; later collapses see the updated quadrics
+            UINT remainingTriangles = (currentIndexCount - targetIndexCount) / 3;
+            UINT passTriangles = (std::max)((std::min)(remainingTriangles, triangleCount / 8), 1U);
+            UINT removedTriangles = 0;
+            UINT appliedCollapses = 0;
+            touched.assign(vertexCount, false);
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (removedTriangles >= passTriangles)
+                {
+                    break;
+                }
+
+                if (touched[collapse.From] || touched[collapse.To])
+                {
+                    continue;
+                }
+
+                // Triangles sharing the edge vanish; every other triangle around From must keep its facing
+                bool flips = false;
+                UINT collapsingTriangles = 0;
+                for (UINT i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1] && flips == false; i++)
+                {
+                    const UINT* triangle = &destination[adjacency[i] * 3];
+                    if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+                    {
+                        collapsingTriangles++;
+                        continue;
+                    }
+
+                    XMFLOAT3 corners[3];
+                    for (UINT corner = 0; corner < 3; corner++)
+                    {
+                        corners[corner] = positions[triangle[corner] == collapse.From ? collapse.To : triangle[corner]];
+                    }
+
+                    XMVECTOR before = FaceNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+                    XMVECTOR after = FaceNormal(corners[0], corners[1], corners[2]);
+                    flips = (XMVectorGetX(XMVector3Dot(before, after)) <= 0.0f);
+                }
+
+                if (flips)
+                {
+                    continue;
+                }
+
+                remap[collapse.From] = collapse.To;
+                AddQuadric(quadrics[collapse.To], quadrics[collapse.From]);
+
+                touched[collapse.From] = true;
+                touched[collapse.To] = true;
+                for (UINT i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1]; i++)
+                {
+                    const UINT* triangle = &destination[adjacency[i] * 3];
+                    touched[triangle[0]] = true;
+                    touched[triangle[1]] = true;
+                    touched[triangle[2]] = true;
+                }
+
+                removedTriangles += collapsingTriangles;
+                maxCost = (std::max)(maxCost, collapse.Cost);
+                appliedCollapses++;
+            }
+
+            if (appliedCollapses == 0)
+            {
+                break;
+            }
+
+            UINT written = 0;
+            for (UINT i = 0; i < currentIndexCount; i += 3)
+            {
+                UINT a = remap[destination[i]];
+                UINT b = remap[destination[i + 1]];
+                UINT c = remap[destination[i + 2]];
+                if (a != b && b != c && a != c)
+                {
+                    destination[written++] = a;
+                    destination[written++] = b;
+                    destination[written++] = c;
+                }
+            }
+
+            destination.resize(written);
+        }
+
+        return static_cast<float>(sqrt((std::max)(maxCost, 0.0)));
+    }
+
+    void MeshSimplifier::BuildLevelsOfDetail(const UINT* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexCount, std::vector<UINT>& levelIndices, std::vector<MeshLevelOfDetail>& levels)
+    {
+        levelIndices.clear();
+        levels.clear();
+        levels.push_back(MeshLevelOfDetail(0, indexCount, 0.0f));
+
+        // Each level halves the triangle count of the original; simplifying from level 0 every time keeps the full quadrics
+        std::vector<UINT> simplified;
+        float error = 0.0f;
+        for (UINT level = 1; level < MaxLevelsOfDetail; level++)
+        {
+            UINT targetIndexCount = ((indexCount / 3) >> level) * 3;
+            if (targetIndexCount == 0)
+            {
+                break;
+            }
+
+            float levelError = Simplify(indices, indexCount, positions, vertexCount, targetIndexCount, simplified);
+
+            // Locked borders and seams can stall the reduction; a level that saves little isn't worth a range
+            const MeshLevelOfDetail& previous = levels.back();
+            if (simplified.empty() || simplified.size() > previous.IndexCount * 3 / 4)
+            {
+                break;
+            }
+
+            error = (std::max)(error, levelError);
+            levels.push_back(MeshLevelOfDetail(indexCount + levelIndices.size(), simplified.size(), error));
+            levelIndices.insert(levelIndices.end(), simplified.begin(), simplified.end());
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    // One entry of a mesh's level-of-detail chain: a range of the shared index list, drawn against
+    // the unchanged level 0 vertex buffer. Error is the largest collapse cost (in model units)
+    // accumulated to reach this level.
+    typedef struct _MeshLevelOfDetail
+    {
+        UINT StartIndex;
+        UINT IndexCount;
+        float Error;
+
+        _MeshLevelOfDetail() { }
+
+        _MeshLevelOfDetail(UINT startIndex, UINT indexCount, float error)
+            : StartIndex(startIndex), IndexCount(indexCount), Error(error) { }
+    } MeshLevelOfDetail;
+
+    // Quadric error metric simplifier (Garland and Heckbert, "Surface Simplification Using Quadric
+    // Error Metrics") restricted to half-edge collapses, so every level reuses the original
+    // vertices. Border and UV/normal seam vertices are locked and collapses that would flip a
+    // triangle are rejected.
+    class MeshSimplifier
+    {
+    public:
+        static const UINT MaxLevelsOfDetail = 4;
+
+        static float Simplify(const UINT* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexCount, UINT targetIndexCount, std::vector<UINT>& destination);
+        static void BuildLevelsOfDetail(const UINT* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexCount, std::vector<UINT>& levelIndices, std::vector<MeshLevelOfDetail>& levels);
+
+    private:
+        MeshSimplifier();
+        MeshSimplifier(const MeshSimplifier& rhs);
+        MeshSimplifier& operator=(const MeshSimplifier& rhs);
+    };
+}
@@ -3,24 +3,142 @@
 #include "GameException.h"
 #include "Mesh.h"
 #include "ModelMaterial.h"
+#include "MeshQuantization.h"
+#include "VirtualFileSystem.h"
+#include "LoadProfiler.h"
 #include <assimp/Importer.hpp>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 
 namespace Library
 {
-    Model::Model(Game& game, const std::string& filename, bool flipUVs)
-        : mGame(game), mMeshes(), mMaterials()
+    namespace
     {
+        // Read-only Assimp stream over a file opened through the VirtualFileSystem
+        class VirtualFileIOStream : public Assimp::IOStream
+        {
+        public:
+            VirtualFileIOStream(const FileData& file)
+                : mFile(file), mPosition(0)
+            {
+            }
+
+            virtual size_t Read(void* buffer, size_t size, size_t count) override
+            {
+                if (size == 0)
+                {
+                    return 0;
+                }
+
+                size_t available = static_cast<size_t>(mFile.Size()) - mPosition;
+                count = (std::min)(count, available / size);
+                memcpy(buffer, mFile.Data() + mPosition, size * count);
+                mPosition += size * count;
+
+                return count;
+            }
+
+            virtual size_t Write(const void* buffer, size_t size, size_t count) override
+            {
+                return 0;
+            }
+
+            virtual aiReturn Seek(size_t offset, aiOrigin origin) override
+            {
+                size_t position;
+                switch (origin)
+                {
+                case aiOrigin_SET:
+                    position = offset;
+                    break;
+
+                case aiOrigin_CUR:
+                    position = mPosition + offset;
+                    break;
+
+                default:
+                    position = static_cast<size_t>(mFile.Size()) - offset;
+                    break;
+                }
+
+                if (position > mFile.Size())
+                {
+                    return aiReturn_FAILURE;
+                }
+
+                mPosition = position;
+
+                return aiReturn_SUCCESS;
+            }
+
+            virtual size_t Tell() const override
+            {
+                return mPosition;
+            }
+
+            virtual size_t FileSize() const override
+            {
+                return static_cast<size_t>(mFile.Size());
+            }
+
+            virtual void Flush() override
+            {
+            }
+
+        private:
+            FileData mFile;
+            size_t mPosition;
+        };
+
+        // Lets Assimp resolve the model and any file it references (.mtl and the like) through the mount points
+        class VirtualFileIOSystem : public Assimp::IOSystem
+        {
+        public:
+            virtual bool Exists(const char* filename) const override
+            {
+                return VirtualFileSystem::Exists(std::string(filename));
+            }
+
+            virtual char getOsSeparator() const override
+            {
+                return '\\';
+            }
+
+            virtual Assimp::IOStream* Open(const char* filename, const char* mode) override
+            {
+                FileData file;
+                if (strchr(mode, 'w') != nullptr || VirtualFileSystem::Open(std::string(filename), file) == false)
+                {
+                    return nullptr;
+                }
+
+                return new VirtualFileIOStream(file);
+            }
+
+            virtual void Close(Assimp::IOStream* stream) override
+            {
+                delete stream;
+            }
+        };
+    }
+
+    Model::Model(Game& game, const std::string& filename, bool flipUVs, bool optimizeMeshes)
+        : mGame(game), mMeshes(), mMaterials(), mSubmeshes(), mVertexCount(0), mIndexCount(0), mBounds()
+    {
+        LoadProfileScope profileScope("Model load", filename);
+
         Assimp::Importer importer;
+        importer.SetIOHandler(new VirtualFileIOSystem());
 
-        UINT flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_FlipWindingOrder;
-        if (flipUVs)
+        const aiScene* scene;
         {
-            flags |= aiProcess_FlipUVs;
+            LoadProfileScope importScope("Assimp import", filename);
+            scene = importer.ReadFile(filename, ImportFlags(flipUVs));
         }
 
-        const aiScene* scene = importer.ReadFile(filename, flags);
         if (scene == nullptr)
         {
             throw GameException(importer.GetErrorString());
@@ -34,16 +152,28 @@ namespace Library
             }
         }
 
+        std::vector<UINT> materialIndices;
         if (scene->HasMeshes())
         {
             for (UINT i = 0; i < scene->mNumMeshes; i++)
             {
-                ModelMaterial* material = (mMaterials.size() > i ? mMaterials.at(i) : nullptr);
+                UINT materialIndex = scene->mMeshes[i]->mMaterialIndex;
+                ModelMaterial* material = (mMaterials.size() > materialIndex ? mMaterials.at(materialIndex) : nullptr);
+                materialIndices.push_back(materialIndex);
 
                 Mesh* mesh = new Mesh(*this, material, scene->mMeshes[i]);
                 mMeshes.push_back(mesh);
+
+                if (optimizeMeshes)
+                {
+                    LoadProfileScope optimizeScope("Mesh optimize", filename);
+                    mesh->BuildLevelsOfDetail();
+                    mesh->Optimize();
+                }
             }
         }
+
+        BuildSubmeshes(materialIndices);
     }
 
     Model::~Model()
@@ -59,6 +189,17 @@ namespace Library
         }
     }
 
+    UINT Model::ImportFlags(bool flipUVs)
+    {
+        UINT flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_FlipWindingOrder;
+        if (flipUVs)
+        {
+            flags |= aiProcess_FlipUVs;
+        }
+
+        return flags;
+    }
+
     Game& Model::GetGame()
     {
         return mGame;
@@ -83,4 +224,78 @@ namespace Library
     {
         return mMaterials;
     }
+
+    const std::vector<ModelSubmesh>& Model::Submeshes() const
+    {
+        return mSubmeshes;
+    }
+
+    UINT Model::VertexCount() const
+    {
+        return mVertexCount;
+    }
+
+    UINT Model::IndexCount() const
+    {
+        return mIndexCount;
+    }
+
+    const BoundingBox& Model::Bounds() const
+    {
+        return mBounds;
+    }
+
+    // Every level of every triangle-list mesh, in submesh order; indices stay relative to BaseVertex
+    void Model::BuildIndices(std::vector<UINT>& indices) const
+    {
+        indices.clear();
+        indices.reserve(mIndexCount);
+        for (Mesh* mesh : mMeshes)
+        {
+            if (mesh->IsTriangleList())
+            {
+                const Span<UINT>& meshIndices = mesh->LevelOfDetailIndices();
+                indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+            }
+        }
+    }
+
+    // Lays the meshes out back to back; lines and points (split off by aiProcess_SortByPType) are
+    // left out of the merged buffers.
+    void Model::BuildSubmeshes(const std::vector<UINT>& materialIndices)
+    {
+        for (UINT i = 0; i < mMeshes.size(); i++)
+        {
+            Mesh* mesh = mMeshes[i];
+            if (mesh->IsTriangleList() == false)
+            {
+                continue;
+            }
+
+            ModelSubmesh submesh;
+            submesh.StartIndex = mIndexCount;
+            submesh.IndexCount = mesh->Indices().size();
+            submesh.BaseVertex = mVertexCount;
+            submesh.VertexCount = mesh->Vertices().size();
+            submesh.MaterialIndex = materialIndices[i];
+            submesh.Bounds = MeshQuantization::Bounds(mesh->Vertices());
+            for (const MeshLevelOfDetail& level : mesh->LevelsOfDetail())
+            {
+                submesh.LevelsOfDetail.push_back(MeshLevelOfDetail(mIndexCount + level.StartIndex, level.IndexCount, level.Error));
+            }
+
+            if (mSubmeshes.empty())
+            {
+                mBounds = submesh.Bounds;
+            }
+            else
+            {
+                BoundingBox::CreateMerged(mBounds, mBounds, submesh.Bounds);
+            }
+
+            mVertexCount += submesh.VertexCount;
+            mIndexCount += mesh->LevelOfDetailIndices().size();
+            mSubmeshes.push_back(submesh);
+        }
+    }
 }
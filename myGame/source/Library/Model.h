@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Common.h"
+#include "MeshSimplifier.h"
+#include <DirectXCollision.h>
 
 namespace Library
 {
@@ -8,12 +10,31 @@ namespace Library
     class Mesh;
     class ModelMaterial;
 
+    // One triangle-list mesh of a model within the model's merged vertex and index buffers. Its
+    // indices are relative to BaseVertex; the level-of-detail ranges are absolute offsets into the
+    // merged index list, level 0 first.
+    typedef struct _ModelSubmesh
+    {
+        UINT StartIndex;
+        UINT IndexCount;
+        INT BaseVertex;
+        UINT VertexCount;
+        UINT MaterialIndex;
+        DirectX::BoundingBox Bounds;
+        std::vector<MeshLevelOfDetail> LevelsOfDetail;
+    } ModelSubmesh;
+
+    // optimizeMeshes builds the simplified levels of detail and reorders each mesh for the vertex
+    // cache, overdraw and vertex fetch. That is cook-time work (ContentCooker); the runtime import of
+    // an uncooked asset skips it and draws level 0 in import order.
     class Model
     {
     public:
-        Model(Game& game, const std::string& filename, bool flipUVs = false);
+        Model(Game& game, const std::string& filename, bool flipUVs = false, bool optimizeMeshes = false);
         ~Model();
 
+        static UINT ImportFlags(bool flipUVs);
+
         Game& GetGame();
         bool HasMeshes() const;
         bool HasMaterials() const;
@@ -21,12 +42,24 @@ namespace Library
         const std::vector<Mesh*>& Meshes() const;
         const std::vector<ModelMaterial*>& Materials() const;
 
+        const std::vector<ModelSubmesh>& Submeshes() const;
+        UINT VertexCount() const;
+        UINT IndexCount() const;
+        const DirectX::BoundingBox& Bounds() const;
+        void BuildIndices(std::vector<UINT>& indices) const;
+
     private:
         Model(const Model& rhs);
         Model& operator=(const Model& rhs);
 
+        void BuildSubmeshes(const std::vector<UINT>& materialIndices);
+
         Game& mGame;
         std::vector<Mesh*> mMeshes;
         std::vector<ModelMaterial*> mMaterials;
+        std::vector<ModelSubmesh> mSubmeshes;
+        UINT mVertexCount;
+        UINT mIndexCount;
+        DirectX::BoundingBox mBounds;
     };
 }
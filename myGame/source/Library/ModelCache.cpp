@@ -0,0 +1,361 @@
+#include "ModelCache.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "CookedMesh.h"
+#include "MeshQuantization.h"
+#include "Utility.h"
+#include "VirtualFileSystem.h"
+#include "LoadProfiler.h"
+#include <sstream>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(ModelCache)
+
+    ModelCache::ModelCache(Game& game)
+        : mGame(game), mModels(), mCookedMeshes(), mVertexBuffers(), mIndexBuffers(), mCompactIndexBuffers(), mImportCount(0), mHitCount(0)
+    {
+    }
+
+    ModelCache::~ModelCache()
+    {
+        Clear();
+    }
+
+    std::shared_ptr<Model> ModelCache::GetModel(const std::string& filename, bool flipUVs)
+    {
+        std::string key = ModelKey(filename, flipUVs);
+
+        std::map<std::string, std::shared_ptr<Model>>::iterator it = mModels.find(key);
+        if (it != mModels.end())
+        {
+            mHitCount++;
+            return it->second;
+        }
+
+        std::shared_ptr<Model> model(new Model(mGame, filename, flipUVs));
+        mModels.insert(std::pair<std::string, std::shared_ptr<Model>>(key, model));
+        mImportCount++;
+
+        return model;
+    }
+
+    ID3D11Buffer* ModelCache::GetVertexBuffer(const Mesh& mesh, const Material& material)
+    {
+        return FindOrCreateVertexBuffer(VertexBufferKey(&mesh, material.TypeIdInstance()), [&](ID3D11Buffer** vertexBuffer)
+        {
+            if (mesh.Vertices().empty() == false)
+            {
+                material.CreateVertexBuffer(mGame.Direct3DDevice(), mesh, vertexBuffer);
+            }
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetVertexBuffer(const Mesh& mesh, VertexFormat format)
+    {
+        return FindOrCreateVertexBuffer(VertexBufferKey(&mesh, format), [&](ID3D11Buffer** vertexBuffer)
+        {
+            std::vector<byte> vertices;
+            CookedMesh::BuildVertices(mesh, format, vertices);
+            if (vertices.empty())
+            {
+                return;
+            }
+
+            D3D11_BUFFER_DESC vertexBufferDesc;
+            ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
+            vertexBufferDesc.ByteWidth = vertices.size();
+            vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+            vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+            D3D11_SUBRESOURCE_DATA vertexSubResourceData;
+            ZeroMemory(&vertexSubResourceData, sizeof(vertexSubResourceData));
+            vertexSubResourceData.pSysMem = vertices.data();
+            if (FAILED(mGame.Direct3DDevice()->CreateBuffer(&vertexBufferDesc, &vertexSubResourceData, vertexBuffer)))
+            {
+                throw GameException("ID3D11Device::CreateBuffer() failed.");
+            }
+
+            LoadProfiler::AddBytesUploaded(vertexBufferDesc.ByteWidth);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetIndexBuffer(Mesh& mesh)
+    {
+        if (mesh.Indices().empty())
+        {
+            return nullptr;
+        }
+
+        if (mesh.HasCachedIndexBuffer() == false)
+        {
+            ID3D11Buffer* indexBuffer = nullptr;
+            mesh.CreateIndexBuffer(&indexBuffer);
+            mesh.IndexBuffer().SetBuffer(indexBuffer);
+            mesh.IndexBuffer().SetElementCount(mesh.Indices().size());
+        }
+
+        ID3D11Buffer* indexBuffer = mesh.IndexBuffer().Buffer();
+        indexBuffer->AddRef();
+
+        return indexBuffer;
+    }
+
+    ID3D11Buffer* ModelCache::GetVertexBuffer(const Model& model, VertexFormat format)
+    {
+        return FindOrCreateVertexBuffer(VertexBufferKey(&model, format), [&](ID3D11Buffer** vertexBuffer)
+        {
+            std::vector<byte> vertices;
+            CookedMesh::BuildVertices(model, format, vertices);
+            if (vertices.empty())
+            {
+                return;
+            }
+
+            D3D11_BUFFER_DESC vertexBufferDesc;
+            ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
+            vertexBufferDesc.ByteWidth = vertices.size();
+            vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+            vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+            D3D11_SUBRESOURCE_DATA vertexSubResourceData;
+            ZeroMemory(&vertexSubResourceData, sizeof(vertexSubResourceData));
+            vertexSubResourceData.pSysMem = vertices.data();
+            if (FAILED(mGame.Direct3DDevice()->CreateBuffer(&vertexBufferDesc, &vertexSubResourceData, vertexBuffer)))
+            {
+                throw GameException("ID3D11Device::CreateBuffer() failed.");
+            }
+
+            LoadProfiler::AddBytesUploaded(vertexBufferDesc.ByteWidth);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetIndexBuffer(const Model& model)
+    {
+        return FindOrCreateIndexBuffer(mIndexBuffers, &model, [&](ID3D11Buffer** indexBuffer)
+        {
+            std::vector<UINT> indices;
+            model.BuildIndices(indices);
+            if (indices.empty())
+            {
+                return;
+            }
+
+            MeshQuantization::CreateIndexBuffer(mGame.Direct3DDevice(), indices.data(), indices.size(), DXGI_FORMAT_R32_UINT, indexBuffer);
+        });
+    }
+
+    std::shared_ptr<CookedMesh> ModelCache::GetCookedMesh(const std::string& filename)
+    {
+        std::string key;
+        Utility::NormalizePath(filename, key);
+
+        std::map<std::string, std::shared_ptr<CookedMesh>>::iterator it = mCookedMeshes.find(key);
+        if (it != mCookedMeshes.end())
+        {
+            if (it->second != nullptr)
+            {
+                mHitCount++;
+            }
+
+            return it->second;
+        }
+
+        // Misses are remembered too, so uncooked assets only pay for one file probe
+        std::shared_ptr<CookedMesh> cookedMesh;
+        std::wstring cookedFilename = CookedMesh::CookedFilename(filename);
+        if (VirtualFileSystem::Exists(cookedFilename))
+        {
+            cookedMesh = std::make_shared<CookedMesh>(cookedFilename);
+        }
+
+        mCookedMeshes.insert(std::pair<std::string, std::shared_ptr<CookedMesh>>(key, cookedMesh));
+
+        return cookedMesh;
+    }
+
+    void ModelCache::AddModel(const std::string& filename, bool flipUVs, std::shared_ptr<Model> model)
+    {
+        if (mModels.insert(std::pair<std::string, std::shared_ptr<Model>>(ModelKey(filename, flipUVs), model)).second)
+        {
+            mImportCount++;
+        }
+    }
+
+    void ModelCache::AddCookedMesh(const std::string& filename, std::shared_ptr<CookedMesh> cookedMesh)
+    {
+        std::string key;
+        Utility::NormalizePath(filename, key);
+
+        mCookedMeshes.insert(std::pair<std::string, std::shared_ptr<CookedMesh>>(key, cookedMesh));
+    }
+
+    ID3D11Buffer* ModelCache::GetVertexBuffer(const CookedMesh& mesh, VertexFormat format)
+    {
+        return FindOrCreateVertexBuffer(VertexBufferKey(&mesh, format), [&](ID3D11Buffer** vertexBuffer)
+        {
+            mesh.CreateVertexBuffer(mGame.Direct3DDevice(), format, vertexBuffer);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetIndexBuffer(const CookedMesh& mesh)
+    {
+        return FindOrCreateIndexBuffer(mIndexBuffers, &mesh, [&](ID3D11Buffer** indexBuffer)
+        {
+            mesh.CreateIndexBuffer(mGame.Direct3DDevice(), indexBuffer);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetCompactIndexBuffer(const Mesh& mesh)
+    {
+        return FindOrCreateIndexBuffer(mCompactIndexBuffers, &mesh, [&](ID3D11Buffer** indexBuffer)
+        {
+            MeshQuantization::CreateIndexBuffer(mGame.Direct3DDevice(), mesh.Indices().data(), mesh.Indices().size(), MeshQuantization::IndexFormat(mesh.Vertices().size()), indexBuffer);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetCompactIndexBuffer(const CookedMesh& mesh)
+    {
+        return FindOrCreateIndexBuffer(mCompactIndexBuffers, &mesh, [&](ID3D11Buffer** indexBuffer)
+        {
+            MeshQuantization::CreateIndexBuffer(mGame.Direct3DDevice(), mesh.Indices(), mesh.IndexCount(), MeshQuantization::IndexFormat(mesh.Submeshes()), indexBuffer);
+        });
+    }
+
+    ID3D11Buffer* ModelCache::GetCompactIndexBuffer(const Model& model)
+    {
+        return FindOrCreateIndexBuffer(mCompactIndexBuffers, &model, [&](ID3D11Buffer** indexBuffer)
+        {
+            std::vector<UINT> indices;
+            model.BuildIndices(indices);
+            if (indices.empty())
+            {
+                return;
+            }
+
+            MeshQuantization::CreateIndexBuffer(mGame.Direct3DDevice(), indices.data(), indices.size(), MeshQuantization::IndexFormat(model.Submeshes()), indexBuffer);
+        });
+    }
+
+    UINT ModelCache::ModelCount() const
+    {
+        return mModels.size();
+    }
+
+    UINT ModelCache::ImportCount() const
+    {
+        return mImportCount;
+    }
+
+    UINT ModelCache::HitCount() const
+    {
+        return mHitCount;
+    }
+
+    UINT ModelCache::VertexBufferCount() const
+    {
+        return mVertexBuffers.size();
+    }
+
+    UINT ModelCache::CookedMeshCount() const
+    {
+        UINT count = 0;
+        for (const std::pair<std::string, std::shared_ptr<CookedMesh>>& cookedMesh : mCookedMeshes)
+        {
+            if (cookedMesh.second != nullptr)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    void ModelCache::Clear()
+    {
+        for (std::pair<VertexBufferKey, ID3D11Buffer*> vertexBuffer : mVertexBuffers)
+        {
+            ReleaseObject(vertexBuffer.second);
+        }
+        mVertexBuffers.clear();
+
+        for (std::pair<const void*, ID3D11Buffer*> indexBuffer : mIndexBuffers)
+        {
+            ReleaseObject(indexBuffer.second);
+        }
+        mIndexBuffers.clear();
+
+        for (std::pair<const void*, ID3D11Buffer*> indexBuffer : mCompactIndexBuffers)
+        {
+            ReleaseObject(indexBuffer.second);
+        }
+        mCompactIndexBuffers.clear();
+
+        mModels.clear();
+        mCookedMeshes.clear();
+    }
+
+    std::string ModelCache::ModelKey(const std::string& filename, bool flipUVs)
+    {
+        std::string path;
+        Utility::NormalizePath(filename, path);
+
+        std::ostringstream key;
+        key << path << '|' << Model::ImportFlags(flipUVs);
+
+        return key.str();
+    }
+
+    ID3D11Buffer* ModelCache::FindOrCreateVertexBuffer(const VertexBufferKey& key, const std::function<void(ID3D11Buffer**)>& create)
+    {
+        ID3D11Buffer* vertexBuffer = nullptr;
+        std::map<VertexBufferKey, ID3D11Buffer*>::iterator it = mVertexBuffers.find(key);
+        if (it != mVertexBuffers.end())
+        {
+            vertexBuffer = it->second;
+        }
+        else
+        {
+            LoadProfileScope profileScope("Buffer build", "vertices");
+            create(&vertexBuffer);
+            if (vertexBuffer == nullptr)
+            {
+                return nullptr;
+            }
+
+            mVertexBuffers.insert(std::pair<VertexBufferKey, ID3D11Buffer*>(key, vertexBuffer));
+        }
+
+        vertexBuffer->AddRef();
+
+        return vertexBuffer;
+    }
+
+    ID3D11Buffer* ModelCache::FindOrCreateIndexBuffer(std::map<const void*, ID3D11Buffer*>& indexBuffers, const void* owner, const std::function<void(ID3D11Buffer**)>& create)
+    {
+        ID3D11Buffer* indexBuffer = nullptr;
+        std::map<const void*, ID3D11Buffer*>::iterator it = indexBuffers.find(owner);
+        if (it != indexBuffers.end())
+        {
+            indexBuffer = it->second;
+        }
+        else
+        {
+            LoadProfileScope profileScope("Buffer build", "indices");
+            create(&indexBuffer);
+            if (indexBuffer == nullptr)
+            {
+                return nullptr;
+            }
+
+            indexBuffers.insert(std::pair<const void*, ID3D11Buffer*>(owner, indexBuffer));
+        }
+
+        indexBuffer->AddRef();
+
+        return indexBuffer;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Common.h"
+#include "VertexDeclarations.h"
+#include <functional>
+
+namespace Library
+{
+    class Game;
+    class Model;
+    class Mesh;
+    class Material;
+    class CookedMesh;
+
+    // Process-wide cache of imported models. Each file is imported once per (path, import flags)
+    // and its vertex and index buffers are uploaded once per vertex format, no matter how many
+    // components place an instance of it in the scene.
+    //
+    // Cooked meshes (.pmesh next to the source file, see CookedMesh) are preferred when present;
+    // GetCookedMesh returns nullptr when the asset has not been cooked. The Model overloads return
+    // the merged buffers drawn through Model::Submeshes().
+    //
+    // Buffers are handed out with an extra reference (AddRef); callers release them as usual.
+    // Empty meshes get no buffer: the vertex and index overloads return nullptr for them.
+    class ModelCache : public RTTI
+    {
+        RTTI_DECLARATIONS(ModelCache, RTTI)
+
+    public:
+        ModelCache(Game& game);
+        ~ModelCache();
+
+        std::shared_ptr<Model> GetModel(const std::string& filename, bool flipUVs = false);
+
+        ID3D11Buffer* GetVertexBuffer(const Mesh& mesh, const Material& material);
+        ID3D11Buffer* GetVertexBuffer(const Mesh& mesh, VertexFormat format);
+        ID3D11Buffer* GetIndexBuffer(Mesh& mesh);
+        ID3D11Buffer* GetVertexBuffer(const Model& model, VertexFormat format);
+        ID3D11Buffer* GetIndexBuffer(const Model& model);
+
+        std::shared_ptr<CookedMesh> GetCookedMesh(const std::string& filename);
+
+        // Seed the cache with assets loaded elsewhere (see AssetLoader); existing entries win.
+        void AddModel(const std::string& filename, bool flipUVs, std::shared_ptr<Model> model);
+        void AddCookedMesh(const std::string& filename, std::shared_ptr<CookedMesh> cookedMesh);
+        ID3D11Buffer* GetVertexBuffer(const CookedMesh& mesh, VertexFormat format);
+        ID3D11Buffer* GetIndexBuffer(const CookedMesh& mesh);
+
+        // Index buffers in MeshQuantization::IndexFormat (16-bit whenever the vertex count allows)
+        ID3D11Buffer* GetCompactIndexBuffer(const Mesh& mesh);
+        ID3D11Buffer* GetCompactIndexBuffer(const CookedMesh& mesh);
+        ID3D11Buffer* GetCompactIndexBuffer(const Model& model);
+
+        UINT ModelCount() const;
+        UINT ImportCount() const;
+        UINT HitCount() const;
+        UINT VertexBufferCount() const;
+        UINT CookedMeshCount() const;
+
+        void Clear();
+
+    private:
+        ModelCache();
+        ModelCache(const ModelCache& rhs);
+        ModelCache& operator=(const ModelCache& rhs);
+
+        // Layouts named by VertexFormat are shared by every material that draws them; layouts only a
+        // material knows (Material::CreateVertexBuffer) are keyed by the material's type instead.
+        typedef struct _VertexBufferKey
+        {
+            const void* Owner;
+            VertexFormat Format;
+            UINT MaterialTypeId;
+
+            _VertexBufferKey(const void* owner, VertexFormat format)
+                : Owner(owner), Format(format), MaterialTypeId(0) { }
+
+            _VertexBufferKey(const void* owner, UINT materialTypeId)
+                : Owner(owner), Format(VertexFormatEnd), MaterialTypeId(materialTypeId) { }
+
+            bool operator<(const _VertexBufferKey& rhs) const
+            {
+                if (Owner != rhs.Owner)
+                {
+                    return Owner < rhs.Owner;
+                }
+
+                if (Format != rhs.Format)
+                {
+                    return Format < rhs.Format;
+                }
+
+                return MaterialTypeId < rhs.MaterialTypeId;
+            }
+        } VertexBufferKey;
+
+        static std::string ModelKey(const std::string& filename, bool flipUVs);
+
+        ID3D11Buffer* FindOrCreateVertexBuffer(const VertexBufferKey& key, const std::function<void(ID3D11Buffer**)>& create);
+        ID3D11Buffer* FindOrCreateIndexBuffer(std::map<const void*, ID3D11Buffer*>& indexBuffers, const void* owner, const std::function<void(ID3D11Buffer**)>& create);
+
+        Game& mGame;
+        std::map<std::string, std::shared_ptr<Model>> mModels;
+        std::map<std::string, std::shared_ptr<CookedMesh>> mCookedMeshes;
+        std::map<VertexBufferKey, ID3D11Buffer*> mVertexBuffers;
+        std::map<const void*, ID3D11Buffer*> mIndexBuffers;
+        std::map<const void*, ID3D11Buffer*> mCompactIndexBuffers;
+        UINT mImportCount;
+        UINT mHitCount;
+    };
+}
@@ -2,13 +2,13 @@
 
 #include "DrawableGameComponent.h"
 
+#include "TexturedModel.h"
 #include <DirectXCollision.h>
 
 using namespace Library;
 
 namespace Library
 {
-	class Mesh;
 	class ModelFromFile : public DrawableGameComponent
 	{
 		RTTI_DECLARATIONS(ModelFromFile, DrawableGameComponent)
@@ -39,6 +39,7 @@ namespace Library
 		int const KeyID() { return keyID; }
 
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		virtual void Draw(const GameTime& gameTime) override;
 
@@ -58,35 +59,12 @@ namespace Library
 		float translateY = 0.0f;
 		float translateZ = 0.0f;
 		bool taken;
-		typedef struct _TextureMappingVertex
-		{
-			XMFLOAT4 Position;
-			XMFLOAT2 TextureCoordinates;
-
-			_TextureMappingVertex() { }
-
-			_TextureMappingVertex(XMFLOAT4 position, XMFLOAT2 textureCoordinates)
-				: Position(position), TextureCoordinates(textureCoordinates) { }
-		} TextureMappingVertex;
 
 		ModelFromFile();
 		ModelFromFile(const ModelFromFile& rhs);
 		ModelFromFile& operator=(const ModelFromFile& rhs);
 
-		void CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const;
-
-		ID3DX11Effect* mEffect;
-		ID3DX11EffectTechnique* mTechnique;
-		ID3DX11EffectPass* mPass;
-		ID3DX11EffectMatrixVariable* mWvpVariable;
-
-		ID3D11ShaderResourceView* mTextureShaderResourceView;
-		ID3DX11EffectShaderResourceVariable* mColorTextureVariable;
-
-		ID3D11InputLayout* mInputLayout;
-		ID3D11Buffer* mVertexBuffer;
-		ID3D11Buffer* mIndexBuffer;
-		UINT mIndexCount;
+		TexturedModel mTexturedModel;
 
 		XMFLOAT4X4 mWorldMatrix;
 		float mAngle;
@@ -4,8 +4,8 @@
 
 namespace Library
 {
-	Pass::Pass(Game& game, Technique& technique, ID3DX11EffectPass* pass)
-		: mGame(game), mTechnique(technique), mPass(pass), mPassDesc(), mName()
+	Pass::Pass(Game& game, Technique& technique, ID3DX11EffectPass* pass, PassHandle handle)
+		: mGame(game), mTechnique(technique), mPass(pass), mPassDesc(), mName(), mHandle(handle)
 	{
 		mPass->GetDesc(&mPassDesc);
 		mName = mPassDesc.Name;
@@ -16,6 +16,11 @@ namespace Library
 		return mTechnique;
 	}
 
+	PassHandle Pass::Handle() const
+	{
+		return mHandle;
+	}
+
 	ID3DX11EffectPass* Pass::GetPass() const
 	{
 		return mPass;
@@ -7,12 +7,16 @@ namespace Library
     class Game;
     class Technique;
 
+    // Index of a pass among all the passes of its effect, in technique order
+    typedef UINT PassHandle;
+
     class Pass
     {
     public:
-        Pass(Game& game, Technique& technique, ID3DX11EffectPass* pass);
+        Pass(Game& game, Technique& technique, ID3DX11EffectPass* pass, PassHandle handle);
 
         Technique& GetTechnique();
+        PassHandle Handle() const;
         ID3DX11EffectPass* GetPass() const;
         const D3DX11_PASS_DESC& PassDesc() const;
         const std::string& Name() const;
@@ -29,5 +33,6 @@ namespace Library
         ID3DX11EffectPass* mPass;
         D3DX11_PASS_DESC mPassDesc;
         std::string mName;
+        PassHandle mHandle;
     };
 }
\ No newline at end of file
@@ -37,16 +37,16 @@ namespace Library
 
 	void PostProcessingMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
 	{
-		const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
-		std::vector<XMFLOAT3>* textureCoordinates = mesh.TextureCoordinates().at(0);
-		assert(textureCoordinates->size() == sourceVertices.size());
+		const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+		assert(textureCoordinates.size() == sourceVertices.size());
 
 		std::vector<VertexPositionTexture> vertices;
 		vertices.reserve(sourceVertices.size());
 		for (UINT i = 0; i < sourceVertices.size(); i++)
 		{
 			XMFLOAT3 position = sourceVertices.at(i);
-			XMFLOAT3 uv = textureCoordinates->at(i);
+			XMFLOAT3 uv = textureCoordinates.at(i);
 			vertices.push_back(VertexPositionTexture(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y)));
 		}
 
@@ -66,18 +66,18 @@ namespace Library
 
     void ProjectiveTextureMappingMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
     {
-		const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
-		std::vector<XMFLOAT3>* textureCoordinates = mesh.TextureCoordinates().at(0);
-		assert(textureCoordinates->size() == sourceVertices.size());
-		const std::vector<XMFLOAT3>& normals = mesh.Normals();
-		assert(textureCoordinates->size() == sourceVertices.size());
+		const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+		assert(textureCoordinates.size() == sourceVertices.size());
+		const Span<XMFLOAT3>& normals = mesh.Normals();
+		assert(textureCoordinates.size() == sourceVertices.size());
 
 		std::vector<VertexPositionTextureNormal> vertices;
 		vertices.reserve(sourceVertices.size());
 		for (UINT i = 0; i < sourceVertices.size(); i++)
 		{
 			XMFLOAT3 position = sourceVertices.at(i);
-			XMFLOAT3 uv = textureCoordinates->at(i);
+			XMFLOAT3 uv = textureCoordinates.at(i);
 			XMFLOAT3 normal = normals.at(i);
 			vertices.push_back(VertexPositionTextureNormal(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal));
 		}
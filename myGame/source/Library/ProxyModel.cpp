@@ -7,6 +7,8 @@
 #include "VectorHelper.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "ModelCache.h"
+#include "EffectRegistry.h"
 #include "Utility.h"
 #include "RasterizerStates.h"
 
@@ -27,7 +29,6 @@ namespace Library
 	ProxyModel::~ProxyModel()
 	{
 		DeleteObject(mMaterial);
-		DeleteObject(mEffect);
 		ReleaseObject(mVertexBuffer);
 		ReleaseObject(mIndexBuffer);
 	}
@@ -122,18 +123,33 @@ namespace Library
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-		std::unique_ptr<Model> model(new Model(*mGame, mModelFileName, true));
+		EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+		assert(effectRegistry != nullptr);
 
-		mEffect = new Effect(*mGame);
-		mEffect->LoadCompiledEffect(L"Content\\Effects\\BasicEffect.cso");
+		mEffect = effectRegistry->GetEffect(L"Content\\Effects\\BasicEffect.cso");
 
 		mMaterial = new BasicMaterial();
 		mMaterial->Initialize(*mEffect);
 
-		Mesh* mesh = model->Meshes().at(0);
-		mMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mVertexBuffer);
-		mesh->CreateIndexBuffer(&mIndexBuffer);
-		mIndexCount = mesh->Indices().size();
+		ModelCache* modelCache = (ModelCache*)mGame->Services().GetService(ModelCache::TypeIdClass());
+		if (modelCache != nullptr)
+		{
+			std::shared_ptr<Model> model = modelCache->GetModel(mModelFileName, true);
+
+			Mesh* mesh = model->Meshes().at(0);
+			mVertexBuffer = modelCache->GetVertexBuffer(*mesh, *mMaterial);
+			mIndexBuffer = modelCache->GetIndexBuffer(*mesh);
+			mIndexCount = mesh->Indices().size();
+		}
+		else
+		{
+			std::unique_ptr<Model> model(new Model(*mGame, mModelFileName, true));
+
+			Mesh* mesh = model->Meshes().at(0);
+			mMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mVertexBuffer);
+			mesh->CreateIndexBuffer(&mIndexBuffer);
+			mIndexCount = mesh->Indices().size();
+		}
 	}
 
 	void ProxyModel::Update(const GameTime& gameTime)
@@ -153,7 +169,7 @@ namespace Library
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		Pass* pass = mMaterial->CurrentTechnique()->Passes().at(0);		
-		ID3D11InputLayout* inputLayout = mMaterial->InputLayouts().at(pass);
+		ID3D11InputLayout* inputLayout = mMaterial->InputLayout(*pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);
 
 		UINT stride = mMaterial->VertexSize();
@@ -45,7 +45,7 @@ namespace Library
 		ProxyModel& operator=(const ProxyModel& rhs);
 
 		std::string mModelFileName;
-		Effect* mEffect;
+		std::shared_ptr<Effect> mEffect;
 		BasicMaterial* mMaterial;
 		ID3D11Buffer* mVertexBuffer;
 		ID3D11Buffer* mIndexBuffer;
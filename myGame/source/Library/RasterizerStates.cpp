@@ -1,5 +1,5 @@
 #include "RasterizerStates.h"
-#include "GameException.h"
+#include "StateObjectCache.h"
 
 namespace Library
 {
@@ -8,21 +8,15 @@ namespace Library
 	ID3D11RasterizerState* RasterizerStates::DisabledCulling = nullptr;
 	ID3D11RasterizerState* RasterizerStates::Wireframe = nullptr;
 
-	void RasterizerStates::Initialize(ID3D11Device* direct3DDevice)
+	void RasterizerStates::Initialize(StateObjectCache& stateObjectCache)
 	{
-		assert(direct3DDevice != nullptr);
-
 		D3D11_RASTERIZER_DESC rasterizerStateDesc;
 		ZeroMemory(&rasterizerStateDesc, sizeof(rasterizerStateDesc));
 		rasterizerStateDesc.FillMode = D3D11_FILL_SOLID;
 		rasterizerStateDesc.CullMode = D3D11_CULL_BACK;
 		rasterizerStateDesc.DepthClipEnable = true;
 		
-		HRESULT hr = direct3DDevice->CreateRasterizerState(&rasterizerStateDesc, &BackCulling);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
-		}
+		BackCulling = stateObjectCache.GetRasterizerState(rasterizerStateDesc);
 		
 		ZeroMemory(&rasterizerStateDesc, sizeof(rasterizerStateDesc));
 		rasterizerStateDesc.FillMode = D3D11_FILL_SOLID;
@@ -30,33 +24,21 @@ namespace Library
 		rasterizerStateDesc.FrontCounterClockwise = true;
 		rasterizerStateDesc.DepthClipEnable = true;
 
-		hr = direct3DDevice->CreateRasterizerState(&rasterizerStateDesc, &FrontCulling);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
-		}
+		FrontCulling = stateObjectCache.GetRasterizerState(rasterizerStateDesc);
 
 		ZeroMemory(&rasterizerStateDesc, sizeof(rasterizerStateDesc));
 		rasterizerStateDesc.FillMode = D3D11_FILL_SOLID;
 		rasterizerStateDesc.CullMode = D3D11_CULL_NONE;
 		rasterizerStateDesc.DepthClipEnable = true;
 
-		hr = direct3DDevice->CreateRasterizerState(&rasterizerStateDesc, &DisabledCulling);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
-		}
+		DisabledCulling = stateObjectCache.GetRasterizerState(rasterizerStateDesc);
 
 		ZeroMemory(&rasterizerStateDesc, sizeof(rasterizerStateDesc));
 		rasterizerStateDesc.FillMode = D3D11_FILL_WIREFRAME;
 		rasterizerStateDesc.CullMode = D3D11_CULL_NONE;
 		rasterizerStateDesc.DepthClipEnable = true;
 
-		hr = direct3DDevice->CreateRasterizerState(&rasterizerStateDesc, &Wireframe);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
-		}
+		Wireframe = stateObjectCache.GetRasterizerState(rasterizerStateDesc);
 	}
 
 	void RasterizerStates::Release()
@@ -4,6 +4,8 @@
 
 namespace Library
 {
+	class StateObjectCache;
+
 	class RasterizerStates
 	{
 	public:
@@ -12,7 +14,7 @@ namespace Library
 		static ID3D11RasterizerState* DisabledCulling;
 		static ID3D11RasterizerState* Wireframe;
 
-		static void Initialize(ID3D11Device* direct3DDevice);
+		static void Initialize(StateObjectCache& stateObjectCache);
 		static void Release();
 
 	private:
@@ -0,0 +1,107 @@
+#include "RenderStatistics.h"
+#include "GameTime.h"
+#include "Variable.h"
+#include <sstream>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(RenderStatistics)
+
+    RenderStatistics::RenderStatistics()
+        : mDrawCount(0), mTriangleCount(0), mFullDetailTriangleCount(0), mPerformedVariableSetsAtBeginFrame(0), mElidedVariableSetsAtBeginFrame(0), mUploadStatsAtBeginFrame(), mReportEnabled(false), mLastReportTime(0.0)
+    {
+#if defined(DEBUG) || defined(_DEBUG)
+        mReportEnabled = true;
+#endif
+    }
+
+    void RenderStatistics::BeginFrame()
+    {
+        mDrawCount = 0;
+        mTriangleCount = 0;
+        mFullDetailTriangleCount = 0;
+        mPerformedVariableSetsAtBeginFrame = Variable::PerformedSetCount();
+        mElidedVariableSetsAtBeginFrame = Variable::ElidedSetCount();
+        D3DX11GetEffectUploadStats(&mUploadStatsAtBeginFrame);
+    }
+
+    void RenderStatistics::EndFrame(const GameTime& gameTime)
+    {
+        if (mReportEnabled == false || gameTime.TotalGameTime() - mLastReportTime < 1.0)
+        {
+            return;
+        }
+
+        mLastReportTime = gameTime.TotalGameTime();
+
+        std::wostringstream report;
+        report << L"Draws: " << mDrawCount << L", triangles: " << mTriangleCount << L" of " << mFullDetailTriangleCount << L" at full detail";
+        if (mFullDetailTriangleCount > 0)
+        {
+            report << L" (" << (100ULL * mTriangleCount / mFullDetailTriangleCount) << L"%)";
+        }
+        report << L", variable sets: " << PerformedVariableSetCount() << L" performed, " << ElidedVariableSetCount() << L" elided";
+
+        D3DX11_EFFECT_UPLOAD_STATS uploads = ConstantBufferUploads();
+        report << L", constant buffer uploads: " << uploads.BytesUploaded << L" bytes (" << uploads.FullUpdates << L" full, " << uploads.PartialUpdates << L" partial, " << uploads.DiscardMaps << L" discard)";
+        report << std::endl;
+
+        OutputDebugString(report.str().c_str());
+    }
+
+    void RenderStatistics::AddDraw(UINT triangleCount, UINT fullDetailTriangleCount)
+    {
+        mDrawCount++;
+        mTriangleCount += triangleCount;
+        mFullDetailTriangleCount += fullDetailTriangleCount;
+    }
+
+    bool RenderStatistics::ReportEnabled() const
+    {
+        return mReportEnabled;
+    }
+
+    void RenderStatistics::SetReportEnabled(bool enabled)
+    {
+        mReportEnabled = enabled;
+    }
+
+    UINT RenderStatistics::DrawCount() const
+    {
+        return mDrawCount;
+    }
+
+    UINT RenderStatistics::TriangleCount() const
+    {
+        return mTriangleCount;
+    }
+
+    UINT RenderStatistics::FullDetailTriangleCount() const
+    {
+        return mFullDetailTriangleCount;
+    }
+
+    // Since BeginFrame()
+    UINT64 RenderStatistics::PerformedVariableSetCount() const
+    {
+        return Variable::PerformedSetCount() - mPerformedVariableSetsAtBeginFrame;
+    }
+
+    UINT64 RenderStatistics::ElidedVariableSetCount() const
+    {
+        return Variable::ElidedSetCount() - mElidedVariableSetsAtBeginFrame;
+    }
+
+    D3DX11_EFFECT_UPLOAD_STATS RenderStatistics::ConstantBufferUploads() const
+    {
+        D3DX11_EFFECT_UPLOAD_STATS uploads;
+        D3DX11GetEffectUploadStats(&uploads);
+
+        uploads.BytesUploaded -= mUploadStatsAtBeginFrame.BytesUploaded;
+        uploads.FullUpdates -= mUploadStatsAtBeginFrame.FullUpdates;
+        uploads.PartialUpdates -= mUploadStatsAtBeginFrame.PartialUpdates;
+        uploads.DiscardMaps -= mUploadStatsAtBeginFrame.DiscardMaps;
+
+        return uploads;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    class GameTime;
+
+    // Per-frame draw counters. Components report each draw along with the triangle count the
+    // same draw would have had at full detail, so the level-of-detail saving can be measured.
+    // Effect variable sets are counted too, split into those performed and those skipped
+    // because the value had not changed, as are the effects' constant buffer uploads.
+    // Callers read the counters; the totals are also written to the debug output once a second
+    // when reporting is enabled, which it is by default in debug builds only.
+    class RenderStatistics : public RTTI
+    {
+        RTTI_DECLARATIONS(RenderStatistics, RTTI)
+
+    public:
+        RenderStatistics();
+
+        void BeginFrame();
+        void EndFrame(const GameTime& gameTime);
+        void AddDraw(UINT triangleCount, UINT fullDetailTriangleCount);
+
+        bool ReportEnabled() const;
+        void SetReportEnabled(bool enabled);
+
+        UINT DrawCount() const;
+        UINT TriangleCount() const;
+        UINT FullDetailTriangleCount() const;
+        UINT64 PerformedVariableSetCount() const;
+        UINT64 ElidedVariableSetCount() const;
+        D3DX11_EFFECT_UPLOAD_STATS ConstantBufferUploads() const;
+
+    private:
+        RenderStatistics(const RenderStatistics& rhs);
+        RenderStatistics& operator=(const RenderStatistics& rhs);
+
+        UINT mDrawCount;
+        UINT mTriangleCount;
+        UINT mFullDetailTriangleCount;
+        UINT64 mPerformedVariableSetsAtBeginFrame;
+        UINT64 mElidedVariableSetsAtBeginFrame;
+        D3DX11_EFFECT_UPLOAD_STATS mUploadStatsAtBeginFrame;
+        bool mReportEnabled;
+        double mLastReportTime;
+    };
+}
@@ -7,6 +7,7 @@
 #include "MatrixHelper.h"
 #include "VectorHelper.h"
 #include "Camera.h"
+#include "EffectRegistry.h"
 #include "VertexDeclarations.h"
 
 namespace Library
@@ -41,7 +42,7 @@ namespace Library
 
     RenderableFrustum::RenderableFrustum(Game& game, Camera& camera)
         : DrawableGameComponent(game, camera),
-          mVertexBuffer(nullptr), mIndexBuffer(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),          
+          mVertexBuffer(nullptr), mIndexBuffer(nullptr), mEffect(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),          
 		  mColor(DefaultColor), mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right),
 		  mWorldMatrix(MatrixHelper::Identity)
     {
@@ -49,7 +50,7 @@ namespace Library
 
 	RenderableFrustum::RenderableFrustum(Game& game, Camera& camera, const XMFLOAT4& color)
         : DrawableGameComponent(game, camera),
-          mVertexBuffer(nullptr), mIndexBuffer(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),          
+          mVertexBuffer(nullptr), mIndexBuffer(nullptr), mEffect(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),          
 		  mColor(color), mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right),
 		  mWorldMatrix(MatrixHelper::Identity)
     {
@@ -60,12 +61,7 @@ namespace Library
         ReleaseObject(mIndexBuffer);
         ReleaseObject(mVertexBuffer);
 
-		if (mMaterial != nullptr)
-		{
-			delete mMaterial->GetEffect();
-			delete mMaterial;
-			mMaterial = nullptr;
-		}
+		DeleteObject(mMaterial);
     }
 
 	const XMFLOAT3& RenderableFrustum::Position() const
@@ -156,14 +152,16 @@ namespace Library
 
     void RenderableFrustum::Initialize()
 	{
-		Effect* effect = new Effect(*mGame);
-		effect->LoadCompiledEffect(L"Content\\Effects\\BasicEffect.cso");
+		EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+		assert(effectRegistry != nullptr);
+
+		mEffect = effectRegistry->GetEffect(L"Content\\Effects\\BasicEffect.cso");
 		
 		mMaterial = new BasicMaterial();
-		mMaterial->Initialize(*effect);
+		mMaterial->Initialize(*mEffect);
 
 		mPass = mMaterial->CurrentTechnique()->Passes().at(0);
-		mInputLayout = mMaterial->InputLayouts().at(mPass);
+		mInputLayout = mMaterial->InputLayout(*mPass);
 
 		InitializeIndexBuffer();
 	}
@@ -5,6 +5,7 @@
 
 namespace Library
 {
+    class Effect;
     class BasicMaterial;
 	class Pass;
 	
@@ -57,6 +58,7 @@ namespace Library
 
 		ID3D11Buffer* mVertexBuffer;
         ID3D11Buffer* mIndexBuffer;
+        std::shared_ptr<Effect> mEffect;
         BasicMaterial* mMaterial;
         Pass* mPass;
 		ID3D11InputLayout* mInputLayout;
@@ -1,5 +1,5 @@
 #include "SamplerStates.h"
-#include "GameException.h"
+#include "StateObjectCache.h"
 
 namespace Library
 {
@@ -10,10 +10,8 @@ namespace Library
 
 	XMVECTORF32 SamplerStates::BorderColor = { 0.0f, 0.0f, 0.0f, 1.0f };
 
-	void SamplerStates::Initialize(ID3D11Device* direct3DDevice)
+	void SamplerStates::Initialize(StateObjectCache& stateObjectCache)
 	{
-		assert(direct3DDevice != nullptr);
-
 		D3D11_SAMPLER_DESC samplerStateDesc;
 		ZeroMemory(&samplerStateDesc, sizeof(samplerStateDesc));
 		samplerStateDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -21,11 +19,7 @@ namespace Library
 		samplerStateDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
 		samplerStateDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
 		
-		HRESULT hr = direct3DDevice->CreateSamplerState(&samplerStateDesc, &TrilinearWrap);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateSamplerState() failed.", hr);
-		}
+		TrilinearWrap = stateObjectCache.GetSamplerState(samplerStateDesc);
 		
 		ZeroMemory(&samplerStateDesc, sizeof(samplerStateDesc));
 		samplerStateDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -33,11 +27,7 @@ namespace Library
 		samplerStateDesc.AddressV = D3D11_TEXTURE_ADDRESS_MIRROR;
 		samplerStateDesc.AddressW = D3D11_TEXTURE_ADDRESS_MIRROR;
 
-		hr = direct3DDevice->CreateSamplerState(&samplerStateDesc, &TrilinearMirror);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateSamplerState() failed.", hr);
-		}
+		TrilinearMirror = stateObjectCache.GetSamplerState(samplerStateDesc);
 
 		ZeroMemory(&samplerStateDesc, sizeof(samplerStateDesc));
 		samplerStateDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -45,11 +35,7 @@ namespace Library
 		samplerStateDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
 		samplerStateDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
 
-		hr = direct3DDevice->CreateSamplerState(&samplerStateDesc, &TrilinearClamp);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateSamplerState() failed.", hr);
-		}
+		TrilinearClamp = stateObjectCache.GetSamplerState(samplerStateDesc);
 
 		ZeroMemory(&samplerStateDesc, sizeof(samplerStateDesc));
 		samplerStateDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -58,11 +44,7 @@ namespace Library
 		samplerStateDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
 		memcpy(samplerStateDesc.BorderColor, reinterpret_cast<FLOAT*>(&BorderColor), sizeof(FLOAT) * 4);
 
-		hr = direct3DDevice->CreateSamplerState(&samplerStateDesc, &TrilinerBorder);
-		if (FAILED(hr))
-		{
-			throw GameException("ID3D11Device::CreateSamplerState() failed.", hr);
-		}
+		TrilinerBorder = stateObjectCache.GetSamplerState(samplerStateDesc);
 	}
 
 	void SamplerStates::Release()
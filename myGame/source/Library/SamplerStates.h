@@ -4,6 +4,8 @@
 
 namespace Library
 {
+	class StateObjectCache;
+
 	class SamplerStates
 	{
 	public:
@@ -14,7 +16,7 @@ namespace Library
 		
 		static XMVECTORF32 BorderColor;
 
-		static void Initialize(ID3D11Device* direct3DDevice);
+		static void Initialize(StateObjectCache& stateObjectCache);
 		static void Release();
 
 	private:
@@ -6,49 +6,43 @@ namespace Library
 {
     RTTI_DEFINITIONS(ShadowMappingMaterial)	
 
+    const char* const ShadowMappingMaterialConstants::ConstantBufferName = "CBufferPerObject";
+
+    const MaterialConstantMember ShadowMappingMaterialConstants::Members[] =
+    {
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, WorldViewProjection),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, World),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, SpecularColor),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, SpecularPower),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, ProjectiveTextureMatrix),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, PositionScale),
+        MATERIAL_CONSTANT_MEMBER(ShadowMappingMaterialConstants, PositionOffset)
+    };
+
+    const UINT ShadowMappingMaterialConstants::MemberCount = ARRAYSIZE(ShadowMappingMaterialConstants::Members);
+
     ShadowMappingMaterial::ShadowMappingMaterial()
         : Material("shadow_mapping"),
-          MATERIAL_VARIABLE_INITIALIZATION(WorldViewProjection), MATERIAL_VARIABLE_INITIALIZATION(World),
-		  MATERIAL_VARIABLE_INITIALIZATION(SpecularColor), MATERIAL_VARIABLE_INITIALIZATION(SpecularPower),
-		  MATERIAL_VARIABLE_INITIALIZATION(AmbientColor), MATERIAL_VARIABLE_INITIALIZATION(LightColor),
-		  MATERIAL_VARIABLE_INITIALIZATION(LightPosition), MATERIAL_VARIABLE_INITIALIZATION(LightRadius),
-		  MATERIAL_VARIABLE_INITIALIZATION(CameraPosition), MATERIAL_VARIABLE_INITIALIZATION(ColorTexture),
-		  MATERIAL_VARIABLE_INITIALIZATION(ProjectiveTextureMatrix), MATERIAL_VARIABLE_INITIALIZATION(ShadowMap),
-		  MATERIAL_VARIABLE_INITIALIZATION(ShadowMapSize)
+		  MATERIAL_VARIABLE_INITIALIZATION(ColorTexture), MATERIAL_VARIABLE_INITIALIZATION(ShadowMap),
+		  mConstants()
     {
     }
 
-    MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, WorldViewProjection)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, World)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, SpecularColor)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, SpecularPower)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, AmbientColor)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, LightColor)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, LightPosition)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, LightRadius)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, CameraPosition)
 	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, ColorTexture)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, ProjectiveTextureMatrix)
 	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, ShadowMap)
-	MATERIAL_VARIABLE_DEFINITION(ShadowMappingMaterial, ShadowMapSize)
+
+    MaterialConstants<ShadowMappingMaterialConstants>& ShadowMappingMaterial::Constants()
+    {
+        return mConstants;
+    }
 
     void ShadowMappingMaterial::Initialize(Effect& effect)
     {
         Material::Initialize(effect);
 
-        MATERIAL_VARIABLE_RETRIEVE(WorldViewProjection)
-		MATERIAL_VARIABLE_RETRIEVE(World)
-		MATERIAL_VARIABLE_RETRIEVE(SpecularColor)
-		MATERIAL_VARIABLE_RETRIEVE(SpecularPower)
-		MATERIAL_VARIABLE_RETRIEVE(AmbientColor)
-		MATERIAL_VARIABLE_RETRIEVE(LightColor)
-		MATERIAL_VARIABLE_RETRIEVE(LightPosition)
-		MATERIAL_VARIABLE_RETRIEVE(LightRadius)
-		MATERIAL_VARIABLE_RETRIEVE(CameraPosition)
 		MATERIAL_VARIABLE_RETRIEVE(ColorTexture)
-		MATERIAL_VARIABLE_RETRIEVE(ProjectiveTextureMatrix)
 		MATERIAL_VARIABLE_RETRIEVE(ShadowMap)
-		MATERIAL_VARIABLE_RETRIEVE(ShadowMapSize)
+		mConstants.Bind(effect);
 
         D3D11_INPUT_ELEMENT_DESC inputElementDescriptions[] =
         {
@@ -60,22 +54,33 @@ namespace Library
 		CreateInputLayout("shadow_mapping", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));
 		CreateInputLayout("shadow_mapping_manual_pcf", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));
 		CreateInputLayout("shadow_mapping_pcf", "p0", inputElementDescriptions, ARRAYSIZE(inputElementDescriptions));
+
+		D3D11_INPUT_ELEMENT_DESC compactInputElementDescriptions[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+		};
+
+		CreateInputLayout("shadow_mapping_compact", "p0", compactInputElementDescriptions, ARRAYSIZE(compactInputElementDescriptions));
+		CreateInputLayout("shadow_mapping_manual_pcf_compact", "p0", compactInputElementDescriptions, ARRAYSIZE(compactInputElementDescriptions));
+		CreateInputLayout("shadow_mapping_pcf_compact", "p0", compactInputElementDescriptions, ARRAYSIZE(compactInputElementDescriptions));
     }
 
     void ShadowMappingMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
     {
-		const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
-		std::vector<XMFLOAT3>* textureCoordinates = mesh.TextureCoordinates().at(0);
-		assert(textureCoordinates->size() == sourceVertices.size());
-		const std::vector<XMFLOAT3>& normals = mesh.Normals();
-		assert(textureCoordinates->size() == sourceVertices.size());
+		const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const Span<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+		assert(textureCoordinates.size() == sourceVertices.size());
+		const Span<XMFLOAT3>& normals = mesh.Normals();
+		assert(textureCoordinates.size() == sourceVertices.size());
 
 		std::vector<VertexPositionTextureNormal> vertices;
 		vertices.reserve(sourceVertices.size());
 		for (UINT i = 0; i < sourceVertices.size(); i++)
 		{
 			XMFLOAT3 position = sourceVertices.at(i);
-			XMFLOAT3 uv = textureCoordinates->at(i);
+			XMFLOAT3 uv = textureCoordinates.at(i);
 			XMFLOAT3 normal = normals.at(i);
 			vertices.push_back(VertexPositionTextureNormal(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal));
 		}
@@ -104,4 +109,9 @@ namespace Library
     {
         return sizeof(VertexPositionTextureNormal);
     }
+
+    UINT ShadowMappingMaterial::CompactVertexSize() const
+    {
+        return sizeof(VertexPositionTextureNormalQuantized);
+    }
 }
\ No newline at end of file
@@ -3,34 +3,56 @@
 #include "Common.h"
 #include "Material.h"
 #include "VertexDeclarations.h"
+#include "MaterialConstants.h"
 
 namespace Library
 {
+    // Mirrors CBufferPerObject in Content\Effects\ShadowMapping.fx; matrices go in through
+    // MaterialConstantBlock::StoreMatrix()
+    typedef struct _ShadowMappingMaterialConstants
+    {
+        XMFLOAT4X4 WorldViewProjection;
+        XMFLOAT4X4 World;
+        XMFLOAT4 SpecularColor;
+        float SpecularPower;
+        XMFLOAT3 Padding;
+        XMFLOAT4X4 ProjectiveTextureMatrix;
+        XMFLOAT3 PositionScale;
+        float Padding2;
+        XMFLOAT3 PositionOffset;
+        float Padding3;
+
+        static const char* const ConstantBufferName;
+        static const MaterialConstantMember Members[];
+        static const UINT MemberCount;
+
+        _ShadowMappingMaterialConstants()
+            : WorldViewProjection(), World(), SpecularColor(1.0f, 1.0f, 1.0f, 1.0f), SpecularPower(25.0f), Padding(0.0f, 0.0f, 0.0f),
+              ProjectiveTextureMatrix(), PositionScale(1.0f, 1.0f, 1.0f), Padding2(0.0f), PositionOffset(0.0f, 0.0f, 0.0f), Padding3(0.0f)
+        {
+        }
+    } ShadowMappingMaterialConstants;
+
     class ShadowMappingMaterial : public Material
     {
         RTTI_DECLARATIONS(ShadowMappingMaterial, Material)
 
-        MATERIAL_VARIABLE_DECLARATION(WorldViewProjection)
-		MATERIAL_VARIABLE_DECLARATION(World)
-		MATERIAL_VARIABLE_DECLARATION(SpecularColor)
-		MATERIAL_VARIABLE_DECLARATION(SpecularPower)
-		MATERIAL_VARIABLE_DECLARATION(AmbientColor)
-		MATERIAL_VARIABLE_DECLARATION(LightColor)
-		MATERIAL_VARIABLE_DECLARATION(LightPosition)
-		MATERIAL_VARIABLE_DECLARATION(LightRadius)
-		MATERIAL_VARIABLE_DECLARATION(CameraPosition)
-
 		MATERIAL_VARIABLE_DECLARATION(ColorTexture)
-		MATERIAL_VARIABLE_DECLARATION(ProjectiveTextureMatrix)
 		MATERIAL_VARIABLE_DECLARATION(ShadowMap)
-		MATERIAL_VARIABLE_DECLARATION(ShadowMapSize)
 
     public:
         ShadowMappingMaterial();
 
+        // The whole of CBufferPerObject; fill it and Commit() once per draw
+        MaterialConstants<ShadowMappingMaterialConstants>& Constants();
+
         virtual void Initialize(Effect& effect) override;		
         virtual void CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const override;
         void CreateVertexBuffer(ID3D11Device* device, VertexPositionTextureNormal* vertices, UINT vertexCount, ID3D11Buffer** vertexBuffer) const;
         virtual UINT VertexSize() const override;
+        UINT CompactVertexSize() const;
+
+    private:
+        MaterialConstants<ShadowMappingMaterialConstants> mConstants;
     };
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "Model.h"
 #include "Mesh.h"
 #include "Utility.h"
+#include "EffectRegistry.h"
+#include "AssetLoader.h"
 #include <DDSTextureLoader.h>
 
 namespace Library
@@ -26,19 +28,25 @@ namespace Library
 	{
 		ReleaseObject(mCubeMapShaderResourceView);
 		DeleteObject(mMaterial);
-		DeleteObject(mEffect);
 		ReleaseObject(mVertexBuffer);
 		ReleaseObject(mIndexBuffer);
 	}
 
+	void Skybox::RequestAssets(AssetLoader& assetLoader)
+	{
+		assetLoader.RequestEffect(L"Content\\Effects\\Skybox.cso");
+	}
+
 	void Skybox::Initialize()
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
 		std::unique_ptr<Model> model(new Model(*mGame, "Content\\Models\\Sphere.obj", true));
 
-		mEffect = new Effect(*mGame);
-		mEffect->LoadCompiledEffect(L"Content\\Effects\\Skybox.cso");
+		EffectRegistry* effectRegistry = (EffectRegistry*)mGame->Services().GetService(EffectRegistry::TypeIdClass());
+		assert(effectRegistry != nullptr);
+
+		mEffect = effectRegistry->GetEffect(L"Content\\Effects\\Skybox.cso");
 
 		mMaterial = new SkyboxMaterial();
 		mMaterial->Initialize(*mEffect);
@@ -68,7 +76,7 @@ namespace Library
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		Pass* pass = mMaterial->CurrentTechnique()->Passes().at(0);		
-		ID3D11InputLayout* inputLayout = mMaterial->InputLayouts().at(pass);
+		ID3D11InputLayout* inputLayout = mMaterial->InputLayout(*pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);
 
 		UINT stride = mMaterial->VertexSize();
@@ -16,6 +16,7 @@ namespace Library
 		Skybox(Game& game, Camera& camera, const std::wstring& cubeMapFileName, float scale);
 		~Skybox();
 
+		virtual void RequestAssets(AssetLoader& assetLoader) override;
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;		
 		virtual void Draw(const GameTime& gameTime) override;
@@ -26,7 +27,7 @@ namespace Library
 		Skybox& operator=(const Skybox& rhs);
 
 		std::wstring mCubeMapFileName;
-		Effect* mEffect;
+		std::shared_ptr<Effect> mEffect;
 		SkyboxMaterial* mMaterial;
 		ID3D11ShaderResourceView* mCubeMapShaderResourceView;
 		ID3D11Buffer* mVertexBuffer;
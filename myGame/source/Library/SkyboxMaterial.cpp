@@ -32,7 +32,7 @@ namespace Library
 
 	void SkyboxMaterial::CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const
 	{
-		const std::vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const Span<XMFLOAT3>& sourceVertices = mesh.Vertices();
 
 		std::vector<XMFLOAT4> vertices;
 		vertices.reserve(sourceVertices.size());
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Common.h"
+#include <stdexcept>
+
+namespace Library
+{
+    // Read-only, non-owning view over a contiguous run of elements. Mirrors the parts of the
+    // std::vector interface the materials use, so a Mesh can hand out views into its single
+    // storage block in place of individual vectors.
+    template <typename T>
+    class Span
+    {
+    public:
+        Span()
+            : mData(nullptr), mSize(0)
+        {
+        }
+
+        Span(const T* data, UINT size)
+            : mData(data), mSize(size)
+        {
+        }
+
+        const T* data() const
+        {
+            return mData;
+        }
+
+        UINT size() const
+        {
+            return mSize;
+        }
+
+        bool empty() const
+        {
+            return mSize == 0;
+        }
+
+        const T* begin() const
+        {
+            return mData;
+        }
+
+        const T* end() const
+        {
+            return mData + mSize;
+        }
+
+        const T& operator[](UINT index) const
+        {
+            return mData[index];
+        }
+
+        const T& at(UINT index) const
+        {
+            if (index >= mSize)
+            {
+                throw std::out_of_range("Span index out of range.");
+            }
+
+            return mData[index];
+        }
+
+    private:
+        const T* mData;
+        UINT mSize;
+    };
+}
@@ -0,0 +1,19 @@
+#include "SpriteFontLoader.h"
+#include "GameException.h"
+#include "VirtualFileSystem.h"
+#include <SpriteFont.h>
+
+namespace Library
+{
+    // The font parses its glyphs out of the blob while it is constructed, so the file can go afterwards
+    DirectX::SpriteFont* SpriteFontLoader::CreateSpriteFont(ID3D11Device* device, const std::wstring& filename)
+    {
+        FileData file;
+        if (VirtualFileSystem::Open(filename, file) == false)
+        {
+            throw GameException("Could not open sprite font.", HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+        }
+
+        return new DirectX::SpriteFont(device, file.Data(), static_cast<size_t>(file.Size()));
+    }
+}
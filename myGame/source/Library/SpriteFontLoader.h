@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Common.h"
+
+namespace DirectX
+{
+    class SpriteFont;
+}
+
+namespace Library
+{
+    // Builds DirectXTK sprite fonts from bytes read through the VirtualFileSystem, so fonts come out
+    // of the content archive like every other asset instead of being opened from disk by DirectXTK.
+    class SpriteFontLoader
+    {
+    public:
+        static DirectX::SpriteFont* CreateSpriteFont(ID3D11Device* device, const std::wstring& filename);
+
+    private:
+        SpriteFontLoader();
+        SpriteFontLoader(const SpriteFontLoader& rhs);
+        SpriteFontLoader& operator=(const SpriteFontLoader& rhs);
+    };
+}
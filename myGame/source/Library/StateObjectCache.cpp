@@ -0,0 +1,379 @@
+#include "StateObjectCache.h"
+#include "Game.h"
+#include "GameException.h"
+#include <sstream>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(StateObjectCache)
+
+    const std::wstring StateObjectCache::TypeNames[] = { L"rasterizer", L"blend", L"depth-stencil", L"sampler" };
+
+    StateObjectCache::StateObjectCache(Game& game)
+        : mGame(game), mEffectStateFactory(*this), mMutex(), mStates(), mCreateCount(0), mHitCount(0)
+    {
+        D3DX11SetEffectStateFactory(&mEffectStateFactory);
+    }
+
+    StateObjectCache::~StateObjectCache()
+    {
+        D3DX11SetEffectStateFactory(nullptr);
+        Clear();
+    }
+
+    ID3D11RasterizerState* StateObjectCache::GetRasterizerState(const D3D11_RASTERIZER_DESC& rasterizerStateDesc)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const BYTE* descBytes = reinterpret_cast<const BYTE*>(&rasterizerStateDesc);
+        std::vector<BYTE> key(descBytes, descBytes + sizeof(rasterizerStateDesc));
+        UINT64 hash = HashKey(StateObjectTypeRasterizer, key);
+
+        ID3D11DeviceChild* state = FindState(StateObjectTypeRasterizer, key, hash);
+        if (state == nullptr)
+        {
+            ID3D11RasterizerState* rasterizerState = nullptr;
+            HRESULT hr = mGame.Direct3DDevice()->CreateRasterizerState(&rasterizerStateDesc, &rasterizerState);
+            if (FAILED(hr))
+            {
+                throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
+            }
+
+            state = rasterizerState;
+            AddState(StateObjectTypeRasterizer, key, hash, state);
+        }
+
+        return static_cast<ID3D11RasterizerState*>(state);
+    }
+
+    ID3D11BlendState* StateObjectCache::GetBlendState(const D3D11_BLEND_DESC& blendStateDesc)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::vector<BYTE> key;
+        BuildKey(blendStateDesc, key);
+        UINT64 hash = HashKey(StateObjectTypeBlend, key);
+
+        ID3D11DeviceChild* state = FindState(StateObjectTypeBlend, key, hash);
+        if (state == nullptr)
+        {
+            ID3D11BlendState* blendState = nullptr;
+            HRESULT hr = mGame.Direct3DDevice()->CreateBlendState(&blendStateDesc, &blendState);
+            if (FAILED(hr))
+            {
+                throw GameException("ID3D11Device::CreateBlendState() failed.", hr);
+            }
+
+            state = blendState;
+            AddState(StateObjectTypeBlend, key, hash, state);
+        }
+
+        return static_cast<ID3D11BlendState*>(state);
+    }
+
+    ID3D11DepthStencilState* StateObjectCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& depthStencilStateDesc)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::vector<BYTE> key;
+        BuildKey(depthStencilStateDesc, key);
+        UINT64 hash = HashKey(StateObjectTypeDepthStencil, key);
+
+        ID3D11DeviceChild* state = FindState(StateObjectTypeDepthStencil, key, hash);
+        if (state == nullptr)
+        {
+            ID3D11DepthStencilState* depthStencilState = nullptr;
+            HRESULT hr = mGame.Direct3DDevice()->CreateDepthStencilState(&depthStencilStateDesc, &depthStencilState);
+            if (FAILED(hr))
+            {
+                throw GameException("ID3D11Device::CreateDepthStencilState() failed.", hr);
+            }
+
+            state = depthStencilState;
+            AddState(StateObjectTypeDepthStencil, key, hash, state);
+        }
+
+        return static_cast<ID3D11DepthStencilState*>(state);
+    }
+
+    ID3D11SamplerState* StateObjectCache::GetSamplerState(const D3D11_SAMPLER_DESC& samplerStateDesc)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const BYTE* descBytes = reinterpret_cast<const BYTE*>(&samplerStateDesc);
+        std::vector<BYTE> key(descBytes, descBytes + sizeof(samplerStateDesc));
+        UINT64 hash = HashKey(StateObjectTypeSampler, key);
+
+        ID3D11DeviceChild* state = FindState(StateObjectTypeSampler, key, hash);
+        if (state == nullptr)
+        {
+            ID3D11SamplerState* samplerState = nullptr;
+            HRESULT hr = mGame.Direct3DDevice()->CreateSamplerState(&samplerStateDesc, &samplerState);
+            if (FAILED(hr))
+            {
+                throw GameException("ID3D11Device::CreateSamplerState() failed.", hr);
+            }
+
+            state = samplerState;
+            AddState(StateObjectTypeSampler, key, hash, state);
+        }
+
+        return static_cast<ID3D11SamplerState*>(state);
+    }
+
+    void StateObjectCache::ReleaseState(ID3D11DeviceChild* state)
+    {
+        if (state == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (std::multimap<UINT64, StateObjectCacheEntry>::iterator it = mStates.begin(); it != mStates.end(); ++it)
+        {
+            if (it->second.State == state)
+            {
+                // The caller's reference and the cache's
+                if (state->Release() == 1)
+                {
+                    ReleaseObject(it->second.State);
+                    mStates.erase(it);
+                }
+
+                return;
+            }
+        }
+
+        state->Release();
+    }
+
+    UINT StateObjectCache::StateCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mStates.size();
+    }
+
+    UINT StateObjectCache::CreateCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mCreateCount;
+    }
+
+    UINT StateObjectCache::HitCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mHitCount;
+    }
+
+    void StateObjectCache::ReportUsage() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        UINT typeCounts[StateObjectTypeEnd] = { 0 };
+        for (const std::pair<const UINT64, StateObjectCacheEntry>& state : mStates)
+        {
+            typeCounts[state.second.Type]++;
+        }
+
+        std::wostringstream report;
+        report << L"State objects: " << mStates.size() << L" (" << mCreateCount << L" created, " << mHitCount << L" shared)";
+        for (UINT i = 0; i < StateObjectTypeEnd; i++)
+        {
+            report << L", " << typeCounts[i] << L" " << TypeNames[i];
+        }
+        report << std::endl;
+
+        OutputDebugString(report.str().c_str());
+    }
+
+    // Releases the states nothing holds any more
+    void StateObjectCache::Trim()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::multimap<UINT64, StateObjectCacheEntry>::iterator it = mStates.begin();
+        while (it != mStates.end())
+        {
+            ID3D11DeviceChild* state = it->second.State;
+            state->AddRef();
+            if (state->Release() == 1)
+            {
+                ReleaseObject(state);
+                it = mStates.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void StateObjectCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (std::pair<const UINT64, StateObjectCacheEntry>& state : mStates)
+        {
+            ReleaseObject(state.second.State);
+        }
+
+        mStates.clear();
+    }
+
+    // Blend and depth-stencil descriptions have padding after their UINT8 members, so their keys
+    // are built field by field rather than from the raw bytes
+    void StateObjectCache::BuildKey(const D3D11_BLEND_DESC& blendStateDesc, std::vector<BYTE>& key)
+    {
+        key.clear();
+        key.push_back(static_cast<BYTE>(blendStateDesc.AlphaToCoverageEnable != FALSE));
+        key.push_back(static_cast<BYTE>(blendStateDesc.IndependentBlendEnable != FALSE));
+
+        for (UINT i = 0; i < ARRAYSIZE(blendStateDesc.RenderTarget); i++)
+        {
+            const D3D11_RENDER_TARGET_BLEND_DESC& renderTarget = blendStateDesc.RenderTarget[i];
+            key.push_back(static_cast<BYTE>(renderTarget.BlendEnable != FALSE));
+            key.push_back(static_cast<BYTE>(renderTarget.SrcBlend));
+            key.push_back(static_cast<BYTE>(renderTarget.DestBlend));
+            key.push_back(static_cast<BYTE>(renderTarget.BlendOp));
+            key.push_back(static_cast<BYTE>(renderTarget.SrcBlendAlpha));
+            key.push_back(static_cast<BYTE>(renderTarget.DestBlendAlpha));
+            key.push_back(static_cast<BYTE>(renderTarget.BlendOpAlpha));
+            key.push_back(renderTarget.RenderTargetWriteMask);
+        }
+    }
+
+    void StateObjectCache::BuildKey(const D3D11_DEPTH_STENCIL_DESC& depthStencilStateDesc, std::vector<BYTE>& key)
+    {
+        key.clear();
+        key.push_back(static_cast<BYTE>(depthStencilStateDesc.DepthEnable != FALSE));
+        key.push_back(static_cast<BYTE>(depthStencilStateDesc.DepthWriteMask));
+        key.push_back(static_cast<BYTE>(depthStencilStateDesc.DepthFunc));
+        key.push_back(static_cast<BYTE>(depthStencilStateDesc.StencilEnable != FALSE));
+        key.push_back(depthStencilStateDesc.StencilReadMask);
+        key.push_back(depthStencilStateDesc.StencilWriteMask);
+
+        const D3D11_DEPTH_STENCILOP_DESC* faces[] = { &depthStencilStateDesc.FrontFace, &depthStencilStateDesc.BackFace };
+        for (const D3D11_DEPTH_STENCILOP_DESC* face : faces)
+        {
+            key.push_back(static_cast<BYTE>(face->StencilFailOp));
+            key.push_back(static_cast<BYTE>(face->StencilDepthFailOp));
+            key.push_back(static_cast<BYTE>(face->StencilPassOp));
+            key.push_back(static_cast<BYTE>(face->StencilFunc));
+        }
+    }
+
+    // 64-bit FNV-1a over the type and the description
+    UINT64 StateObjectCache::HashKey(StateObjectType type, const std::vector<BYTE>& key)
+    {
+        UINT64 hash = 14695981039346656037ULL;
+        hash ^= static_cast<BYTE>(type);
+        hash *= 1099511628211ULL;
+        for (BYTE value : key)
+        {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    ID3D11DeviceChild* StateObjectCache::FindState(StateObjectType type, const std::vector<BYTE>& key, UINT64 hash)
+    {
+        std::pair<std::multimap<UINT64, StateObjectCacheEntry>::iterator, std::multimap<UINT64, StateObjectCacheEntry>::iterator> range = mStates.equal_range(hash);
+        for (std::multimap<UINT64, StateObjectCacheEntry>::iterator it = range.first; it != range.second; ++it)
+        {
+            if (it->second.Type == type && it->second.Key == key)
+            {
+                mHitCount++;
+                it->second.State->AddRef();
+
+                return it->second.State;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Takes the reference the device returned for the cache and adds the caller's
+    void StateObjectCache::AddState(StateObjectType type, std::vector<BYTE>& key, UINT64 hash, ID3D11DeviceChild* state)
+    {
+        StateObjectCacheEntry entry;
+        entry.Type = type;
+        entry.Key.swap(key);
+        entry.State = state;
+
+        mStates.insert(std::pair<UINT64, StateObjectCacheEntry>(hash, entry));
+        mCreateCount++;
+
+        state->AddRef();
+    }
+
+    StateObjectCache::EffectStateFactory::EffectStateFactory(StateObjectCache& cache)
+        : mCache(cache)
+    {
+    }
+
+    // Effects11 expects HRESULTs; a failed creation leaves the block invalid, as it would without the cache
+    STDMETHODIMP StateObjectCache::EffectStateFactory::CreateRasterizerState(const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState)
+    {
+        try
+        {
+            *ppState = mCache.GetRasterizerState(*pDesc);
+        }
+        catch (GameException& ex)
+        {
+            *ppState = nullptr;
+            return ex.HR();
+        }
+
+        return S_OK;
+    }
+
+    STDMETHODIMP StateObjectCache::EffectStateFactory::CreateBlendState(const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState)
+    {
+        try
+        {
+            *ppState = mCache.GetBlendState(*pDesc);
+        }
+        catch (GameException& ex)
+        {
+            *ppState = nullptr;
+            return ex.HR();
+        }
+
+        return S_OK;
+    }
+
+    STDMETHODIMP StateObjectCache::EffectStateFactory::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState)
+    {
+        try
+        {
+            *ppState = mCache.GetDepthStencilState(*pDesc);
+        }
+        catch (GameException& ex)
+        {
+            *ppState = nullptr;
+            return ex.HR();
+        }
+
+        return S_OK;
+    }
+
+    STDMETHODIMP StateObjectCache::EffectStateFactory::CreateSamplerState(const D3D11_SAMPLER_DESC* pDesc, ID3D11SamplerState** ppState)
+    {
+        try
+        {
+            *ppState = mCache.GetSamplerState(*pDesc);
+        }
+        catch (GameException& ex)
+        {
+            *ppState = nullptr;
+            return ex.HR();
+        }
+
+        return S_OK;
+    }
+}
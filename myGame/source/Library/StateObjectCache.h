@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Common.h"
+#include <mutex>
+
+namespace Library
+{
+    class Game;
+
+    // Process-wide cache of rasterizer, blend, depth-stencil and sampler states. Equal descriptions
+    // (compared field by field, found through a hash of the description) get the same object, so a
+    // state toggled back and forth is created once and identical states collapse to one object.
+    //
+    // The cache is also installed as the Effects11 state factory (D3DX11SetEffectStateFactory), so
+    // effect state blocks share these objects with each other and with the Library code.
+    //
+    // States are handed out with an extra reference (AddRef); callers release them as usual, or
+    // with ReleaseState() when the description is unlikely to come back. The cache keeps its own
+    // reference until Trim() finds it is the last one, or Clear().
+    //
+    // Effects loaded on worker threads (EffectRegistry::LoadEffectAsync) create their states through
+    // the cache concurrently, so every method takes the cache's lock.
+    class StateObjectCache : public RTTI
+    {
+        RTTI_DECLARATIONS(StateObjectCache, RTTI)
+
+    public:
+        StateObjectCache(Game& game);
+        ~StateObjectCache();
+
+        ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC& rasterizerStateDesc);
+        ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC& blendStateDesc);
+        ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& depthStencilStateDesc);
+        ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC& samplerStateDesc);
+
+        // Releases the caller's reference and drops the state from the cache if nothing else holds it
+        void ReleaseState(ID3D11DeviceChild* state);
+
+        UINT StateCount() const;
+        UINT CreateCount() const;
+        UINT HitCount() const;
+
+        void ReportUsage() const;
+        void Trim();
+        void Clear();
+
+    private:
+        StateObjectCache();
+        StateObjectCache(const StateObjectCache& rhs);
+        StateObjectCache& operator=(const StateObjectCache& rhs);
+
+        enum StateObjectType
+        {
+            StateObjectTypeRasterizer = 0,
+            StateObjectTypeBlend,
+            StateObjectTypeDepthStencil,
+            StateObjectTypeSampler,
+            StateObjectTypeEnd
+        };
+
+        typedef struct _StateObjectCacheEntry
+        {
+            StateObjectType Type;
+            std::vector<BYTE> Key;
+            ID3D11DeviceChild* State;
+        } StateObjectCacheEntry;
+
+        // Hands the effects' state blocks to the cache
+        class EffectStateFactory : public ID3DX11EffectStateFactory
+        {
+        public:
+            EffectStateFactory(StateObjectCache& cache);
+
+            STDMETHOD(CreateRasterizerState)(const D3D11_RASTERIZER_DESC* pDesc, ID3D11RasterizerState** ppState) override;
+            STDMETHOD(CreateBlendState)(const D3D11_BLEND_DESC* pDesc, ID3D11BlendState** ppState) override;
+            STDMETHOD(CreateDepthStencilState)(const D3D11_DEPTH_STENCIL_DESC* pDesc, ID3D11DepthStencilState** ppState) override;
+            STDMETHOD(CreateSamplerState)(const D3D11_SAMPLER_DESC* pDesc, ID3D11SamplerState** ppState) override;
+
+        private:
+            EffectStateFactory(const EffectStateFactory& rhs);
+            EffectStateFactory& operator=(const EffectStateFactory& rhs);
+
+            StateObjectCache& mCache;
+        };
+
+        static void BuildKey(const D3D11_BLEND_DESC& blendStateDesc, std::vector<BYTE>& key);
+        static void BuildKey(const D3D11_DEPTH_STENCIL_DESC& depthStencilStateDesc, std::vector<BYTE>& key);
+        static UINT64 HashKey(StateObjectType type, const std::vector<BYTE>& key);
+
+        ID3D11DeviceChild* FindState(StateObjectType type, const std::vector<BYTE>& key, UINT64 hash);
+        void AddState(StateObjectType type, std::vector<BYTE>& key, UINT64 hash, ID3D11DeviceChild* state);
+
+        static const std::wstring TypeNames[];
+
+        Game& mGame;
+        EffectStateFactory mEffectStateFactory;
+        mutable std::mutex mMutex;
+        std::multimap<UINT64, StateObjectCacheEntry> mStates;
+        UINT mCreateCount;
+        UINT mHitCount;
+    };
+}
@@ -1,28 +1,25 @@
 #include "Technique.h"
 #include "Game.h"
+#include "GameException.h"
+#include "Arena.h"
 
 namespace Library
 {
-    Technique::Technique(Game& game, Effect& effect, ID3DX11EffectTechnique* technique)
-        : mEffect(effect), mTechnique(technique), mTechniqueDesc(), mName(), mPasses(), mPassesByName()
+    Technique::Technique(Game& game, Effect& effect, Arena& arena, ID3DX11EffectTechnique* technique, TechniqueHandle handle, PassHandle firstPassHandle)
+        : mEffect(effect), mTechnique(technique), mTechniqueDesc(), mName(), mHandle(handle), mPasses()
     {
         mTechnique->GetDesc(&mTechniqueDesc);
         mName = mTechniqueDesc.Name;
 
+        mPasses.reserve(mTechniqueDesc.Passes);
         for (UINT i = 0; i < mTechniqueDesc.Passes; i++)
         {
-            Pass* pass = new Pass(game, *this, mTechnique->GetPassByIndex(i));
-            mPasses.push_back(pass);
-            mPassesByName.insert(std::pair<std::string, Pass*>(pass->Name(), pass));
+            mPasses.push_back(arena.Create<Pass>(game, *this, mTechnique->GetPassByIndex(i), firstPassHandle + i));
         }
     }
 
     Technique::~Technique()
     {
-        for (Pass* pass : mPasses)
-        {
-            delete pass;
-        }
     }
 
     Effect& Technique::GetEffect()
@@ -30,6 +27,11 @@ namespace Library
         return mEffect;
     }
 
+    TechniqueHandle Technique::Handle() const
+    {
+        return mHandle;
+    }
+
     ID3DX11EffectTechnique* Technique::GetTechnique() const
     {
         return mTechnique;
@@ -50,8 +52,17 @@ namespace Library
         return mPasses;
     }
 
-    const std::map<std::string, Pass*>& Technique::PassesByName() const
+    // Techniques have a handful of passes at most, so a scan beats a map here
+    Pass& Technique::GetPass(const std::string& passName) const
     {
-        return mPassesByName;
+        for (Pass* pass : mPasses)
+        {
+            if (pass->Name() == passName)
+            {
+                return *pass;
+            }
+        }
+
+        throw GameException(("Pass not found: " + mName + "." + passName).c_str());
     }
 }
\ No newline at end of file
@@ -7,19 +7,27 @@ namespace Library
 {
     class Game;
     class Effect;
+    class Arena;
+
+    // Index of a technique in its effect's Techniques()
+    typedef UINT TechniqueHandle;
 
     class Technique
     {
     public:
-        Technique(Game& game, Effect& effect, ID3DX11EffectTechnique* technique);
+        // Passes are numbered from firstPassHandle onwards (see Effect::Passes()) and created in the
+        // effect's arena
+        Technique(Game& game, Effect& effect, Arena& arena, ID3DX11EffectTechnique* technique, TechniqueHandle handle, PassHandle firstPassHandle);
         ~Technique();
 
         Effect& GetEffect();
+        TechniqueHandle Handle() const;
         ID3DX11EffectTechnique* GetTechnique() const;
         const D3DX11_TECHNIQUE_DESC& TechniqueDesc() const;
         const std::string& Name() const;
         const std::vector<Pass*>& Passes() const;
-        const std::map<std::string, Pass*>& PassesByName() const;
+        // Throws if the technique has no such pass
+        Pass& GetPass(const std::string& passName) const;
 
     private:
         Technique(const Technique& rhs);
@@ -29,7 +37,7 @@ namespace Library
         ID3DX11EffectTechnique* mTechnique;
         D3DX11_TECHNIQUE_DESC mTechniqueDesc;
         std::string mName;
+        TechniqueHandle mHandle;
         std::vector<Pass*> mPasses;
-        std::map<std::string, Pass*> mPassesByName;
     };
 }
\ No newline at end of file
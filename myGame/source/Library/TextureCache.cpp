@@ -0,0 +1,289 @@
+#include "TextureCache.h"
+#include "Game.h"
+#include "GameException.h"
+#include "CookedTexture.h"
+#include "Utility.h"
+#include "VirtualFileSystem.h"
+#include "LoadProfiler.h"
+#include <WICTextureLoader.h>
+#include <sstream>
+#include <algorithm>
+
+namespace Library
+{
+    RTTI_DEFINITIONS(TextureCache)
+
+    TextureCache::TextureCache(Game& game)
+        : mGame(game), mTextures(), mLoadCount(0), mHitCount(0)
+    {
+    }
+
+    TextureCache::~TextureCache()
+    {
+        Clear();
+    }
+
+    ID3D11ShaderResourceView* TextureCache::GetTexture(const std::wstring& filename, UINT options)
+    {
+        std::wstring key = TextureKey(filename, options);
+
+        std::map<std::wstring, TextureCacheEntry>::iterator it = mTextures.find(key);
+        if (it != mTextures.end())
+        {
+            mHitCount++;
+        }
+        else
+        {
+            LoadProfileScope profileScope("Texture load", filename);
+
+            TextureCacheEntry entry;
+            LoadTexture(filename, options, &entry.ShaderResourceView);
+            Describe(entry.ShaderResourceView, entry);
+            LoadProfiler::AddBytesUploaded(entry.Size);
+
+            it = mTextures.insert(std::pair<std::wstring, TextureCacheEntry>(key, entry)).first;
+            mLoadCount++;
+        }
+
+        it->second.ShaderResourceView->AddRef();
+
+        return it->second.ShaderResourceView;
+    }
+
+    void TextureCache::AddTexture(const std::wstring& filename, UINT options, ID3D11ShaderResourceView* shaderResourceView)
+    {
+        assert(shaderResourceView != nullptr);
+
+        TextureCacheEntry entry;
+        entry.ShaderResourceView = shaderResourceView;
+        Describe(shaderResourceView, entry);
+
+        if (mTextures.insert(std::pair<std::wstring, TextureCacheEntry>(TextureKey(filename, options), entry)).second)
+        {
+            shaderResourceView->AddRef();
+            mLoadCount++;
+        }
+    }
+
+    UINT TextureCache::TextureCount() const
+    {
+        return mTextures.size();
+    }
+
+    UINT TextureCache::LoadCount() const
+    {
+        return mLoadCount;
+    }
+
+    UINT TextureCache::HitCount() const
+    {
+        return mHitCount;
+    }
+
+    UINT64 TextureCache::MemoryUsage() const
+    {
+        UINT64 size = 0;
+        for (const std::pair<const std::wstring, TextureCacheEntry>& texture : mTextures)
+        {
+            size += texture.second.Size;
+        }
+
+        return size;
+    }
+
+    UINT64 TextureCache::MemoryUsage(const std::wstring& filename, UINT options) const
+    {
+        std::map<std::wstring, TextureCacheEntry>::const_iterator it = mTextures.find(TextureKey(filename, options));
+
+        return (it != mTextures.end() ? it->second.Size : 0);
+    }
+
+    void TextureCache::ReportMemoryUsage() const
+    {
+        std::wostringstream report;
+        report << L"Textures: " << mTextures.size() << L" (" << mLoadCount << L" loads, " << mHitCount << L" hits), " << (MemoryUsage() / 1024) << L" KB" << std::endl;
+        for (const std::pair<const std::wstring, TextureCacheEntry>& texture : mTextures)
+        {
+            const TextureCacheEntry& entry = texture.second;
+            report << L"    " << texture.first << L": " << entry.Width << L"x" << entry.Height << L", " << entry.MipLevels << L" mips, format " << entry.Format << L", " << (entry.Size / 1024) << L" KB" << std::endl;
+        }
+
+        OutputDebugString(report.str().c_str());
+    }
+
+    // Releases the textures no component holds any more
+    void TextureCache::Trim()
+    {
+        std::map<std::wstring, TextureCacheEntry>::iterator it = mTextures.begin();
+        while (it != mTextures.end())
+        {
+            ID3D11ShaderResourceView* shaderResourceView = it->second.ShaderResourceView;
+            shaderResourceView->AddRef();
+            if (shaderResourceView->Release() == 1)
+            {
+                ReleaseObject(shaderResourceView);
+                it = mTextures.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void TextureCache::Clear()
+    {
+        for (std::pair<const std::wstring, TextureCacheEntry>& texture : mTextures)
+        {
+            ReleaseObject(texture.second.ShaderResourceView);
+        }
+
+        mTextures.clear();
+    }
+
+    UINT64 TextureCache::TextureSize(ID3D11ShaderResourceView* shaderResourceView)
+    {
+        TextureCacheEntry entry;
+        Describe(shaderResourceView, entry);
+
+        return entry.Size;
+    }
+
+    std::wstring TextureCache::TextureKey(const std::wstring& filename, UINT options)
+    {
+        std::wstring key;
+        Utility::NormalizePath(filename, key);
+
+        std::wostringstream keyStream;
+        keyStream << key << L"|" << options;
+
+        return keyStream.str();
+    }
+
+    void TextureCache::Describe(ID3D11ShaderResourceView* shaderResourceView, TextureCacheEntry& entry)
+    {
+        entry.Width = 0;
+        entry.Height = 0;
+        entry.MipLevels = 0;
+        entry.Format = DXGI_FORMAT_UNKNOWN;
+        entry.Size = 0;
+
+        ID3D11Resource* resource = nullptr;
+        ID3D11Texture2D* texture = nullptr;
+        shaderResourceView->GetResource(&resource);
+        HRESULT hr = resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&texture));
+        ReleaseObject(resource);
+        if (FAILED(hr))
+        {
+            return;
+        }
+
+        D3D11_TEXTURE2D_DESC textureDesc;
+        texture->GetDesc(&textureDesc);
+        ReleaseObject(texture);
+
+        entry.Width = textureDesc.Width;
+        entry.Height = textureDesc.Height;
+        entry.MipLevels = textureDesc.MipLevels;
+        entry.Format = textureDesc.Format;
+
+        // Block-compressed formats store 4x4 texel blocks, so small mips round up to a whole block
+        UINT bitsPerPixel = BitsPerPixel(textureDesc.Format);
+        for (UINT mip = 0; mip < textureDesc.MipLevels; mip++)
+        {
+            UINT64 width = (std::max)(textureDesc.Width >> mip, 1U);
+            UINT64 height = (std::max)(textureDesc.Height >> mip, 1U);
+            if (IsBlockCompressed(textureDesc.Format))
+            {
+                entry.Size += ((width + 3) / 4) * ((height + 3) / 4) * bitsPerPixel * 2;
+            }
+            else
+            {
+                entry.Size += width * height * bitsPerPixel / 8;
+            }
+        }
+
+        entry.Size *= textureDesc.ArraySize;
+    }
+
+    UINT TextureCache::BitsPerPixel(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 128;
+
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R32G32_FLOAT:
+            return 64;
+
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_B5G6R5_UNORM:
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+            return 16;
+
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 8;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 4;
+
+        default:
+            return 32;
+        }
+    }
+
+    bool TextureCache::IsBlockCompressed(DXGI_FORMAT format)
+    {
+        return ((format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) || (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB));
+    }
+
+    void TextureCache::LoadTexture(const std::wstring& filename, UINT options, ID3D11ShaderResourceView** shaderResourceView)
+    {
+        if ((options & (TextureLoadOptionsSourceOnly | TextureLoadOptionsNoMips)) == 0)
+        {
+            CookedTexture::CreateShaderResourceView(mGame.Direct3DDevice(), mGame.Direct3DDeviceContext(), filename, shaderResourceView);
+            return;
+        }
+
+        FileData file;
+        if (VirtualFileSystem::Open(filename, file) == false)
+        {
+            throw GameException("Could not open texture.", HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+        }
+
+        // Without the immediate context the WIC loader creates the top level only
+        ID3D11DeviceContext* deviceContext = ((options & TextureLoadOptionsNoMips) != 0 ? nullptr : mGame.Direct3DDeviceContext());
+        HRESULT hr = DirectX::CreateWICTextureFromMemory(mGame.Direct3DDevice(), deviceContext, file.Data(), static_cast<size_t>(file.Size()), nullptr, shaderResourceView);
+        if (FAILED(hr))
+        {
+            throw GameException("CreateWICTextureFromMemory() failed.", hr);
+        }
+    }
+}
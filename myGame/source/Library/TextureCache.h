@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+    class Game;
+
+    enum TextureLoadOptions
+    {
+        TextureLoadOptionsDefault = 0,
+        TextureLoadOptionsSourceOnly = 1,   // Ignore the cooked .dds and decode the source image
+        TextureLoadOptionsNoMips = 2        // Source images only; skip the generated mip chain
+    };
+
+    // Process-wide cache of shader resource views. Each image is decoded and uploaded once per
+    // (normalized path, load options), no matter how many components sample it; the cooked .dds
+    // next to the source file is preferred when present (see CookedTexture).
+    //
+    // Views are handed out with an extra reference (AddRef); callers release them as usual. The
+    // cache keeps its own reference until Trim() finds it is the last one, or Clear().
+    class TextureCache : public RTTI
+    {
+        RTTI_DECLARATIONS(TextureCache, RTTI)
+
+    public:
+        TextureCache(Game& game);
+        ~TextureCache();
+
+        ID3D11ShaderResourceView* GetTexture(const std::wstring& filename, UINT options = TextureLoadOptionsDefault);
+
+        // Seed the cache with a texture loaded elsewhere (see AssetLoader); existing entries win.
+        void AddTexture(const std::wstring& filename, UINT options, ID3D11ShaderResourceView* shaderResourceView);
+
+        UINT TextureCount() const;
+        UINT LoadCount() const;
+        UINT HitCount() const;
+        UINT64 MemoryUsage() const;
+        UINT64 MemoryUsage(const std::wstring& filename, UINT options = TextureLoadOptionsDefault) const;
+
+        void ReportMemoryUsage() const;
+        void Trim();
+        void Clear();
+
+        // Video memory taken by a 2D texture view, mips and array slices included
+        static UINT64 TextureSize(ID3D11ShaderResourceView* shaderResourceView);
+
+    private:
+        TextureCache();
+        TextureCache(const TextureCache& rhs);
+        TextureCache& operator=(const TextureCache& rhs);
+
+        typedef struct _TextureCacheEntry
+        {
+            ID3D11ShaderResourceView* ShaderResourceView;
+            UINT Width;
+            UINT Height;
+            UINT MipLevels;
+            DXGI_FORMAT Format;
+            UINT64 Size;
+        } TextureCacheEntry;
+
+        static std::wstring TextureKey(const std::wstring& filename, UINT options);
+        static void Describe(ID3D11ShaderResourceView* shaderResourceView, TextureCacheEntry& entry);
+        static UINT BitsPerPixel(DXGI_FORMAT format);
+        static bool IsBlockCompressed(DXGI_FORMAT format);
+
+        void LoadTexture(const std::wstring& filename, UINT options, ID3D11ShaderResourceView** shaderResourceView);
+
+        Game& mGame;
+        std::map<std::wstring, TextureCacheEntry> mTextures;
+        UINT mLoadCount;
+        UINT mHitCount;
+    };
+}
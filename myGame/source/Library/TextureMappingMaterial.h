@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Common.h"
+#include "Material.h"
+#include "VertexDeclarations.h"
+
+namespace Library
+{
+    class Game;
+
+    class TextureMappingMaterial : public Material
+    {
+        RTTI_DECLARATIONS(TextureMappingMaterial, Material)
+
+        MATERIAL_VARIABLE_DECLARATION(WorldViewProjection)
+        MATERIAL_VARIABLE_DECLARATION(ColorTexture)
+
+    public:
+        static const std::wstring EffectFilename;
+
+        TextureMappingMaterial();
+
+        // TextureMapping.cso and its input layout, loaded once and shared by every textured model
+        // (ModelFromFile, Door) until the last one lets go. Request EffectFilename up front so the
+        // AssetLoader has the bytes ready.
+        static std::shared_ptr<TextureMappingMaterial> Shared(Game& game);
+
+        virtual void Initialize(Effect& effect) override;
+        virtual void CreateVertexBuffer(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) const override;
+        void CreateVertexBuffer(ID3D11Device* device, VertexPositionTexture* vertices, UINT vertexCount, ID3D11Buffer** vertexBuffer) const;
+        virtual UINT VertexSize() const override;
+
+    private:
+        std::shared_ptr<Effect> mSharedEffect;
+
+        static std::weak_ptr<TextureMappingMaterial> sShared;
+    };
+}
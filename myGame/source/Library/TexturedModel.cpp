@@ -0,0 +1,119 @@
+#include "TexturedModel.h"
+#include "Game.h"
+#include "Camera.h"
+#include "Model.h"
+#include "ModelCache.h"
+#include "AssetLoader.h"
+#include "CookedMesh.h"
+#include "TextureCache.h"
+#include "RenderStatistics.h"
+#include "Frustum.h"
+#include "TextureMappingMaterial.h"
+#include <algorithm>
+
+namespace Library
+{
+    TexturedModel::TexturedModel(Game& game)
+        : mGame(game), mMaterial(), mPass(nullptr), mInputLayout(nullptr), mTextureShaderResourceView(nullptr),
+          mVertexBuffer(nullptr), mIndexBuffer(nullptr), mSubmeshes(), mBounds(), mLevelOfDetailCount(0), mLevelOfDetailSelector(), mRenderStatistics(nullptr)
+    {
+    }
+
+    TexturedModel::~TexturedModel()
+    {
+        ReleaseObject(mTextureShaderResourceView);
+        ReleaseObject(mVertexBuffer);
+        ReleaseObject(mIndexBuffer);
+    }
+
+    void TexturedModel::RequestAssets(AssetLoader& assetLoader, const std::string& modelFilename, const std::wstring& textureFilename)
+    {
+        assetLoader.RequestModel(modelFilename, true);
+        assetLoader.RequestTexture(textureFilename);
+        assetLoader.RequestEffect(TextureMappingMaterial::EffectFilename);
+    }
+
+    void TexturedModel::Initialize(const std::string& modelFilename, const std::wstring& textureFilename)
+    {
+        // One precompiled effect and input layout, shared by every textured model
+        mMaterial = TextureMappingMaterial::Shared(mGame);
+        mPass = &mMaterial->CurrentTechnique()->GetPass("p0");
+        mInputLayout = mMaterial->InputLayout(*mPass);
+
+        // Load the model (shared with every other instance of the same file)
+        ModelCache* modelCache = (ModelCache*)mGame.Services().GetService(ModelCache::TypeIdClass());
+        assert(modelCache != nullptr);
+
+        // Optional; only present when the game wants the triangle counts
+        mRenderStatistics = (RenderStatistics*)mGame.Services().GetService(RenderStatistics::TypeIdClass());
+
+        // Prefer the cooked mesh when the content pipeline has produced one
+        std::shared_ptr<CookedMesh> cookedMesh = modelCache->GetCookedMesh(modelFilename);
+        if (cookedMesh != nullptr && cookedMesh->HasVertexFormat(VertexFormatPositionTexture))
+        {
+            mVertexBuffer = modelCache->GetVertexBuffer(*cookedMesh, VertexFormatPositionTexture);
+            mIndexBuffer = modelCache->GetIndexBuffer(*cookedMesh);
+            mSubmeshes = cookedMesh->Submeshes();
+            mBounds = cookedMesh->Bounds();
+        }
+        else
+        {
+            std::shared_ptr<Model> model = modelCache->GetModel(modelFilename, true);
+
+            // Every mesh in the file shares one vertex and one index buffer
+            mVertexBuffer = modelCache->GetVertexBuffer(*model, VertexFormatPositionTexture);
+            mIndexBuffer = modelCache->GetIndexBuffer(*model);
+            mSubmeshes = model->Submeshes();
+            mBounds = model->Bounds();
+        }
+
+        mLevelOfDetailCount = LevelOfDetailSelector::LevelCount(mSubmeshes);
+
+        // Decoded once and shared by every component using the same image (cooked .dds preferred)
+        TextureCache* textureCache = (TextureCache*)mGame.Services().GetService(TextureCache::TypeIdClass());
+        assert(textureCache != nullptr);
+        mTextureShaderResourceView = textureCache->GetTexture(textureFilename);
+    }
+
+    void TexturedModel::Draw(const Camera& camera, const XMFLOAT4X4& worldMatrix)
+    {
+        ID3D11DeviceContext* direct3DDeviceContext = mGame.Direct3DDeviceContext();
+        direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        direct3DDeviceContext->IASetInputLayout(mInputLayout);
+
+        UINT stride = sizeof(VertexPositionTexture);
+        UINT offset = 0;
+        direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
+        direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+        XMMATRIX world = XMLoadFloat4x4(&worldMatrix);
+        XMMATRIX wvp = world * camera.ViewMatrix() * camera.ProjectionMatrix();
+        mMaterial->WorldViewProjection() << wvp;
+        mMaterial->ColorTexture() << mTextureShaderResourceView;
+
+        mPass->Apply(0, direct3DDeviceContext);
+
+        // The planes come out in model space, so the submesh bounds are tested as stored
+        Frustum frustum(wvp);
+        UINT level = mLevelOfDetailSelector.Select(LevelOfDetailSelector::ProjectedSize(mBounds, world, camera), mLevelOfDetailCount);
+        for (const ModelSubmesh& submesh : mSubmeshes)
+        {
+            if (submesh.Bounds.ContainedBy(frustum.NearVector(), frustum.FarVector(), frustum.LeftVector(), frustum.RightVector(), frustum.TopVector(), frustum.BottomVector()) == DISJOINT)
+            {
+                continue;
+            }
+
+            const MeshLevelOfDetail& levelOfDetail = submesh.LevelsOfDetail[(std::min)(level, static_cast<UINT>(submesh.LevelsOfDetail.size()) - 1)];
+            direct3DDeviceContext->DrawIndexed(levelOfDetail.IndexCount, levelOfDetail.StartIndex, submesh.BaseVertex);
+            if (mRenderStatistics != nullptr)
+            {
+                mRenderStatistics->AddDraw(levelOfDetail.IndexCount / 3, submesh.IndexCount / 3);
+            }
+        }
+    }
+
+    const DirectX::BoundingBox& TexturedModel::Bounds() const
+    {
+        return mBounds;
+    }
+}
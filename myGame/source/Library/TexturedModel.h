@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Common.h"
+#include "LevelOfDetailSelector.h"
+#include <DirectXCollision.h>
+
+namespace Library
+{
+    class Game;
+    class Camera;
+    class Pass;
+    class AssetLoader;
+    class RenderStatistics;
+    class TextureMappingMaterial;
+
+    // The GPU side of a model drawn with one texture through TextureMappingMaterial, shared by
+    // ModelFromFile and Door. Buffers come from the ModelCache (cooked mesh preferred) and the
+    // texture from the TextureCache. Draw culls each submesh against the frustum and picks its
+    // level of detail from the model's projected size.
+    class TexturedModel
+    {
+    public:
+        TexturedModel(Game& game);
+        ~TexturedModel();
+
+        static void RequestAssets(AssetLoader& assetLoader, const std::string& modelFilename, const std::wstring& textureFilename);
+
+        void Initialize(const std::string& modelFilename, const std::wstring& textureFilename);
+        void Draw(const Camera& camera, const XMFLOAT4X4& worldMatrix);
+
+        const DirectX::BoundingBox& Bounds() const;
+
+    private:
+        TexturedModel();
+        TexturedModel(const TexturedModel& rhs);
+        TexturedModel& operator=(const TexturedModel& rhs);
+
+        Game& mGame;
+        std::shared_ptr<TextureMappingMaterial> mMaterial;
+        Pass* mPass;
+        ID3D11InputLayout* mInputLayout;
+        ID3D11ShaderResourceView* mTextureShaderResourceView;
+        ID3D11Buffer* mVertexBuffer;
+        ID3D11Buffer* mIndexBuffer;
+        std::vector<ModelSubmesh> mSubmeshes;
+        DirectX::BoundingBox mBounds;
+        UINT mLevelOfDetailCount;
+        LevelOfDetailSelector mLevelOfDetailSelector;
+        RenderStatistics* mRenderStatistics;
+    };
+}
@@ -1,8 +1,8 @@
 #include "Utility.h"
+#include "VirtualFileSystem.h"
 #include <algorithm>
 #include <exception>
 #include <Shlwapi.h>
-#include <fstream>
 
 namespace Library
 {
@@ -77,25 +77,17 @@ namespace Library
 		}
 	}
 	
+	// Reads through the VirtualFileSystem, so mounted archives are honored
 	void Utility::LoadBinaryFile(const std::wstring& filename, std::vector<char>& data)
 	{
-		std::ifstream file(filename.c_str(), std::ios::binary);
-		if (file.bad())
+		FileData file;
+		if (VirtualFileSystem::Open(filename, file) == false)
 		{
 			throw std::exception("Could not open file.");
 		}
 
-		file.seekg(0, std::ios::end);
-		UINT size = (UINT)file.tellg();
-
-		if (size > 0)
-		{
-			data.resize(size);
-			file.seekg(0, std::ios::beg);			
-			file.read(&data.front(), size);
-		}
-
-		file.close();
+		const char* contents = reinterpret_cast<const char*>(file.Data());
+		data.assign(contents, contents + file.Size());
 	}
 
 	void Utility::ToWideString(const std::string& source, std::wstring& dest)
@@ -123,4 +115,18 @@ namespace Library
 	{
 		dest = PathFindExtension(source.c_str());
 	}
+
+	void Utility::NormalizePath(const std::string& source, std::string& dest)
+	{
+		dest = source;
+		std::replace(dest.begin(), dest.end(), '/', '\\');
+		std::transform(dest.begin(), dest.end(), dest.begin(), ::tolower);
+	}
+
+	void Utility::NormalizePath(const std::wstring& source, std::wstring& dest)
+	{
+		dest = source;
+		std::replace(dest.begin(), dest.end(), L'/', L'\\');
+		std::transform(dest.begin(), dest.end(), dest.begin(), ::towlower);
+	}
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ namespace Library
 		static std::wstring ToWideString(const std::string& source);
 		static void PathJoin(std::wstring& dest, const std::wstring& sourceDirectory, const std::wstring& sourceFile);
 		static void GetPathExtension(const std::wstring& source, std::wstring& dest);
+		static void NormalizePath(const std::string& source, std::string& dest);
+		static void NormalizePath(const std::wstring& source, std::wstring& dest);
 
 	private:
 		Utility();
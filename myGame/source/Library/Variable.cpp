@@ -3,19 +3,50 @@
 
 namespace Library
 {
-	Variable::Variable(Effect& effect, ID3DX11EffectVariable* variable)
-		: mEffect(effect), mVariable(variable), mVariableDesc(), mType(nullptr), mTypeDesc(), mName()
+	UINT64 Variable::sPerformedSetCount = 0;
+	UINT64 Variable::sElidedSetCount = 0;
+
+	Variable::Variable(Effect& effect, ID3DX11EffectVariable* variable, VariableHandle handle)
+		: mEffect(effect), mVariable(variable), mVariableDesc(), mTypeDesc(), mName(), mHandle(handle),
+		  mMatrixVariable(nullptr), mVectorVariable(nullptr), mScalarVariable(nullptr), mShaderResourceVariable(nullptr),
+		  mShadowValue(), mHasShadowValue(false)
 	{
 		mVariable->GetDesc(&mVariableDesc);
-		mName = mVariableDesc.Name;
-		mType = mVariable->GetType();
-		mType->GetDesc(&mTypeDesc);
+		// Names are gone once the effect is optimized
+		mName = (mVariableDesc.Name != nullptr ? mVariableDesc.Name : "");
+		mVariable->GetType()->GetDesc(&mTypeDesc);
+
+		// The casts that don't match the variable's type return Effects11's invalid variable
+		if (mVariable->AsMatrix()->IsValid())
+		{
+			mMatrixVariable = mVariable->AsMatrix();
+		}
+
+		if (mVariable->AsVector()->IsValid())
+		{
+			mVectorVariable = mVariable->AsVector();
+		}
+
+		if (mVariable->AsScalar()->IsValid())
+		{
+			mScalarVariable = mVariable->AsScalar();
+		}
+
+		if (mVariable->AsShaderResource()->IsValid())
+		{
+			mShaderResourceVariable = mVariable->AsShaderResource();
+		}
 	}
 
 	Effect& Variable::GetEffect()
 	{
 		return mEffect;
 	}
+
+	VariableHandle Variable::Handle() const
+	{
+		return mHandle;
+	}
 	
 	ID3DX11EffectVariable* Variable::GetVariable() const
 	{
@@ -32,9 +63,10 @@ namespace Library
 		return mTypeDesc;
 	}
 
+	// Not cached; Optimize() moves the effect's type data
 	ID3DX11EffectType* Variable::Type() const
 	{
-		return mType;
+		return mVariable->GetType();
 	}
 
 	const std::string& Variable::Name() const
@@ -44,79 +76,133 @@ namespace Library
 
 	Variable& Variable::operator<<(CXMMATRIX value)
 	{
-		ID3DX11EffectMatrixVariable* variable = mVariable->AsMatrix();
-		if (variable->IsValid() == false)
+		if (mMatrixVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetMatrix(reinterpret_cast<const float*>(&value));
+		if (UpdateShadowValue(&value, sizeof(XMMATRIX)))
+		{
+			mMatrixVariable->SetMatrix(reinterpret_cast<const float*>(&value));
+		}
 	
 		return *this;
 	}
 
 	Variable& Variable::operator<<(ID3D11ShaderResourceView* value)
 	{
-		ID3DX11EffectShaderResourceVariable* variable = mVariable->AsShaderResource();
-		if (variable->IsValid() == false)
+		if (mShaderResourceVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetResource(value);
+		if (UpdateShadowValue(&value, sizeof(value)))
+		{
+			mShaderResourceVariable->SetResource(value);
+		}
 	
 		return *this;
 	}
 
 	Variable& Variable::operator<<(FXMVECTOR value)
 	{
-		ID3DX11EffectVectorVariable* variable = mVariable->AsVector();
-		if (variable->IsValid() == false)
+		if (mVectorVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetFloatVector(reinterpret_cast<const float*>(&value));
+		if (UpdateShadowValue(&value, sizeof(XMVECTOR)))
+		{
+			mVectorVariable->SetFloatVector(reinterpret_cast<const float*>(&value));
+		}
 	
 		return *this;
 	}
 
 	Variable& Variable::operator<<(float value)
 	{
-		ID3DX11EffectScalarVariable* variable = mVariable->AsScalar();
-		if (variable->IsValid() == false)
+		if (mScalarVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetFloat(value);
+		if (UpdateShadowValue(&value, sizeof(value)))
+		{
+			mScalarVariable->SetFloat(value);
+		}
 	
 		return *this;
 	}
 
 	Variable& Variable::operator<<(const std::vector<float>& values)
 	{
-		ID3DX11EffectScalarVariable* variable = mVariable->AsScalar();
-		if (variable->IsValid() == false)
+		if (mScalarVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetFloatArray(&values[0], 0, values.size());
+		if (values.empty())
+		{
+			return *this;
+		}
+
+		if (UpdateShadowValue(values.data(), sizeof(float) * values.size()))
+		{
+			mScalarVariable->SetFloatArray(values.data(), 0, values.size());
+		}
 	
 		return *this;
 	}
 
 	Variable& Variable::operator<<(const std::vector<XMFLOAT2>& values)
 	{
-		ID3DX11EffectVectorVariable* variable = mVariable->AsVector();
-		if (variable->IsValid() == false)
+		if (mVectorVariable == nullptr)
 		{
 			throw GameException("Invalid effect variable cast.");
 		}
 
-		variable->SetFloatVectorArray(reinterpret_cast<const float*>(&values[0]), 0, values.size());
+		if (values.empty())
+		{
+			return *this;
+		}
+
+		if (UpdateShadowValue(values.data(), sizeof(XMFLOAT2) * values.size()))
+		{
+			mVectorVariable->SetFloatVectorArray(reinterpret_cast<const float*>(values.data()), 0, values.size());
+		}
 	
 		return *this;
 	}
+
+	void Variable::Invalidate()
+	{
+		mHasShadowValue = false;
+	}
+
+	UINT64 Variable::PerformedSetCount()
+	{
+		return sPerformedSetCount;
+	}
+
+	UINT64 Variable::ElidedSetCount()
+	{
+		return sElidedSetCount;
+	}
+
+	// Returns false, and counts the set as elided, when the value matches the last one written
+	bool Variable::UpdateShadowValue(const void* value, UINT size)
+	{
+		if (mHasShadowValue && mShadowValue.size() == size && memcmp(mShadowValue.data(), value, size) == 0)
+		{
+			sElidedSetCount++;
+			return false;
+		}
+
+		const BYTE* bytes = reinterpret_cast<const BYTE*>(value);
+		mShadowValue.assign(bytes, bytes + size);
+		mHasShadowValue = true;
+		sPerformedSetCount++;
+
+		return true;
+	}
 }
\ No newline at end of file
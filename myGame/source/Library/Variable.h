@@ -6,12 +6,19 @@ namespace Library
 {
     class Effect;
 
+    // Index of a global variable in its effect, as in ID3DX11Effect::GetVariableByIndex()
+    typedef UINT VariableHandle;
+
+    // Wraps one effect variable. The typed interface is resolved once, and the last value written
+    // is kept so that setting the same value again skips the Effects11 setter; an unchanged value
+    // then leaves its constant buffer clean and it is not uploaded on the next Apply().
     class Variable
     {
     public:
-        Variable(Effect& effect, ID3DX11EffectVariable* variable);
+        Variable(Effect& effect, ID3DX11EffectVariable* variable, VariableHandle handle);
 
         Effect& GetEffect();
+        VariableHandle Handle() const;
         ID3DX11EffectVariable* GetVariable() const;
         const D3DX11_EFFECT_VARIABLE_DESC& VariableDesc() const;
         ID3DX11EffectType* Type() const;
@@ -25,15 +32,35 @@ namespace Library
 		Variable& operator<<(const std::vector<float>& values);
 		Variable& operator<<(const std::vector<XMFLOAT2>& values);
 
+        // Forgets the last value, for when the effect variable was written without this wrapper
+        void Invalidate();
+
+        // Totals across all variables since startup
+        static UINT64 PerformedSetCount();
+        static UINT64 ElidedSetCount();
+
     private:
         Variable(const Variable& rhs);
         Variable& operator=(const Variable& rhs);
 
+        bool UpdateShadowValue(const void* value, UINT size);
+
         Effect& mEffect;
         ID3DX11EffectVariable* mVariable;
         D3DX11_EFFECT_VARIABLE_DESC mVariableDesc;
-        ID3DX11EffectType* mType;
         D3DX11_EFFECT_TYPE_DESC mTypeDesc;
         std::string mName;
+        VariableHandle mHandle;
+
+        ID3DX11EffectMatrixVariable* mMatrixVariable;
+        ID3DX11EffectVectorVariable* mVectorVariable;
+        ID3DX11EffectScalarVariable* mScalarVariable;
+        ID3DX11EffectShaderResourceVariable* mShaderResourceVariable;
+
+        std::vector<BYTE> mShadowValue;
+        bool mHasShadowValue;
+
+        static UINT64 sPerformedSetCount;
+        static UINT64 sElidedSetCount;
     };
 }
\ No newline at end of file
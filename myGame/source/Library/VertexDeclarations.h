@@ -4,6 +4,17 @@
 
 namespace Library
 {
+	// Interleaved layouts the materials build from a Mesh; used to key cooked and cached vertex streams.
+	enum VertexFormat
+	{
+		VertexFormatPosition = 0,
+		VertexFormatPositionTexture,
+		VertexFormatPositionTextureNormal,
+		VertexFormatPositionQuantized,
+		VertexFormatPositionTextureNormalQuantized,
+		VertexFormatEnd
+	};
+
 	typedef struct _VertexPosition
     {
         XMFLOAT4 Position;
@@ -58,4 +69,28 @@ namespace Library
 		_VertexPositionTextureNormal(XMFLOAT4 position, XMFLOAT2 textureCoordinates, XMFLOAT3 normal)
 			: Position(position), TextureCoordinates(textureCoordinates), Normal(normal) { }
 	} VertexPositionTextureNormal;
+
+	// Compact layouts (see MeshQuantization): Position is 16-bit unorm within the mesh bounds with
+	// w = 1, Normal is octahedral-encoded and TextureCoordinates are half precision.
+	typedef struct _VertexPositionQuantized
+	{
+		XMUSHORTN4 Position;
+
+		_VertexPositionQuantized() { }
+
+		_VertexPositionQuantized(XMUSHORTN4 position)
+			: Position(position) { }
+	} VertexPositionQuantized;
+
+	typedef struct _VertexPositionTextureNormalQuantized
+	{
+		XMUSHORTN4 Position;
+		XMHALF2 TextureCoordinates;
+		XMSHORTN2 Normal;
+
+		_VertexPositionTextureNormalQuantized() { }
+
+		_VertexPositionTextureNormalQuantized(XMUSHORTN4 position, XMHALF2 textureCoordinates, XMSHORTN2 normal)
+			: Position(position), TextureCoordinates(textureCoordinates), Normal(normal) { }
+	} VertexPositionTextureNormalQuantized;
 }
@@ -0,0 +1,211 @@
+#include "VirtualFileSystem.h"
+#include "DirectoryFileSystem.h"
+#include "Utility.h"
+#include "LoadProfiler.h"
+
+namespace Library
+{
+    std::vector<VirtualFileSystem::MountPoint> VirtualFileSystem::sMountPoints;
+    std::map<std::string, UINT> VirtualFileSystem::sOpenCounts;
+    std::mutex VirtualFileSystem::sMutex;
+
+    FileData::FileData()
+        : mOwner(), mData(nullptr), mSize(0)
+    {
+    }
+
+    FileData::FileData(const std::shared_ptr<const void>& owner, const byte* data, UINT64 size)
+        : mOwner(owner), mData(data), mSize(size)
+    {
+    }
+
+    FileData::FileData(const FileData& container, UINT64 offset, UINT64 size)
+        : mOwner(container.mOwner), mData(container.mData + offset), mSize(size)
+    {
+        assert(offset + size <= container.mSize);
+    }
+
+    const byte* FileData::Data() const
+    {
+        return mData;
+    }
+
+    UINT64 FileData::Size() const
+    {
+        return mSize;
+    }
+
+    bool FileData::IsValid() const
+    {
+        return (mOwner != nullptr);
+    }
+
+    void FileData::Reset()
+    {
+        mOwner.reset();
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    void VirtualFileSystem::Mount(const std::string& mountPoint, const std::shared_ptr<FileSystemBackend>& backend)
+    {
+        assert(backend != nullptr);
+
+        std::string normalizedMountPoint;
+        NormalizePath(mountPoint, normalizedMountPoint);
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        sMountPoints.push_back(MountPoint(normalizedMountPoint, backend));
+    }
+
+    void VirtualFileSystem::Unmount(const std::string& mountPoint)
+    {
+        std::string normalizedMountPoint;
+        NormalizePath(mountPoint, normalizedMountPoint);
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        std::vector<MountPoint>::iterator it = sMountPoints.begin();
+        while (it != sMountPoints.end())
+        {
+            if (it->first == normalizedMountPoint)
+            {
+                it = sMountPoints.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void VirtualFileSystem::UnmountAll()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sMountPoints.clear();
+    }
+
+    bool VirtualFileSystem::Exists(const std::string& path)
+    {
+        std::vector<Candidate> candidates;
+        FindCandidates(path, candidates);
+
+        for (const Candidate& candidate : candidates)
+        {
+            if (candidate.first->Exists(candidate.second))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool VirtualFileSystem::Exists(const std::wstring& path)
+    {
+        return Exists(std::string(path.begin(), path.end()));
+    }
+
+    bool VirtualFileSystem::Open(const std::string& path, FileData& file)
+    {
+        std::vector<Candidate> candidates;
+        FindCandidates(path, candidates);
+
+        for (const Candidate& candidate : candidates)
+        {
+            if (candidate.first->Open(candidate.second, file))
+            {
+                LoadProfiler::AddBytesRead(file.Size());
+
+                std::string normalizedPath;
+                NormalizePath(path, normalizedPath);
+
+                std::lock_guard<std::mutex> lock(sMutex);
+                sOpenCounts[normalizedPath]++;
+
+                return true;
+            }
+        }
+
+        file.Reset();
+
+        return false;
+    }
+
+    bool VirtualFileSystem::Open(const std::wstring& path, FileData& file)
+    {
+        return Open(std::string(path.begin(), path.end()), file);
+    }
+
+    UINT VirtualFileSystem::OpenCount(const std::string& path)
+    {
+        std::string normalizedPath;
+        NormalizePath(path, normalizedPath);
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        std::map<std::string, UINT>::const_iterator it = sOpenCounts.find(normalizedPath);
+
+        return (it != sOpenCounts.end() ? it->second : 0);
+    }
+
+    UINT VirtualFileSystem::OpenCount(const std::wstring& path)
+    {
+        return OpenCount(std::string(path.begin(), path.end()));
+    }
+
+    void VirtualFileSystem::NormalizePath(const std::string& source, std::string& dest)
+    {
+        Utility::NormalizePath(source, dest);
+
+        while (dest.compare(0, 2, ".\\") == 0)
+        {
+            dest.erase(0, 2);
+        }
+
+        while (dest.size() > 0 && dest.back() == '\\')
+        {
+            dest.pop_back();
+        }
+    }
+
+    // 64-bit FNV-1a; the archive TOC is sorted by this value, so it must never change
+    UINT64 VirtualFileSystem::HashPath(const std::string& normalizedPath)
+    {
+        UINT64 hash = 14695981039346656037ULL;
+        for (char character : normalizedPath)
+        {
+            hash ^= static_cast<byte>(character);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    // Backends of every mount point enclosing the path, most recent first, with the path relative to each
+    void VirtualFileSystem::FindCandidates(const std::string& path, std::vector<Candidate>& candidates)
+    {
+        std::string normalizedPath;
+        NormalizePath(path, normalizedPath);
+
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            for (std::vector<MountPoint>::const_reverse_iterator it = sMountPoints.rbegin(); it != sMountPoints.rend(); ++it)
+            {
+                const std::string& mountPoint = it->first;
+                if (mountPoint.empty())
+                {
+                    candidates.push_back(Candidate(it->second, normalizedPath));
+                }
+                else if (normalizedPath.size() > mountPoint.size() && normalizedPath.compare(0, mountPoint.size(), mountPoint) == 0 && normalizedPath[mountPoint.size()] == '\\')
+                {
+                    candidates.push_back(Candidate(it->second, normalizedPath.substr(mountPoint.size() + 1)));
+                }
+            }
+        }
+
+        if (candidates.empty())
+        {
+            static std::shared_ptr<FileSystemBackend> looseFiles = std::make_shared<DirectoryFileSystem>(L"");
+            candidates.push_back(Candidate(looseFiles, normalizedPath));
+        }
+    }
+}
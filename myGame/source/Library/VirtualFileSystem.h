@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include <mutex>
+
+namespace Library
+{
+    // Read-only contents of a file opened through the VirtualFileSystem. Copies share the backing
+    // storage (a mapped file, an archive, a buffer), which stays alive until the last one is gone.
+    class FileData
+    {
+    public:
+        FileData();
+        FileData(const std::shared_ptr<const void>& owner, const byte* data, UINT64 size);
+        FileData(const FileData& container, UINT64 offset, UINT64 size);
+
+        const byte* Data() const;
+        UINT64 Size() const;
+        bool IsValid() const;
+
+        void Reset();
+
+    private:
+        std::shared_ptr<const void> mOwner;
+        const byte* mData;
+        UINT64 mSize;
+    };
+
+    // Source of files for a mount point. Paths are normalized (lower case, backslashes) and
+    // relative to the mount point; backends must be safe to read from several threads.
+    class FileSystemBackend
+    {
+    public:
+        virtual ~FileSystemBackend() { }
+
+        virtual bool Exists(const std::string& path) const = 0;
+        virtual bool Open(const std::string& path, FileData& file) const = 0;
+    };
+
+    // Process-wide table of mount points every content read goes through (Utility::LoadBinaryFile,
+    // Model, CookedMesh, the texture loaders and SpriteFontLoader). Later mounts take priority over
+    // earlier ones at the same or an enclosing mount point; paths under no mount point are read as
+    // loose files relative to the current directory.
+    //
+    // Mount before any asset is requested; lookups may then run on the AssetLoader workers.
+    class VirtualFileSystem
+    {
+    public:
+        static void Mount(const std::string& mountPoint, const std::shared_ptr<FileSystemBackend>& backend);
+        static void Unmount(const std::string& mountPoint);
+        static void UnmountAll();
+
+        static bool Exists(const std::string& path);
+        static bool Exists(const std::wstring& path);
+        static bool Open(const std::string& path, FileData& file);
+        static bool Open(const std::wstring& path, FileData& file);
+
+        // Times Open has handed out the file since startup, whichever backend served it
+        static UINT OpenCount(const std::string& path);
+        static UINT OpenCount(const std::wstring& path);
+
+        static void NormalizePath(const std::string& source, std::string& dest);
+        static UINT64 HashPath(const std::string& normalizedPath);
+
+    private:
+        VirtualFileSystem();
+        VirtualFileSystem(const VirtualFileSystem& rhs);
+        VirtualFileSystem& operator=(const VirtualFileSystem& rhs);
+
+        typedef std::pair<std::string, std::shared_ptr<FileSystemBackend>> MountPoint;
+        typedef std::pair<std::shared_ptr<FileSystemBackend>, std::string> Candidate;
+
+        static void FindCandidates(const std::string& path, std::vector<Candidate>& candidates);
+
+        static std::vector<MountPoint> sMountPoints;
+        static std::map<std::string, UINT> sOpenCounts;
+        static std::mutex sMutex;
+    };
+}